@@ -2,53 +2,59 @@
 #define AGENT_H
 
 #include <vecmath.h>
-#include <deque>
+#include <cstddef>
 #include <vector>
-#include "Wall.h"
-
-struct Waypoint {
-	Point3f position;
-	float radius;
-};
+#include "AgentHandle.h"
+#include "CrowdState.h"
 
+// Handle to an Agent Stored in 'CrowdState'  Values are kept locally until the agent is added to 'SocialForce'
 class Agent {
 private:
-	static int crowdIdx;	// Keep track of 'crowd' vector index in 'SocialForce.h'
+	CrowdState *state;		// Storage agent is bound to (null until added to 'SocialForce')
+	size_t idx;				// Index of agent in 'state'  Updated by 'SocialForce' when agents are removed or reordered
+	AgentHandle handle;
 
-	int id;
+	int id;					// Unique within a 'SocialForce', assigned by 'addAgent()' unless restored
 	float radius;
-	float desiredSpeed;
+	float desiredSpeed;		// Negative until set or drawn by 'SocialForce'
 	Color3f colour;
 
 	Point3f position;
-	std::deque<Waypoint> path;
-	Vector3f velocity;
+	std::vector<Waypoint> path;
+	int target;				// Shared target in 'SocialForce', -1 follows 'path'
 
-	Vector3f drivingForce(const Point3f position_target);		// Computes f_i
-	Vector3f agentInteractForce(std::vector<Agent *> agents);	// Computes f_ij
-	Vector3f wallInteractForce(std::vector<Wall *> walls);		// Computes f_iw
+	void bind(CrowdState *state);	// Moves local values into 'state'
+
+	friend class SocialForce;
+	friend class DomainDecomposition;
 
 public:
 	Agent();
 	~Agent();
 
+	// Allocated from a Shared 'BlockPool'
+	static void *operator new(size_t size);
+	static void operator delete(void *pointer, size_t size);
+
 	void setRadius(float radius);
 	void setDesiredSpeed(float speed);
 	void setColour(float red, float green, float blue);
 	void setPosition(float x, float y);
 	void setPath(float x, float y, float radius);
-
-	int getId() const { return id; }
-	float getRadius() const { return radius; }
-	float getDesiredSpeed() const { return desiredSpeed; }
-	Color3f getColour() const { return colour; }
-	Point3f getPosition() const { return position; }
-	Point3f getPath();
-	Vector3f getVelocity() const { return velocity; }
-	float getOrientation();
+	void setTarget(int target);		// Follows the flow field of a 'SocialForce::addTarget()' result instead of its path  -1 restores the path
+
+	int getId() const { return id; }			// -1 until added
+	int getTarget() const;
+	AgentHandle getHandle() const { return handle; }
+	float getRadius() const;
+	float getDesiredSpeed() const;
+	Color3f getColour() const;
+	Point3f getPosition() const;
+	Point3f getPath() const;		// Current waypoint or shared target
+	Vector3f getVelocity() const;
+	bool isAsleep() const;			// See 'SocialForce::setSleep()'
+	float getOrientation() const;
 	Point3f getAheadVector() const;
-
-	void move(std::vector<Agent *> agents, std::vector<Wall *> walls, float stepTime);
 };
 
-#endif
\ No newline at end of file
+#endif
@@ -0,0 +1,74 @@
+#include "AgentHandle.h"
+using namespace std;
+
+AgentHandle HandleMap::insert(size_t idx) {
+	uint32_t slot;
+
+	// Reuse Released Slot if Available  Its generation already differs from every handle given out before
+	if (!freeSlots.empty()) {
+		slot = freeSlots.back();
+		freeSlots.pop_back();
+	}
+
+	else {
+		Slot fresh = { 0, 0 };
+
+		slot = slots.size();
+		slots.push_back(fresh);
+	}
+
+	slots[slot].idx = idx;
+	slotOf.push_back(slot);
+
+	return AgentHandle(slot, slots[slot].generation);
+}
+
+void HandleMap::release(size_t idx) {
+	uint32_t slot = slotOf[idx];
+
+	slots[slot].generation++;
+	freeSlots.push_back(slot);
+}
+
+void HandleMap::move(size_t from, size_t to) {
+	slotOf[to] = slotOf[from];
+	slots[slotOf[to]].idx = to;
+}
+
+void HandleMap::pop() {
+	slotOf.pop_back();
+}
+
+void HandleMap::permute(const vector<uint32_t> &order) {
+	previous.assign(slotOf.begin(), slotOf.end());
+
+	for (size_t idx = 0; idx < order.size(); idx++) {
+		slotOf[idx] = previous[order[idx]];
+		slots[slotOf[idx]].idx = idx;
+	}
+}
+
+void HandleMap::clear() {
+	// Keep Slots, So Handles Given Out Before Stay Stale
+	for (uint32_t slot : slotOf) {
+		slots[slot].generation++;
+		freeSlots.push_back(slot);
+	}
+
+	slotOf.clear();
+}
+
+void HandleMap::reserve(size_t capacity) {
+	slots.reserve(capacity);
+	freeSlots.reserve(capacity);
+	slotOf.reserve(capacity);
+	previous.reserve(capacity);
+}
+
+bool HandleMap::find(AgentHandle handle, size_t &idx) const {
+	if (handle.slot >= slots.size() || slots[handle.slot].generation != handle.generation)
+		return false;
+
+	idx = slots[handle.slot].idx;
+	return true;
+}
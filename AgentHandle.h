@@ -0,0 +1,48 @@
+#ifndef AGENT_HANDLE_H
+#define AGENT_HANDLE_H
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// Generational Reference to an Agent in 'SocialForce'  Stays valid while agents around it are added and removed,
+// and reports itself stale once its agent is removed, even after the slot is reused
+struct AgentHandle {
+	uint32_t slot;
+	uint32_t generation;
+
+	AgentHandle() : slot(UINT32_MAX), generation(0) {}
+	AgentHandle(uint32_t slot, uint32_t generation) : slot(slot), generation(generation) {}
+
+	bool operator==(const AgentHandle &other) const { return slot == other.slot && generation == other.generation; }
+	bool operator!=(const AgentHandle &other) const { return !(*this == other); }
+};
+
+// Slot Map from Handles to Indices of 'CrowdState'  Every operation is O(1)
+class HandleMap {
+private:
+	struct Slot {
+		uint32_t idx;				// Index in 'CrowdState' while in use
+		uint32_t generation;		// Incremented on release, so older handles no longer match
+	};
+
+	std::vector<Slot> slots;
+	std::vector<uint32_t> freeSlots;
+	std::vector<uint32_t> slotOf;	// Slot of each 'CrowdState' index
+	std::vector<uint32_t> previous;	// Scratch of 'permute()'
+
+public:
+	AgentHandle insert(size_t idx);			// 'idx' must be the next index, i.e. the current size
+	void release(size_t idx);				// Frees the slot of 'idx'  Call 'move()' next if another agent takes its place
+	void move(size_t from, size_t to);		// Agent at 'from' now lives at 'to'
+	void pop();								// Drops the last index after 'release()' and 'move()'
+	void permute(const std::vector<uint32_t> &order);	// Agent at 'order[i]' now lives at 'i', as 'CrowdState::permute()'
+	void clear();
+	void reserve(size_t capacity);
+
+	bool find(AgentHandle handle, size_t &idx) const;
+	AgentHandle getHandle(size_t idx) const { return AgentHandle(slotOf[idx], slots[slotOf[idx]].generation); }
+	size_t size() const { return slotOf.size(); }
+};
+
+#endif
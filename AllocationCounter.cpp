@@ -0,0 +1,35 @@
+#include <cstdlib>
+#include <new>
+#include "Profiler.h"
+using namespace std;
+
+// Global 'operator new' Counting Heap Allocations for 'Profiler'  Linked into the tools only (see CMakeLists.txt), so programs built on
+// the library keep an untouched allocator
+void *operator new(size_t size) {
+	void *pointer;
+
+	Profiler::countAllocation(size);
+
+	while (!(pointer = malloc(size ? size : 1))) {
+		new_handler handler = get_new_handler();
+
+		if (!handler)
+			throw bad_alloc();
+
+		handler();
+	}
+
+	return pointer;
+}
+
+void *operator new[](size_t size) {
+	return ::operator new(size);
+}
+
+void operator delete(void *pointer) noexcept {
+	free(pointer);
+}
+
+void operator delete[](void *pointer) noexcept {
+	free(pointer);
+}
@@ -0,0 +1,1117 @@
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <random>
+#if defined(__linux__)
+#include <linux/perf_event.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+#include <string>
+#include <thread>
+#include <vector>
+#include "CrowdAnalytics.h"
+#include "DomainDecomposition.h"
+#include "FastMath.h"
+#include "Profiler.h"
+#include "SocialForce.h"
+#include "Scene.h"
+#include "SpatialGrid.h"
+using namespace std;
+
+const char *SCENARIOS[] = { "corridor", "bottleneck", "evacuation", "maze" };
+const int NUM_SCENARIOS = 4;
+const char *MODELS[] = { "moussaid", "moussaid-double", "runtime", "runtime-double" };
+const int NUM_MODELS = 4;
+const float PI = 3.14159265359F;
+
+// Command Line Options
+struct BenchOptions {
+	vector<string> scenarios;
+	vector<string> models;		// See 'createForceModel()'
+	vector<int> sizes;
+	int numSteps;				// 0 picks a count from crowd size
+	int warmupSteps;
+	int numWalls;				// Walls of the maze scenario
+	float stepTime;
+	float skin;					// Negative keeps the engine default
+	SpaceCurve order;			// Curve agents are sorted along
+	int reorderInterval;		// Steps between sorts
+	int maxRateLevel;			// Multirate stepping, 0 evaluates every agent every step
+	float sleepDelay;			// Seconds at rest before an agent sleeps, 0 never
+	int numThreads;				// 0 uses every hardware thread
+	unsigned int seed;
+	const char *kernel;			// Null selects widest path this CPU supports
+	const char *model;			// See 'createForceModel()'
+	const char *outputPath;		// Null writes to standard output
+	const char *label;			// Free text copied into every record, e.g. a commit hash
+	bool fastMath;
+	bool validate;				// Check vector kernels against the scalar kernel instead of benchmarking
+	bool locality;				// Long corridor under every agent order instead of the scenarios
+};
+
+// Function Prototypes
+bool parseOptions(int argc, char **argv, BenchOptions &options);
+void printUsage(const char *program);
+void configureEngine(SocialForce *socialForce, const BenchOptions &options);
+void runScenario(FILE *output, const BenchOptions &options, const string &scenario, const string &model, int numAgents);
+void runLocality(FILE *output, const BenchOptions &options, int numAgents);
+bool validateKernels(FILE *output);
+bool validateTrajectories(FILE *output);
+bool validateDecomposition(FILE *output, int maxRateLevel = 0, float sleepDelay = 0.0F);
+bool validateOrdering(FILE *output);
+bool validateAnalytics(FILE *output);
+bool validateMultirate(FILE *output);
+bool validateSleep(FILE *output);
+#ifdef SFM_PROFILING
+bool validateAllocations(FILE *output);
+#endif
+double neighbourIndexGap(const CrowdState &state, SpatialGrid &grid, vector<int> &candidates);
+int openCacheMissCounter();
+long long readCounter(int counter);
+double residentMegabytes();
+vector<int> parseSizes(const char *list);
+
+int main(int argc, char **argv) {
+	BenchOptions options;
+	FILE *output = stdout;
+	bool passed = true;
+
+	if (!parseOptions(argc, argv, options)) {
+		printUsage(argv[0]);
+		return 1;
+	}
+
+	if (options.outputPath) {
+		output = fopen(options.outputPath, "w");
+
+		if (!output) {
+			fprintf(stderr, "Cannot open '%s' for writing\n", options.outputPath);
+			return 1;
+		}
+	}
+
+	if (options.validate)
+		passed = validateKernels(output);
+
+	else if (options.locality) {
+		for (int numAgents : options.sizes)
+			runLocality(output, options, numAgents);
+	}
+
+	else {
+		for (const string &scenario : options.scenarios) {
+			for (const string &model : options.models) {
+				for (int numAgents : options.sizes)
+					runScenario(output, options, scenario, model, numAgents);
+			}
+		}
+	}
+
+	if (output != stdout)
+		fclose(output);
+
+	return passed ? 0 : 1;
+}
+
+bool parseOptions(int argc, char **argv, BenchOptions &options) {
+	bool large = false;
+
+	options.numSteps = 0;
+	options.warmupSteps = 10;
+	options.numWalls = 2000;
+	options.stepTime = 0.02F;
+	options.skin = -1.0F;
+	options.order = SpaceCurve::Morton;
+	options.reorderInterval = 100;
+	options.maxRateLevel = 0;
+	options.sleepDelay = 0.0F;
+	options.numThreads = 0;
+	options.seed = 1604010629;
+	options.kernel = 0;
+	options.model = "moussaid";
+	options.outputPath = 0;
+	options.label = "";
+	options.fastMath = false;
+	options.validate = false;
+	options.locality = false;
+
+	for (int idx = 1; idx < argc; idx++) {
+		const char *option = argv[idx];
+		const char *value = (idx + 1 < argc) ? argv[idx + 1] : 0;
+
+		// Options Without Value
+		if (strcmp(option, "--large") == 0) {
+			large = true;
+			continue;
+		}
+
+		if (strcmp(option, "--validate") == 0) {
+			options.validate = true;
+			continue;
+		}
+
+		if (strcmp(option, "--locality") == 0) {
+			options.locality = true;
+			continue;
+		}
+
+		if (strcmp(option, "--fast-math") == 0) {
+			options.fastMath = true;
+			continue;
+		}
+
+		if (strcmp(option, "--help") == 0 || strcmp(option, "-h") == 0 || !value)
+			return false;
+
+		if (strcmp(option, "--scenario") == 0) {
+			if (strcmp(value, "all") != 0)
+				options.scenarios.push_back(value);
+		}
+
+		else if (strcmp(option, "--model") == 0) {
+			if (strcmp(value, "all") == 0)
+				options.models.assign(MODELS, MODELS + NUM_MODELS);
+			else
+				options.models.push_back(value);
+		}
+
+		else if (strcmp(option, "--sizes") == 0)
+			options.sizes = parseSizes(value);
+		else if (strcmp(option, "--steps") == 0)
+			options.numSteps = atoi(value);
+		else if (strcmp(option, "--warmup") == 0)
+			options.warmupSteps = atoi(value);
+		else if (strcmp(option, "--walls") == 0)
+			options.numWalls = atoi(value);
+		else if (strcmp(option, "--dt") == 0)
+			options.stepTime = static_cast<float>(atof(value));
+		else if (strcmp(option, "--skin") == 0)
+			options.skin = static_cast<float>(atof(value));
+		else if (strcmp(option, "--order") == 0) {
+			if (!parseSpaceCurve(value, options.order))
+				return false;
+		}
+
+		else if (strcmp(option, "--reorder-every") == 0)
+			options.reorderInterval = atoi(value);
+		else if (strcmp(option, "--multirate") == 0)
+			options.maxRateLevel = atoi(value);
+		else if (strcmp(option, "--sleep") == 0)
+			options.sleepDelay = static_cast<float>(atof(value));
+		else if (strcmp(option, "--threads") == 0)
+			options.numThreads = atoi(value);
+		else if (strcmp(option, "--seed") == 0)
+			options.seed = static_cast<unsigned int>(strtoul(value, 0, 10));
+		else if (strcmp(option, "--kernel") == 0)
+			options.kernel = value;
+		else if (strcmp(option, "--model") == 0)
+			options.model = value;
+		else if (strcmp(option, "--output") == 0)
+			options.outputPath = value;
+		else if (strcmp(option, "--label") == 0)
+			options.label = value;
+		else
+			return false;
+
+		idx++;		// Skip consumed value
+	}
+
+	if (options.scenarios.empty())
+		options.scenarios.assign(SCENARIOS, SCENARIOS + NUM_SCENARIOS);
+
+	if (options.models.empty())
+		options.models.push_back(MODELS[0]);
+
+	if (options.sizes.empty()) {
+		options.sizes = parseSizes("400,4000,40000");
+
+		if (large) {
+			options.sizes.push_back(400000);
+			options.sizes.push_back(1000000);
+		}
+	}
+
+	return options.stepTime > 0.0F && options.warmupSteps >= 0;
+}
+
+void printUsage(const char *program) {
+	printf("Usage: %s [options]\n", program);
+	printf("  --scenario NAME     corridor, bottleneck, evacuation, maze or all (repeatable, default all)\n");
+	printf("  --model NAME        moussaid, moussaid-double, runtime, runtime-double or all (repeatable, default moussaid)\n");
+	printf("  --sizes N,N,...     Crowd sizes (default 400,4000,40000)\n");
+	printf("  --large             Also run 400000 and 1000000 agents\n");
+	printf("  --steps N           Measured steps per run (default scales with crowd size)\n");
+	printf("  --warmup N          Unmeasured steps before measuring (default 10)\n");
+	printf("  --walls N           Wall segments of the maze scenario (default 2000)\n");
+	printf("  --dt SECONDS        Step time (default 0.02)\n");
+	printf("  --skin METRES       Neighbour list skin, 0 rebuilds every step (default 0.3)\n");
+	printf("  --order NAME        Curve agents are sorted along: none, morton or hilbert (default morton)\n");
+	printf("  --reorder-every N   Steps between sorts (default 100)\n");
+	printf("  --multirate LEVELS  Agents in free flow evaluate forces every 2^level steps, up to 7 levels (default 0, off)\n");
+	printf("  --sleep SECONDS     Agents nearly still this long are skipped until a moving neighbour wakes them (default 0, off)\n");
+	printf("  --threads N         Worker threads, 0 for all hardware threads (default 0)\n");
+	printf("  --seed N            Seed of the scene layout (default 1604010629)\n");
+	printf("  --kernel NAME       scalar, avx2 or avx512 (default widest supported)\n");
+	printf("  --output FILE       Write JSON lines to FILE instead of standard output\n");
+	printf("  --label TEXT        Copied into every record, e.g. a commit hash\n");
+	printf("  --fast-math         Approximate exp, atan2 and square roots in the interaction kernel\n");
+	printf("  --validate          Compare vector kernels with the scalar kernel, exit 1 if over the error bound\n");
+	printf("  --locality          Long bidirectional corridor under every agent order, step time and cache misses over time\n");
+}
+
+// Settings Shared by Every Run  Threads are set on construction
+void configureEngine(SocialForce *socialForce, const BenchOptions &options) {
+	socialForce->setSeed(options.seed);
+	socialForce->setAgentOrder(options.order, options.reorderInterval);
+	socialForce->setMultirate(options.maxRateLevel);
+	socialForce->setSleep(options.sleepDelay);
+
+	if (options.skin >= 0.0F)
+		socialForce->setNeighbourSkin(options.skin);
+
+	if (options.fastMath)
+		socialForce->setMathMode(MathMode::Fast);
+
+	if (options.kernel) {
+		if (strcmp(options.kernel, "scalar") == 0)
+			socialForce->setKernelPath(KernelPath::Scalar);
+		else if (strcmp(options.kernel, "avx2") == 0)
+			socialForce->setKernelPath(KernelPath::AVX2);
+		else if (strcmp(options.kernel, "avx512") == 0)
+			socialForce->setKernelPath(KernelPath::AVX512);
+	}
+}
+
+void runScenario(FILE *output, const BenchOptions &options, const string &scenario, const string &model, int numAgents) {
+	SocialForce *socialForce;
+	ForceModel *forceModel;
+	StepStats total;
+	double memoryBefore, memoryAfter;
+	unsigned long long numBuilds, agentSteps = 0, agentsAsleep = 0;
+	int numSteps;
+
+	memoryBefore = residentMegabytes();
+
+	forceModel = createForceModel(model.c_str());
+
+	if (!forceModel) {
+		fprintf(stderr, "Unknown model '%s'\n", model.c_str());
+		return;
+	}
+
+	socialForce = new SocialForce(options.numThreads);
+	socialForce->setForceModel(forceModel);
+	configureEngine(socialForce, options);
+
+	if (!createScene(socialForce, scenario.c_str(), numAgents, options.numWalls)) {
+		fprintf(stderr, "Unknown scenario '%s'\n", scenario.c_str());
+		delete socialForce;
+		return;
+	}
+
+	// Roughly Constant Work per Run Unless Given
+	numSteps = (options.numSteps > 0) ? options.numSteps : max(5, min(200, 2000000 / max(numAgents, 1)));
+
+	for (int step = 0; step < options.warmupSteps; step++)
+		socialForce->moveCrowd(options.stepTime);
+
+	numBuilds = socialForce->getNeighbourListBuilds();
+
+	for (int step = 0; step < numSteps; step++) {
+		socialForce->moveCrowd(options.stepTime);
+
+		const StepStats &stats = socialForce->getStepStats();
+		total.neighbourSearchTime += stats.neighbourSearchTime;
+		total.drivingTime += stats.drivingTime;
+		total.agentInteractTime += stats.agentInteractTime;
+		total.wallInteractTime += stats.wallInteractTime;
+		total.integrationTime += stats.integrationTime;
+		total.totalTime += stats.totalTime;
+		total.pairsConsidered += stats.pairsConsidered;
+		total.pairsWithinRange += stats.pairsWithinRange;
+		total.agentsEvaluated += stats.agentsEvaluated;
+		agentsAsleep += stats.agentsAsleep;
+		agentSteps += socialForce->getCrowdSize();
+	}
+
+	memoryAfter = residentMegabytes();
+
+	fprintf(output, "{\"label\":\"%s\",\"scenario\":\"%s\",\"agents\":%d,\"walls\":%d,\"steps\":%d,\"threads\":%d,\"kernel\":\"%s\",\"math\":\"%s\",\"model\":\"%s\","
+			"\"step_ms\":%.4f,\"phase_ms\":{\"neighbour_search\":%.4f,\"driving\":%.4f,\"agent_interaction\":%.4f,"
+			"\"wall_interaction\":%.4f,\"integration\":%.4f},\"agent_steps_per_s\":%.0f,\"pairs_per_s\":%.0f,"
+			"\"pairs_considered_per_s\":%.0f,\"pairs_per_agent\":%.2f,\"skin\":%.2f,\"order\":\"%s\",\"multirate\":%d,\"evaluated_share\":%.3f,"
+			"\"sleep\":%g,\"asleep_share\":%.3f,\"neighbour_builds\":%llu,\"memory_mb\":%.1f}\n",
+			options.label, scenario.c_str(), socialForce->getCrowdSize(), socialForce->getNumWalls(), numSteps,
+			socialForce->getNumThreads(), getKernelPathName(socialForce->getKernelPath()),
+			(socialForce->getMathMode() == MathMode::Fast) ? "fast" : "precise", socialForce->getForceModel().getName(),
+			1000.0 * total.totalTime / numSteps, 1000.0 * total.neighbourSearchTime / numSteps, 1000.0 * total.drivingTime / numSteps,
+			1000.0 * total.agentInteractTime / numSteps, 1000.0 * total.wallInteractTime / numSteps,
+			1000.0 * total.integrationTime / numSteps, static_cast<double>(numSteps) * socialForce->getCrowdSize() / total.totalTime,
+			total.pairsWithinRange / total.totalTime, total.pairsConsidered / total.totalTime,
+			static_cast<double>(total.pairsWithinRange) / (static_cast<double>(numSteps) * max(socialForce->getCrowdSize(), 1)),
+			socialForce->getNeighbourSkin(), getSpaceCurveName(socialForce->getAgentOrder()), socialForce->getMaxRateLevel(),
+			static_cast<double>(total.agentsEvaluated) / max(agentSteps, 1ULL), socialForce->getSleepDelay(),
+			static_cast<double>(agentsAsleep) / max(agentSteps, 1ULL), socialForce->getNeighbourListBuilds() - numBuilds,
+			memoryAfter - memoryBefore);
+	fflush(output);
+
+	delete socialForce;
+}
+
+// Long Bidirectional Corridor Under Each Agent Order, Reported in Windows So the Drift Away From Insertion Order Shows
+void runLocality(FILE *output, const BenchOptions &options, int numAgents) {
+	const SpaceCurve curves[] = { SpaceCurve::None, SpaceCurve::Morton, SpaceCurve::Hilbert };
+	const int numWindows = 10;
+	int numSteps = (options.numSteps > 0) ? options.numSteps : 3000;
+	int windowSteps = max(numSteps / numWindows, 1);
+	SpatialGrid grid;
+	vector<int> candidates;
+
+	for (SpaceCurve curve : curves) {
+		int counter = openCacheMissCounter();	// Before the engine starts its worker threads, so they inherit it
+		SocialForce *socialForce = new SocialForce(options.numThreads);
+		long long misses = readCounter(counter), previousMisses;
+
+		configureEngine(socialForce, options);
+		socialForce->setAgentOrder(curve, options.reorderInterval);
+		createScene(socialForce, "corridor", numAgents, 0);
+
+		for (int window = 0; window < numWindows; window++) {
+			StepStats total;
+			unsigned int numReorders = 0;
+
+			for (int step = 0; step < windowSteps; step++) {
+				socialForce->moveCrowd(options.stepTime);
+
+				const StepStats &stats = socialForce->getStepStats();
+				total.neighbourSearchTime += stats.neighbourSearchTime;
+				total.agentInteractTime += stats.agentInteractTime;
+				total.totalTime += stats.totalTime;
+				numReorders += stats.agentsReordered;
+			}
+
+			// Worker Threads Add Their Counts to the Counter as They Exit, So Restart Them Before Reading
+			socialForce->setNumThreads(socialForce->getNumThreads());
+			previousMisses = misses;
+			misses = readCounter(counter);
+
+			fprintf(output, "{\"label\":\"%s\",\"locality\":\"corridor\",\"order\":\"%s\",\"agents\":%d,\"threads\":%d,\"reorder_every\":%d,"
+					"\"window\":%d,\"first_step\":%d,\"steps\":%d,\"step_ms\":%.4f,\"neighbour_search_ms\":%.4f,\"agent_interaction_ms\":%.4f,"
+					"\"reorders\":%u,\"neighbour_index_gap\":%.1f,\"cache_misses_per_agent_step\":", options.label, getSpaceCurveName(curve),
+					socialForce->getCrowdSize(), socialForce->getNumThreads(), options.reorderInterval, window, window * windowSteps, windowSteps,
+					1000.0 * total.totalTime / windowSteps, 1000.0 * total.neighbourSearchTime / windowSteps,
+					1000.0 * total.agentInteractTime / windowSteps, numReorders, neighbourIndexGap(socialForce->getState(), grid, candidates));
+
+			if (misses >= 0)
+				fprintf(output, "%.2f}\n", static_cast<double>(misses - previousMisses) / (static_cast<double>(windowSteps) * max(numAgents, 1)));
+			else
+				fprintf(output, "null}\n");	// No hardware counters on this platform or for this user
+
+			fflush(output);
+		}
+
+		delete socialForce;
+
+#if defined(__linux__)
+		if (counter >= 0)
+			close(counter);
+#endif
+	}
+}
+
+// Random Neighbours Within Interaction Range
+static void randomBatch(default_random_engine &generator, int numNeighbours, NeighbourBatch &batch) {
+	uniform_real_distribution<float> distribution(-1.0F, 1.0F);
+	float distanceX, distanceY;
+
+	batch.clear();
+
+	for (int idx = 0; idx < numNeighbours; idx++) {
+		do {
+			distanceX = 2.0F * distribution(generator);
+			distanceY = 2.0F * distribution(generator);
+		} while (distanceX * distanceX + distanceY * distanceY > 4.0F || distanceX * distanceX + distanceY * distanceY < 0.01F);
+
+		batch.add(distanceX, distanceY, 1.5F * distribution(generator), 1.5F * distribution(generator));
+	}
+}
+
+bool validateKernels(FILE *output) {
+	const KernelPath paths[] = { KernelPath::Scalar, KernelPath::AVX2, KernelPath::AVX512 };
+	const MathMode modes[] = { MathMode::Precise, MathMode::Fast };
+	InteractionParams params = { 2.0F, 0.35F, 3.0F, 2.0F, 4.5F };
+	bool passed = true;
+
+	for (MathMode mode : modes) {
+		for (KernelPath path : paths) {
+			default_random_engine generator(1);
+			const char *modeName = (mode == MathMode::Fast) ? "fast" : "precise";
+			double relativeBound = (mode == MathMode::Fast) ? FAST_MATH_RELATIVE_BOUND : 1.0e-4;	// Of the summed force, for forces above 1e-3
+			double absoluteBound = (mode == MathMode::Fast) ? FAST_MATH_ABSOLUTE_BOUND : 1.0e-5;
+			double maxRelative = 0.0, maxAbsolute = 0.0;
+			bool pathPassed;
+
+			if (path == KernelPath::Scalar && mode == MathMode::Precise)
+				continue;	// The reference
+
+			if (!isKernelPathSupported(path)) {
+				fprintf(output, "{\"validate\":\"%s\",\"math\":\"%s\",\"supported\":false}\n", getKernelPathName(path), modeName);
+				continue;
+			}
+
+			for (int trial = 0; trial < 20000; trial++) {
+				NeighbourBatch batch;
+				float scalarX, scalarY, vectorX, vectorY;
+				double magnitude, error;
+
+				randomBatch(generator, 1 + trial % 40, batch);
+
+				interactScalar(batch, params, scalarX, scalarY);
+				batch.pad(getKernelWidth(path));
+				getInteractionKernel(path, mode)(batch, params, vectorX, vectorY);
+
+				magnitude = sqrt(static_cast<double>(scalarX) * scalarX + static_cast<double>(scalarY) * scalarY);
+				error = sqrt(static_cast<double>(vectorX - scalarX) * (vectorX - scalarX) + static_cast<double>(vectorY - scalarY) * (vectorY - scalarY));
+
+				maxAbsolute = max(maxAbsolute, error);
+
+				if (magnitude > 1.0e-3)
+					maxRelative = max(maxRelative, error / magnitude);
+			}
+
+			pathPassed = maxRelative <= relativeBound && maxAbsolute <= absoluteBound;
+			passed = passed && pathPassed;
+
+			fprintf(output, "{\"validate\":\"%s\",\"math\":\"%s\",\"supported\":true,\"max_relative_error\":%.3g,\"max_absolute_error\":%.3g,"
+					"\"relative_bound\":%g,\"absolute_bound\":%g,\"pass\":%s}\n", getKernelPathName(path), modeName, maxRelative, maxAbsolute,
+					relativeBound, absoluteBound, pathPassed ? "true" : "false");
+		}
+	}
+
+	passed = validateTrajectories(output) && passed;
+	passed = validateDecomposition(output) && passed;
+	passed = validateDecomposition(output, 3, 0.5F) && passed;
+	passed = validateOrdering(output) && passed;
+	passed = validateAnalytics(output) && passed;
+	passed = validateMultirate(output) && passed;
+	passed = validateSleep(output) && passed;
+#ifdef SFM_PROFILING
+	passed = validateAllocations(output) && passed;
+#else
+	// Not Run, So Neither Passed Nor Failed  Allocations are only counted with the profiler compiled in
+	fprintf(output, "{\"validate\":\"allocations\",\"skipped\":true,\"reason\":\"built without SFM_PROFILING\"}\n");
+	fprintf(stderr, "Allocation check skipped, built without SFM_PROFILING\n");
+#endif
+
+	return passed;
+}
+
+// Long Corridor Run in Fast and Precise Mode on the Same Kernel Path, Stepped in Lockstep
+// Crowds are chaotic, so single agents part ways eventually whatever the error (precise kernels of different paths do too)
+// Positions are therefore bounded over a short horizon only, the whole run is bounded through mean speed and progress
+bool validateTrajectories(FILE *output) {
+	const int numAgents = 400, numSteps = 3000, shortSteps = 100;
+	const double positionBound = 1.0e-4;	// Metres, largest deviation of any agent within 'shortSteps'
+	const double meanBound = 1.0e-3;		// Relative, of mean speed and mean distance walked over the run
+	SocialForce *runs[2];
+	vector<float> startX[2];
+	double speedSum[2] = { 0.0, 0.0 }, progress[2] = { 0.0, 0.0 }, shortDeviation = 0.0, speedError, progressError;
+	bool passed;
+
+	for (int run = 0; run < 2; run++) {
+		runs[run] = new SocialForce;
+		runs[run]->setSeed(1604010629);
+		runs[run]->setNumThreads(1);
+		runs[run]->setMathMode((run == 0) ? MathMode::Precise : MathMode::Fast);
+		runs[run]->setAgentOrder(SpaceCurve::None);		// Compared index by index
+		createScene(runs[run], "corridor", numAgents, 0);
+		startX[run] = runs[run]->getState().positionX;
+	}
+
+	for (int step = 1; step <= numSteps; step++) {
+		for (int run = 0; run < 2; run++) {
+			const CrowdState &state = runs[run]->getState();
+
+			runs[run]->moveCrowd(0.02F);
+
+			for (size_t idx = 0; idx < state.size(); idx++)
+				speedSum[run] += sqrt(state.velocityX[idx] * state.velocityX[idx] + state.velocityY[idx] * state.velocityY[idx]);
+		}
+
+		const CrowdState &precise = runs[0]->getState(), &fast = runs[1]->getState();
+
+		for (size_t idx = 0; step <= shortSteps && idx < precise.size(); idx++) {
+			double deviationX = fast.positionX[idx] - precise.positionX[idx], deviationY = fast.positionY[idx] - precise.positionY[idx];
+			shortDeviation = max(shortDeviation, sqrt(deviationX * deviationX + deviationY * deviationY));
+		}
+	}
+
+	// Net Distance Walked Along the Corridor
+	for (int run = 0; run < 2; run++) {
+		const CrowdState &state = runs[run]->getState();
+
+		for (size_t idx = 0; idx < state.size(); idx++)
+			progress[run] += fabs(state.positionX[idx] - startX[run][idx]);
+	}
+
+	speedError = fabs(speedSum[1] - speedSum[0]) / speedSum[0];
+	progressError = fabs(progress[1] - progress[0]) / progress[0];
+	passed = shortDeviation <= positionBound && speedError <= meanBound && progressError <= meanBound;
+
+	fprintf(output, "{\"validate\":\"trajectory\",\"kernel\":\"%s\",\"agents\":%d,\"steps\":%d,\"max_deviation_m\":%.3g,\"deviation_steps\":%d,"
+			"\"deviation_bound_m\":%g,\"mean_speed_error\":%.3g,\"mean_progress_error\":%.3g,\"mean_bound\":%g,\"pass\":%s}\n",
+			getKernelPathName(runs[0]->getKernelPath()), numAgents, numSteps, shortDeviation, shortSteps, positionBound, speedError, progressError,
+			meanBound, passed ? "true" : "false");
+
+	delete runs[0];
+	delete runs[1];
+
+	return passed;
+}
+
+// Corridor Split Across Ranks Over the Shared-Memory Transport, Compared With One Engine Running the Whole Scene
+// Neighbours are summed in a different order on each side, so positions are bounded over a short horizon as above  With multirate
+// stepping or sleeping, agents that migrate keep their level and rest, so the ranks still step them as the single engine does
+bool validateDecomposition(FILE *output, int maxRateLevel, float sleepDelay) {
+	const int numAgents = 400, numSteps = 100, numRanks = 4;
+	const double positionBound = 1.0e-4;	// Metres
+	vector<LocalTransport *> transports = LocalTransport::create(numRanks);
+	vector<SocialForce *> ranks;
+	vector<DomainDecomposition *> decompositions;
+	vector<thread> threads;
+	vector<RemoteAgent> gathered;
+	vector<char> rankSucceeded(numRanks, 0);	// Written by each rank's thread
+	SocialForce reference;
+	double deviation = 0.0;
+	bool distributed = true, passed;
+
+	reference.setSeed(1604010629);
+	reference.setNumThreads(1);
+	reference.setMultirate(maxRateLevel);
+	reference.setSleep(sleepDelay);
+	createScene(&reference, "corridor", numAgents, 0);
+
+	// Same Seed, So the Same Scene on Every Rank
+	for (int rank = 0; rank < numRanks; rank++) {
+		ranks.push_back(new SocialForce);
+		ranks[rank]->setSeed(1604010629);
+		ranks[rank]->setNumThreads(1);
+		ranks[rank]->setMultirate(maxRateLevel);
+		ranks[rank]->setSleep(sleepDelay);
+		createScene(ranks[rank], "corridor", numAgents, 0);
+
+		decompositions.push_back(new DomainDecomposition(ranks[rank], transports[rank]));
+		decompositions[rank]->setRebalanceInterval(10);
+		distributed = decompositions[rank]->distribute() && distributed;
+	}
+
+	for (int step = 0; step < numSteps; step++)
+		reference.moveCrowd(0.02F);
+
+	for (int rank = 0; distributed && rank < numRanks; rank++) {
+		threads.push_back(thread([&, rank] {
+			bool stepped = true;
+			vector<RemoteAgent> agents;
+
+			for (int step = 0; stepped && step < numSteps; step++)
+				stepped = decompositions[rank]->step();
+
+			rankSucceeded[rank] = stepped && decompositions[rank]->gather(agents);
+
+			if (rank == 0)
+				gathered = agents;
+		}));
+	}
+
+	for (thread &rankThread : threads)
+		rankThread.join();
+
+	// Every Agent Once, Where the Single Engine Has It
+	const CrowdState &state = reference.getState();
+
+	passed = distributed && count(rankSucceeded.begin(), rankSucceeded.end(), 1) == numRanks && gathered.size() == state.size();
+
+	for (size_t idx = 0; passed && idx < state.size(); idx++) {
+		int id = state.id[idx];
+		const RemoteAgent *agent = lower_bound(gathered.data(), gathered.data() + gathered.size(), id,
+											   [](const RemoteAgent &first, int second) { return first.id < second; });
+		double deviationX, deviationY;
+
+		passed = agent != gathered.data() + gathered.size() && agent->id == id;
+
+		if (passed) {
+			deviationX = agent->x - state.positionX[idx];
+			deviationY = agent->y - state.positionY[idx];
+			deviation = max(deviation, sqrt(deviationX * deviationX + deviationY * deviationY));
+		}
+	}
+
+	passed = passed && deviation <= positionBound;
+
+	fprintf(output, "{\"validate\":\"decomposition\",\"transport\":\"%s\",\"ranks\":%d,\"multirate\":%d,\"sleep\":%g,\"agents\":%d,\"steps\":%d,"
+			"\"gathered\":%d,\"max_deviation_m\":%.3g,\"deviation_bound_m\":%g,\"pass\":%s}\n", transports[0]->getName(), numRanks, maxRateLevel,
+			sleepDelay, numAgents, numSteps, static_cast<int>(gathered.size()), deviation, positionBound, passed ? "true" : "false");
+
+	for (int rank = 0; rank < numRanks; rank++) {
+		delete decompositions[rank];
+		delete ranks[rank];
+		delete transports[rank];
+	}
+
+	return passed;
+}
+
+// Corridor Sorted Along the Hilbert Curve Every 10 Steps, Compared With Insertion Order  Agents are reached through handles taken
+// before the first sort, so a handle that lost its agent fails the check  Sorting changes the order neighbours are summed in only,
+// so positions are bounded over a short horizon as above
+bool validateOrdering(FILE *output) {
+	const int numAgents = 400, numSteps = 100;
+	const double positionBound = 1.0e-4;	// Metres
+	SocialForce *runs[2];
+	vector<AgentHandle> handles;
+	vector<int> ids;
+	vector<size_t> referenceIdx;			// Index of each id in the unsorted run
+	SpatialGrid grid;
+	vector<int> candidates;
+	double deviation = 0.0, gap[2];
+	unsigned int numReorders = 0;
+	bool handlesValid = true, passed;
+
+	for (int run = 0; run < 2; run++) {
+		runs[run] = new SocialForce(1);
+		runs[run]->setSeed(1604010629);
+		runs[run]->setAgentOrder((run == 0) ? SpaceCurve::None : SpaceCurve::Hilbert, 10);
+		createScene(runs[run], "corridor", numAgents, 0);
+	}
+
+	for (Agent *agent : runs[1]->getCrowd()) {
+		handles.push_back(agent->getHandle());
+		ids.push_back(agent->getId());
+	}
+
+	for (int step = 0; step < numSteps; step++) {
+		runs[0]->moveCrowd(0.02F);
+		runs[1]->moveCrowd(0.02F);
+		numReorders += runs[1]->getStepStats().agentsReordered;
+	}
+
+	const CrowdState &reference = runs[0]->getState();
+
+	for (size_t idx = 0; idx < reference.size(); idx++) {
+		if (reference.id[idx] >= static_cast<int>(referenceIdx.size()))
+			referenceIdx.resize(reference.id[idx] + 1, reference.size());
+
+		referenceIdx[reference.id[idx]] = idx;
+	}
+
+	for (size_t agentIdx = 0; handlesValid && agentIdx < handles.size(); agentIdx++) {
+		Agent *agent = runs[1]->getAgent(handles[agentIdx]);
+		size_t idx;
+		double deviationX, deviationY;
+
+		handlesValid = agent && agent->getId() == ids[agentIdx] && ids[agentIdx] < static_cast<int>(referenceIdx.size()) &&
+					   referenceIdx[ids[agentIdx]] < reference.size();
+
+		if (handlesValid) {
+			idx = referenceIdx[ids[agentIdx]];
+			deviationX = agent->getPosition().x - reference.positionX[idx];
+			deviationY = agent->getPosition().y - reference.positionY[idx];
+			deviation = max(deviation, sqrt(deviationX * deviationX + deviationY * deviationY));
+		}
+	}
+
+	for (int run = 0; run < 2; run++)
+		gap[run] = neighbourIndexGap(runs[run]->getState(), grid, candidates);
+
+	passed = handlesValid && numReorders > 0 && deviation <= positionBound && gap[1] < gap[0];
+
+	fprintf(output, "{\"validate\":\"ordering\",\"order\":\"hilbert\",\"agents\":%d,\"steps\":%d,\"reorders\":%u,\"handles_valid\":%s,"
+			"\"max_deviation_m\":%.3g,\"deviation_bound_m\":%g,\"neighbour_index_gap\":%.1f,\"unsorted_neighbour_index_gap\":%.1f,\"pass\":%s}\n",
+			numAgents, numSteps, numReorders, handlesValid ? "true" : "false", deviation, positionBound, gap[1], gap[0], passed ? "true" : "false");
+
+	delete runs[0];
+	delete runs[1];
+
+	return passed;
+}
+
+// Square Lattice of Known Density Walking Along +x, Measured Sample by Sample
+// Every agent of the column that passes the line must be counted once, the fundamental diagram must peak in the bin of the lattice
+// density (less the kernel mass cut off at 3 sigma), and cells away from the edges of the lattice must match the lattice
+bool validateAnalytics(FILE *output) {
+	const float spacing = 0.5F, speed = 1.0F, shift = 0.1F;		// 4 agents per square metre, moving 'shift' per sample
+	const int side = 40, numSamples = 6;
+	const double latticeDensity = 1.0 / (spacing * spacing), densityBound = 0.02;	// Relative
+	CrowdState crowd;
+	CrowdAnalytics analytics;
+	vector<Waypoint> noPath;
+	double expectedKernelDensity = latticeDensity * (1.0 - exp(-4.5)), kernelDensity, cellDensity = 0.0, cellError;
+	unsigned long long crossings[2], peakCount = 0;
+	size_t peakBin = 0;
+	bool passed;
+
+	// Lattice Spanning x and y in [-10, 10), Line at x = 0.25 Passed by the Column at x = 0 Only
+	for (int row = 0; row < side; row++) {
+		for (int col = 0; col < side; col++) {
+			size_t idx = crowd.addAgent(row * side + col, 0.2F, speed, Color3f(), (col - side / 2) * spacing, (row - side / 2) * spacing, noPath, -1);
+
+			crowd.velocityX[idx] = speed;
+		}
+	}
+
+	analytics.setGrid(-10.0F, -10.0F, 10.0F, 10.0F, 1.0F);
+	analytics.setSampleInterval(1);
+	analytics.addLine(0.25F, -20.0F, 0.25F, 20.0F);
+	analytics.open(0);
+
+	for (int sample = 0; sample < numSamples; sample++) {
+		analytics.submit(crowd, sample, sample * shift / speed);
+
+		for (size_t idx = 0; sample + 1 < numSamples && idx < crowd.size(); idx++)
+			crowd.positionX[idx] += shift;
+	}
+
+	analytics.close();
+
+	// Most Agents are Farther Than the Kernel's 2.1 m From an Edge of the Lattice
+	for (size_t bin = 0; bin < analytics.getDiagram().size(); bin++) {
+		if (analytics.getDiagram()[bin].count > peakCount) {
+			peakCount = analytics.getDiagram()[bin].count;
+			peakBin = bin;
+		}
+	}
+
+	kernelDensity = (peakBin + 0.5) * analytics.getBinWidth();
+
+	// Cells 4 m From Every Edge
+	for (int row = 6; row < 14; row++) {
+		for (int col = 6; col < 14; col++)
+			cellDensity += analytics.getCellDensity(col, row) / 64.0;
+	}
+
+	crossings[0] = analytics.getLines()[0].positiveCrossings;
+	crossings[1] = analytics.getLines()[0].negativeCrossings;
+	cellError = fabs(cellDensity - latticeDensity) / latticeDensity;
+	passed = crossings[0] == static_cast<unsigned long long>(side) && crossings[1] == 0 &&
+			 fabs(kernelDensity - expectedKernelDensity) <= 0.5 * analytics.getBinWidth() && cellError <= densityBound &&
+			 analytics.getNumSamples() == static_cast<unsigned long long>(numSamples);
+
+	fprintf(output, "{\"validate\":\"analytics\",\"agents\":%d,\"samples\":%llu,\"crossings\":[%llu,%llu],\"expected_crossings\":%d,"
+			"\"peak_kernel_density\":%.3f,\"expected_kernel_density\":%.3f,\"cell_density\":%.3f,\"lattice_density\":%.3f,\"pass\":%s}\n",
+			side * side, analytics.getNumSamples(), crossings[0], crossings[1], side, kernelDensity, expectedKernelDensity, cellDensity, latticeDensity,
+			passed ? "true" : "false");
+
+	return passed;
+}
+
+// Sparse Plaza Crossed in Every Direction, Stepped Uniformly and With Multirate Stepping in Lockstep
+// Agents in free flow must be evaluated far less often  Agents that meet part ways on either side eventually, as in
+// 'validateTrajectories()', so positions are bounded over a short horizon and the whole run through mean speed and progress
+bool validateMultirate(FILE *output) {
+	const int numAgents = 400, numSteps = 1000, shortSteps = 100, maxLevel = 3;
+	const float side = 60.0F, stepTime = 0.01F;
+	const double positionBound = 0.15;		// Metres, largest deviation of any agent within 'shortSteps'
+	const double meanBound = 0.02;			// Relative, of mean speed and mean distance walked over the run
+	const double evaluationBound = 0.5;		// Share of agent-steps whose forces were evaluated
+	SocialForce *runs[2];
+	vector<float> startX[2], startY[2];
+	unsigned long long evaluated = 0;
+	double speedSum[2] = { 0.0, 0.0 }, progress[2] = { 0.0, 0.0 }, shortDeviation = 0.0, speedError, progressError, share;
+	bool passed;
+
+	for (int run = 0; run < 2; run++) {
+		runs[run] = new SocialForce(1);
+		runs[run]->setSeed(1604010629);
+		runs[run]->setAgentOrder(SpaceCurve::None);		// Compared index by index
+		runs[run]->setMultirate((run == 0) ? 0 : maxLevel);
+
+		// Waypoints Beyond Reach Within the Run, So No Agent Circles Its Goal
+		for (int idx = 0; idx < numAgents; idx++) {
+			Agent *agent = new Agent;
+			float x = runs[run]->drawUniform(-side / 2, side / 2), y = runs[run]->drawUniform(-side / 2, side / 2);
+			float heading = runs[run]->drawUniform(-PI, PI);
+
+			agent->setPosition(x, y);
+			agent->setPath(x + 100.0F * cos(heading), y + 100.0F * sin(heading), 1.0F);
+			runs[run]->addAgent(agent);
+		}
+
+		startX[run] = runs[run]->getState().positionX;
+		startY[run] = runs[run]->getState().positionY;
+	}
+
+	for (int step = 1; step <= numSteps; step++) {
+		for (int run = 0; run < 2; run++) {
+			const CrowdState &state = runs[run]->getState();
+
+			runs[run]->moveCrowd(stepTime);
+
+			for (size_t idx = 0; idx < state.size(); idx++)
+				speedSum[run] += sqrt(state.velocityX[idx] * state.velocityX[idx] + state.velocityY[idx] * state.velocityY[idx]);
+		}
+
+		evaluated += runs[1]->getStepStats().agentsEvaluated;
+
+		const CrowdState &uniform = runs[0]->getState(), &multirate = runs[1]->getState();
+
+		for (size_t idx = 0; step <= shortSteps && idx < uniform.size(); idx++) {
+			double deviationX = multirate.positionX[idx] - uniform.positionX[idx], deviationY = multirate.positionY[idx] - uniform.positionY[idx];
+			shortDeviation = max(shortDeviation, sqrt(deviationX * deviationX + deviationY * deviationY));
+		}
+	}
+
+	// Net Distance Walked
+	for (int run = 0; run < 2; run++) {
+		const CrowdState &state = runs[run]->getState();
+
+		for (size_t idx = 0; idx < state.size(); idx++) {
+			double walkedX = state.positionX[idx] - startX[run][idx], walkedY = state.positionY[idx] - startY[run][idx];
+			progress[run] += sqrt(walkedX * walkedX + walkedY * walkedY);
+		}
+	}
+
+	speedError = fabs(speedSum[1] - speedSum[0]) / speedSum[0];
+	progressError = fabs(progress[1] - progress[0]) / progress[0];
+	share = static_cast<double>(evaluated) / (static_cast<double>(numSteps) * numAgents);
+	passed = share <= evaluationBound && shortDeviation <= positionBound && speedError <= meanBound && progressError <= meanBound;
+
+	fprintf(output, "{\"validate\":\"multirate\",\"levels\":%d,\"agents\":%d,\"steps\":%d,\"evaluated_share\":%.3f,\"evaluation_bound\":%g,"
+			"\"max_deviation_m\":%.3g,\"deviation_steps\":%d,\"deviation_bound_m\":%g,\"mean_speed_error\":%.3g,\"mean_progress_error\":%.3g,"
+			"\"mean_bound\":%g,\"pass\":%s}\n", maxLevel, numAgents, numSteps, share, evaluationBound, shortDeviation, shortSteps, positionBound,
+			speedError, progressError, meanBound, passed ? "true" : "false");
+
+	delete runs[0];
+	delete runs[1];
+
+	return passed;
+}
+
+// Standing Audience Passed and Crossed by Walkers, Stepped Without and With Sleeping in Lockstep
+// Most of the audience must sleep most of the time, no walker may touch a sleeping agent, so sleepers are woken before contact,
+// and no agent may end up far from where it ends up when every agent is evaluated every step
+bool validateSleep(FILE *output) {
+	const int numCols = 20, numRows = 20, numWalkers = 40, numSteps = 1500;
+	const float spacing = 0.8F, stepTime = 0.02F, delay = 0.5F;
+	const double positionBound = 0.05;		// Metres, largest deviation of any agent at any step
+	const double asleepBound = 0.5;			// Least share of agent-steps asleep
+	SocialForce *runs[2];
+	unsigned long long asleep = 0, numSleeps = 0, numWakes = 0, contacts = 0;
+	double maxDeviation = 0.0, share;
+	bool passed;
+
+	for (int run = 0; run < 2; run++) {
+		runs[run] = new SocialForce(1);
+		runs[run]->setSeed(1604010629);
+		runs[run]->setAgentOrder(SpaceCurve::None);		// Compared index by index
+		runs[run]->setSleep((run == 0) ? 0.0F : delay);
+
+		// Audience Holds Its Place
+		for (int idx = 0; idx < numCols * numRows; idx++) {
+			Agent *agent = new Agent;
+			float x = (idx % numCols) * spacing, y = (idx / numCols) * spacing;
+
+			agent->setPosition(x, y);
+			agent->setDesiredSpeed(0.0F);
+			agent->setPath(x, y, 0.5F);
+			runs[run]->addAgent(agent);
+		}
+
+		// Walkers Along the Front of the Audience and Through an Aisle in the Middle, Setting Off One by One
+		for (int idx = 0; idx < numWalkers; idx++) {
+			Agent *agent = new Agent;
+			float x = -5.0F - 2.0F * (idx / 2), y = (idx % 2 == 0) ? -1.5F : (numRows / 2 - 0.5F) * spacing;
+
+			agent->setPosition(x, y);
+			agent->setPath(100.0F, y, 1.0F);
+			runs[run]->addAgent(agent);
+		}
+	}
+
+	for (int step = 1; step <= numSteps; step++) {
+		runs[0]->moveCrowd(stepTime);
+		runs[1]->moveCrowd(stepTime);
+
+		const StepStats &stats = runs[1]->getStepStats();
+		asleep += stats.agentsAsleep;
+		numSleeps += stats.agentsFellAsleep;
+		numWakes += stats.agentsWoken;
+
+		const CrowdState &uniform = runs[0]->getState(), &sleeping = runs[1]->getState();
+
+		for (size_t idx = 0; idx < uniform.size(); idx++) {
+			double deviationX = sleeping.positionX[idx] - uniform.positionX[idx], deviationY = sleeping.positionY[idx] - uniform.positionY[idx];
+			maxDeviation = max(maxDeviation, sqrt(deviationX * deviationX + deviationY * deviationY));
+
+			if (sleeping.idleSteps[idx] != ASLEEP)
+				continue;
+
+			// Touched by Any Agent While Asleep
+			for (size_t other = 0; other < sleeping.size(); other++) {
+				float distanceX = sleeping.positionX[other] - sleeping.positionX[idx], distanceY = sleeping.positionY[other] - sleeping.positionY[idx];
+				float radii = sleeping.radius[other] + sleeping.radius[idx];
+
+				if (other != idx && sleeping.idleSteps[other] != ASLEEP && distanceX * distanceX + distanceY * distanceY < radii * radii)
+					contacts++;
+			}
+		}
+	}
+
+	share = static_cast<double>(asleep) / (static_cast<double>(numSteps) * runs[1]->getCrowdSize());
+	passed = share >= asleepBound && contacts == 0 && maxDeviation <= positionBound;
+
+	fprintf(output, "{\"validate\":\"sleep\",\"delay_s\":%g,\"agents\":%d,\"steps\":%d,\"asleep_share\":%.3f,\"asleep_bound\":%g,\"sleeps\":%llu,"
+			"\"wakes\":%llu,\"contacts_asleep\":%llu,\"max_deviation_m\":%.3g,\"deviation_bound_m\":%g,\"pass\":%s}\n", delay,
+			runs[1]->getCrowdSize(), numSteps, share, asleepBound, numSleeps, numWakes, contacts, maxDeviation, positionBound,
+			passed ? "true" : "false");
+
+	delete runs[0];
+	delete runs[1];
+
+	return passed;
+}
+
+// Two-Way Stream With Sources, Sinks and Hilbert Sorting Every 10 Steps on Four Threads, Warmed Up Until Its Storage Stops Growing
+// No step after that may allocate  Counted through 'AllocationCounter.cpp', so only built with SFM_PROFILING
+#ifdef SFM_PROFILING
+bool validateAllocations(FILE *output) {
+	const int numAgents = 400, numWarmupSteps = 1500, numSteps = 1000;
+	const float stepTime = 0.02F;
+	SocialForce socialForce(4);
+	unsigned long long allocations = 0, maxStepAllocations = 0, before, stepAllocations;
+	unsigned int numSpawned = 0, numRetired = 0, numReorders = 0;
+	bool passed;
+
+	socialForce.setSeed(1604010629);
+	socialForce.setAgentOrder(SpaceCurve::Hilbert, 10);
+	createScene(&socialForce, "stream", numAgents, 0);
+
+	for (int step = 0; step < numWarmupSteps; step++)
+		socialForce.moveCrowd(stepTime);
+
+	for (int step = 0; step < numSteps; step++) {
+		before = Profiler::getAllocations();
+		socialForce.moveCrowd(stepTime);
+		stepAllocations = Profiler::getAllocations() - before;
+
+		allocations += stepAllocations;
+		maxStepAllocations = max(maxStepAllocations, stepAllocations);
+
+		const StepStats &stats = socialForce.getStepStats();
+		numSpawned += stats.agentsSpawned;
+		numRetired += stats.agentsRetired;
+		numReorders += stats.agentsReordered;
+	}
+
+	passed = allocations == 0 && numSpawned > 0 && numRetired > 0 && numReorders > 0;
+
+	fprintf(output, "{\"validate\":\"allocations\",\"scene\":\"stream\",\"agents\":%d,\"threads\":4,\"warmup_steps\":%d,"
+			"\"steps\":%d,\"spawned\":%u,\"retired\":%u,\"reorders\":%u,\"allocations\":%llu,\"max_step_allocations\":%llu,\"pass\":%s}\n",
+			numAgents, numWarmupSteps, numSteps, numSpawned, numRetired, numReorders, allocations, maxStepAllocations,
+			passed ? "true" : "false");
+
+	return passed;
+}
+#endif
+
+// Mean Distance in Storage Between Agents Within 2 m of Each Other  Small when neighbours in space are neighbours in memory
+double neighbourIndexGap(const CrowdState &state, SpatialGrid &grid, vector<int> &candidates) {
+	double gapSum = 0.0;
+	unsigned long long numPairs = 0;
+
+	grid.build(state, 2.0F);
+
+	for (size_t idx = 0; idx < state.size(); idx++) {
+		candidates.clear();
+		grid.query(state.positionX[idx], state.positionY[idx], candidates);
+
+		for (int other : candidates) {
+			float distanceX = state.positionX[other] - state.positionX[idx], distanceY = state.positionY[other] - state.positionY[idx];
+
+			if (static_cast<size_t>(other) != idx && distanceX * distanceX + distanceY * distanceY < 4.0F) {
+				gapSum += fabs(static_cast<double>(other) - static_cast<double>(idx));
+				numPairs++;
+			}
+		}
+	}
+
+	return (numPairs > 0) ? gapSum / numPairs : 0.0;
+}
+
+// Hardware Cache Misses of This Thread and the Threads It Starts From Now On, Counted in User Space  -1 if unavailable
+int openCacheMissCounter() {
+#if defined(__linux__)
+	perf_event_attr attributes;
+
+	memset(&attributes, 0, sizeof(attributes));
+	attributes.type = PERF_TYPE_HARDWARE;
+	attributes.size = sizeof(attributes);
+	attributes.config = PERF_COUNT_HW_CACHE_MISSES;
+	attributes.inherit = 1;
+	attributes.exclude_kernel = 1;
+	attributes.exclude_hv = 1;
+
+	return static_cast<int>(syscall(SYS_perf_event_open, &attributes, 0, -1, -1, 0));
+#else
+	return -1;
+#endif
+}
+
+// Count So Far, Including Threads That Have Exited  -1 if 'counter' is unavailable
+long long readCounter(int counter) {
+#if defined(__linux__)
+	long long count;
+
+	if (counter >= 0 && read(counter, &count, sizeof(count)) == sizeof(count))
+		return count;
+#else
+	(void)counter;
+#endif
+
+	return -1;
+}
+
+double residentMegabytes() {
+#if defined(__linux__)
+	FILE *status = fopen("/proc/self/status", "r");
+	char line[256];
+	double kilobytes = 0.0;
+
+	if (!status)
+		return 0.0;
+
+	while (fgets(line, sizeof(line), status)) {
+		if (strncmp(line, "VmRSS:", 6) == 0) {
+			kilobytes = atof(line + 6);
+			break;
+		}
+	}
+
+	fclose(status);
+	return kilobytes / 1024.0;
+#else
+	return 0.0;		// Not measured on this platform
+#endif
+}
+
+vector<int> parseSizes(const char *list) {
+	vector<int> sizes;
+	const char *cursor = list;
+	char *end;
+
+	while (*cursor) {
+		long size = strtol(cursor, &end, 10);
+
+		if (end == cursor)
+			break;
+
+		if (size > 0)
+			sizes.push_back(static_cast<int>(size));
+
+		cursor = (*end == ',') ? end + 1 : end;
+	}
+
+	return sizes;
+}
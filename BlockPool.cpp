@@ -0,0 +1,52 @@
+#include <algorithm>
+#include <new>
+#include "BlockPool.h"
+using namespace std;
+
+BlockPool::BlockPool(size_t blockSize, size_t blocksPerChunk) {
+	const size_t alignment = alignof(max_align_t);
+
+	// Every Block Holds a Free List Link and Keeps the Alignment of 'operator new'
+	this->blockSize = (max(blockSize, sizeof(void *)) + alignment - 1) / alignment * alignment;
+	this->blocksPerChunk = max(blocksPerChunk, static_cast<size_t>(1));
+	freeList = 0;
+}
+
+BlockPool::~BlockPool() {
+	for (char *chunk : chunks)
+		::operator delete(chunk);
+}
+
+void *BlockPool::allocate() {
+	lock_guard<std::mutex> lock(mutex);
+	void *block;
+
+	// Carve a New Chunk Into Free Blocks
+	if (!freeList) {
+		char *chunk = static_cast<char *>(::operator new(blockSize * blocksPerChunk));
+
+		chunks.push_back(chunk);
+
+		for (size_t idx = blocksPerChunk; idx > 0; idx--) {
+			void *carved = chunk + (idx - 1) * blockSize;
+
+			*static_cast<void **>(carved) = freeList;
+			freeList = carved;
+		}
+	}
+
+	block = freeList;
+	freeList = *static_cast<void **>(block);
+
+	return block;
+}
+
+void BlockPool::deallocate(void *block) {
+	lock_guard<std::mutex> lock(mutex);
+
+	if (!block)
+		return;
+
+	*static_cast<void **>(block) = freeList;
+	freeList = block;
+}
@@ -0,0 +1,33 @@
+#ifndef BLOCK_POOL_H
+#define BLOCK_POOL_H
+
+#include <cstddef>
+#include <mutex>
+#include <vector>
+
+// Fixed-Size Blocks Carved from Large Chunks and Recycled Through a Free List
+// Backs 'operator new' of 'Agent' and 'Wall', so spawning and removing them never fragments the heap
+// Chunks are kept for the life of the pool, memory stays at the peak number of live blocks
+class BlockPool {
+private:
+	size_t blockSize;
+	size_t blocksPerChunk;
+	std::vector<char *> chunks;
+	void *freeList;					// Each free block stores the next free block in its first bytes
+	std::mutex mutex;				// Agents may be created on any thread
+
+public:
+	BlockPool(size_t blockSize, size_t blocksPerChunk = 1024);
+	~BlockPool();
+
+	BlockPool(const BlockPool &) = delete;
+	BlockPool &operator=(const BlockPool &) = delete;
+
+	void *allocate();
+	void deallocate(void *block);
+
+	size_t getNumChunks() const { return chunks.size(); }
+	size_t getCapacity() const { return chunks.size() * blocksPerChunk; }
+};
+
+#endif
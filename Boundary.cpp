@@ -0,0 +1,38 @@
+#include <algorithm>
+#include <cmath>
+#include "Boundary.h"
+using namespace std;
+
+Source::Source(float minX, float minY, float maxX, float maxY, float rate, ArrivalProcess arrivals) {
+	this->minX = min(minX, maxX);
+	this->minY = min(minY, maxY);
+	this->maxX = max(minX, maxX);
+	this->maxY = max(minY, maxY);
+	this->rate = max(rate, 0.0F);
+	this->arrivals = arrivals;
+	maxAgents = -1;
+
+	radius = 0.2F;
+	speedMean = 1.29F;
+	speedDeviation = 0.19F;
+	colour.set(0.0, 0.0, 0.0);
+	target = -1;
+
+	nextArrival = NAN;
+	numSpawned = 0;
+}
+
+void Source::setPath(float x, float y, float radius) {
+	Waypoint waypoint = { Point3f(x, y, 0.0), radius };
+
+	path.push_back(waypoint);
+}
+
+Sink::Sink(float minX, float minY, float maxX, float maxY) {
+	this->minX = min(minX, maxX);
+	this->minY = min(minY, maxY);
+	this->maxX = max(minX, maxX);
+	this->maxY = max(minY, maxY);
+
+	numRetired = 0;
+}
@@ -0,0 +1,47 @@
+#ifndef BOUNDARY_H
+#define BOUNDARY_H
+
+#include <vecmath.h>
+#include <vector>
+#include "CrowdState.h"
+
+enum class ArrivalProcess {
+	Regular,	// Evenly spaced arrivals
+	Poisson		// Exponentially distributed gaps of the same mean
+};
+
+// Rectangle Where Agents Enter the Scene at a Given Rate  Arrivals wait while the rectangle is too crowded to place them
+struct Source {
+	float minX, minY, maxX, maxY;
+	float rate;							// Agents per second
+	ArrivalProcess arrivals;
+	long long maxAgents;				// Total to spawn, negative for no limit
+
+	// Properties of Spawned Agents
+	float radius;
+	float speedMean, speedDeviation;	// Desired speed drawn from a normal distribution, (Moussaid et al., 2009) by default
+	Color3f colour;
+	int target;							// Shared target of 'SocialForce::addTarget()', -1 follows 'path'
+	std::vector<Waypoint> path;
+
+	// Progress
+	double nextArrival;					// Simulated time of the next arrival, NaN until the first step
+	unsigned long long numSpawned;
+
+	Source(float minX, float minY, float maxX, float maxY, float rate, ArrivalProcess arrivals = ArrivalProcess::Poisson);
+
+	void setPath(float x, float y, float radius);	// Appends a waypoint, as 'Agent::setPath()'
+	bool isExhausted() const { return maxAgents >= 0 && numSpawned >= static_cast<unsigned long long>(maxAgents); }
+};
+
+// Rectangle Where Agents Leave the Scene  Any agent whose centre enters it is removed
+struct Sink {
+	float minX, minY, maxX, maxY;
+	unsigned long long numRetired;
+
+	Sink(float minX, float minY, float maxX, float maxY);
+
+	bool contains(float x, float y) const { return x >= minX && x <= maxX && y >= minY && y <= maxY; }
+};
+
+#endif
@@ -1,36 +1,55 @@
+#include <atomic>
+#include <chrono>
 #include <cstdlib>
+#include <cstdio>
+#include <thread>
 #include <vector>
 #include <cmath>
 #include <cstring>
-#include <gl/glut.h>
+#include <GL/glut.h>
+#include "CrowdSnapshot.h"
 #include "SocialForce.h"
+#include "Renderer.h"
+#include "Scene.h"
+#include "TrajectoryReader.h"
+#include "TripleBuffer.h"
 using namespace std;
 
 // Global Constant Variables
-const float PI = 3.14159265359F;
+const float SIM_STEP_TIME = 0.02F;	// Simulated seconds per step, stepped in real time when the solver keeps up
 
 // Global Variables
 GLsizei winWidth = 992;		// Window width (16:9 ratio)
 GLsizei winHeight = 558;	// Window height (16:9 ratio)
 SocialForce *socialForce;
-float fps = 0;				// Frames per second
-bool animate = false;		// Animate scene flag
+Renderer *renderer;
+vector<AgentInstance> agentInstances;	// Filled from the crowd or replay each frame
+size_t numWallsUploaded = 0;			// Walls in the renderer's wall buffer
+float fps = 0;				// Rendered frames per second
+float sps = 0;				// Simulation steps per second
+atomic<bool> animate(false);	// Animate scene flag
+atomic<bool> stopSimulation(false);
+atomic<int> stepCount(0);	// Steps taken by the simulation thread
+thread simThread;			// Owns 'socialForce' while running
+TripleBuffer<CrowdSnapshot> snapshots;	// Hands the latest crowd from the simulation thread to 'display()'
+TrajectoryReader *replay = 0;	// Recorded run shown instead of a live simulation
+TrajectoryFrame replayFrame;	// Frame of 'replay' currently shown
+float replayTime = 0;		// Playback position in simulated seconds
 
 // Function Prototypes
 void init();
-void createWalls();
-void createAgents();
 void display();
 void drawAgents();
-void drawCylinder(float x, float y, float radius = 0.2, int slices = 15, float height = 0.5);
 void drawWalls();
 void showInformation();
 void drawText(float x, float y, const char text[]);
 void reshape(int width, int height);
 void normalKey(unsigned char key, int xMousePos, int yMousePos);
-float randomFloat(float lowerBound, float upperBound);
 void update();
 void computeFPS();
+void showReplayFrame();
+void simulate();
+void quit();
 
 int main(int argc, char **argv) {
 	glutInit(&argc, argv);										// Initialize GLUT
@@ -39,6 +58,18 @@ int main(int argc, char **argv) {
 	glutInitWindowPosition(90, 90);								// Set window position
 	glutCreateWindow("Crowd Simulation using Social Force");	// Set window title and create display window
 
+	// Replay a Trajectory Recorded by 'sfm_runner --trajectory'
+	if (argc == 3 && strcmp(argv[1], "--replay") == 0) {
+		replay = new TrajectoryReader;
+
+		if (!replay->open(argv[2]) || replay->getNumFrames() == 0) {
+			fprintf(stderr, "Cannot replay '%s'\n", argv[2]);
+			return 1;
+		}
+
+		showReplayFrame();
+	}
+
 	init();							// Initialization
 	glutDisplayFunc(display);		// Send graphics to display window
 	glutReshapeFunc(reshape);		// Maintain aspect ratio when window first created, resized and moved
@@ -84,45 +115,21 @@ void init() {
 	glEnable(GL_BLEND);
 	glEnable(GL_LINE_SMOOTH);
 
-	srand(1604010629);				// Seed to generate random numbers
+	renderer = new Renderer;
+	renderer->init();
 
 	socialForce = new SocialForce;
-	createWalls();
-	createAgents();
-}
+	socialForce->setSeed(1604010629);	// Seed to generate random numbers
 
-void createWalls() {
-	Wall *wall;
+	if (!replay) {
+		createWalls(socialForce);
+		createAgents(socialForce);
 
-	// Upper Wall
-	wall = new Wall(-25.0, 6.0, 25.0, 6.0);		// Step 1: Create wall and define its coordinates (param: x1, y1, x2, y2)
-	socialForce->addWall(wall);					// Step 2: Add wall to SFM
-
-	// Lower Wall
-	wall = new Wall(-25.0, -6.0, 25.0, -6.0);
-	socialForce->addWall(wall);
-}
+		// First Snapshot Published Before the Simulation Thread Takes Over 'socialForce'
+		snapshots.getBack().capture(socialForce->getState(), 0, 0.0F);
+		snapshots.publish();
 
-void createAgents() {
-	Agent *agent;
-	bool opposite = false;
-
-	for (int idx = 0; idx < 400; idx++) {
-		agent = new Agent;															// Step 1: Create agent
-
-		if (!opposite) {
-			agent->setPosition(randomFloat(-20.3F, -5.0), randomFloat(-5.0, 5.0));	// Step 2: Set initial position (param: x, y)
-			agent->setPath(randomFloat(25.0, 30.0), randomFloat(-5.0, 5.0), 5.0);	// Step 3: Set target position(s) (param: x, y, waypt_radius)  Can set multiple targets by repeating step 3
-			opposite = true;
-		}
-
-		else {
-			agent->setPosition(randomFloat(5.0, 20.3F), randomFloat(-5.0, 5.0));
-			agent->setPath(randomFloat(-30.0, -25.0), randomFloat(-5.0, 5.0), 5.0);
-			opposite = false;
-		}
-
-		socialForce->addAgent(agent);												// Step 4: Add agent to SFM
+		simThread = thread(simulate);
 	}
 }
 
@@ -135,6 +142,9 @@ void display() {
 			  0.0, 0.0, 0.0,	// Look-at point
 			  0.0, 1.0, 0.0);	// Up-vector
 
+	if (!replay)
+		snapshots.update();		// Take the latest crowd published by the simulation thread, if any
+
 	glPushMatrix();
 		glScalef(1.0, 1.0, 1.0);
 
@@ -148,74 +158,68 @@ void display() {
 }
 
 void drawAgents() {
-	vector<Agent *> agents = socialForce->getCrowd();
+	const CrowdSnapshot &crowd = snapshots.getFront();		// Never written by the simulation thread while it is the front
 
-	for (Agent *agent : agents) {
-		// Draw Agents
-		glColor3f(agent->getColour().x, agent->getColour().y, agent->getColour().z);
-		drawCylinder(agent->getPosition().x, agent->getPosition().y, agent->getRadius(), 15, 0.0);
-	}
-}
+	// Gather Agents Into Instances, Drawn by a Single Call
+	agentInstances.clear();
 
-void drawCylinder(float x, float y, float radius, int slices, float height) {
-	float sliceAngle;
-	Point3f current, next;
+	if (replay) {
+		for (size_t idx = 0; idx < replayFrame.size(); idx++) {
+			uint32_t colour = replayFrame.colour[idx];
+			AgentInstance instance = { replayFrame.positionX[idx], replayFrame.positionY[idx], replayFrame.radius[idx],
+									   ((colour >> 16) & 0xFF) / 255.0F, ((colour >> 8) & 0xFF) / 255.0F, (colour & 0xFF) / 255.0F };
 
-	glPushMatrix();
-		glTranslatef(x, y, 0.0);
+			agentInstances.push_back(instance);
+		}
+	}
+
+	else {
+		for (size_t idx = 0; idx < crowd.size(); idx++) {
+			AgentInstance instance = { crowd.positionX[idx], crowd.positionY[idx], crowd.radius[idx],
+									   crowd.colour[idx].x, crowd.colour[idx].y, crowd.colour[idx].z };
 
-		sliceAngle = static_cast<float>(360.0 / slices);
-		current.x = radius;		// Set initial point
-		current.y = 0;			// Set initial point
-
-		for (float angle = sliceAngle; angle <= 360; angle += sliceAngle) {
-			next.x = radius * cos(angle * PI / 180);		// Compute next point
-			next.y = radius * sin(angle * PI / 180);		// Compute next point
-
-			// Top Cover
-			glBegin(GL_TRIANGLES);
-				glVertex3f(0.0, 0.0, height);				// Centre of triangle
-				glVertex3f(current.x, current.y, height);	// Left of triangle
-				glVertex3f(next.x, next.y, height);			// Right of triangle
-			glEnd();
-
-			// Body
-			glBegin(GL_QUADS);
-				glVertex3f(current.x, current.y, height);	// Top-left of quadrilateral
-				glVertex3f(current.x, current.y, 0.0);		// Bottom-left of quadrilateral
-				glVertex3f(next.x, next.y, 0.0);			// Bottom-right of quadrilateral
-				glVertex3f(next.x, next.y, height);			// Top-right of quadrilateral
-			glEnd();
-
-			// Bottom Cover
-			glBegin(GL_TRIANGLES);
-				glVertex3f(0.0, 0.0, 0.0);					// Centre of triangle
-				glVertex3f(current.x, current.y, 0.0);		// Left of triangle
-				glVertex3f(next.x, next.y, 0.0);			// Right of triangle
-			glEnd();
-
-			current = next;									// New point becomes initial point
+			agentInstances.push_back(instance);
 		}
-	glPopMatrix();
+	}
+
+	renderer->drawAgents(agentInstances);
 }
 
 void drawWalls() {
-	vector<Wall *> walls = socialForce->getWalls();
+	const vector<Wall *> &walls = socialForce->getWalls();		// Only changed before the simulation thread starts
+	size_t numWalls = walls.size() + (replay ? replay->getWalls().size() : 0);
+
+	// Upload Walls Only When They Change
+	if (numWalls != numWallsUploaded) {
+		vector<float> segments;
 
-	glColor3f(0.2F, 0.2F, 0.2F);
-	glPushMatrix();
 		for (Wall *wall : walls) {
-			glBegin(GL_LINES);
-				glVertex2f(wall->getStartPoint().x, wall->getStartPoint().y);
-				glVertex2f(wall->getEndPoint().x, wall->getEndPoint().y);
-			glEnd();
+			segments.push_back(wall->getStartPoint().x);
+			segments.push_back(wall->getStartPoint().y);
+			segments.push_back(wall->getEndPoint().x);
+			segments.push_back(wall->getEndPoint().y);
 		}
-	glPopMatrix();
+
+		if (replay) {
+			for (const TrajectoryWall &wall : replay->getWalls()) {
+				segments.push_back(wall.startX);
+				segments.push_back(wall.startY);
+				segments.push_back(wall.endX);
+				segments.push_back(wall.endY);
+			}
+		}
+
+		renderer->setWalls(segments);
+		numWallsUploaded = numWalls;
+	}
+
+	glColor3f(0.2F, 0.2F, 0.2F);
+	renderer->drawWalls();
 }
 
 void showInformation() {
 	Point3f margin;
-	char totalAgentsStr[5] = "\0", fpsStr[8] = "\0", frctnStr[6] = "\0";
+	char totalAgentsStr[16] = "\0", fpsStr[8] = "\0", spsStr[8] = "\0";
 
 	margin.x = static_cast<float>(-winWidth) / 50;
 	margin.y = static_cast<float>(winHeight) / 50 - 0.75F;
@@ -224,17 +228,18 @@ void showInformation() {
 
 	// Total Agents
 	drawText(margin.x, margin.y, "Total agents:");
-	_itoa_s(socialForce->getCrowdSize(), totalAgentsStr, 10);
+	snprintf(totalAgentsStr, sizeof(totalAgentsStr), "%d", static_cast<int>(replay ? replayFrame.size() : snapshots.getFront().size()));
 	drawText(margin.x + 4.0F, margin.y, totalAgentsStr);
 
 	// FPS
 	drawText(margin.x, margin.y - 0.9F, "FPS:");
-	_itoa_s(static_cast<int>(fps), fpsStr, 10);								// Convert integer portion into char
-	strcat_s(fpsStr, ".");													// Append decimal mark
-	_itoa_s((fps - static_cast<int>(fps)) * 100000, frctnStr, 10);			// Convert fractional portion into char
-	strncat_s(fpsStr, frctnStr, sizeof(fpsStr) - (strlen(fpsStr) + 1));		// Append fractional portion
-	fpsStr[7] = '\0';
+	snprintf(fpsStr, sizeof(fpsStr), "%.5f", fps);		// Truncated to 7 characters
 	drawText(margin.x + 1.7F, margin.y - 0.9F, fpsStr);
+
+	// Simulation Steps per Second
+	drawText(margin.x, margin.y - 1.8F, "Steps/s:");
+	snprintf(spsStr, sizeof(spsStr), "%.5f", sps);		// Truncated to 7 characters
+	drawText(margin.x + 2.9F, margin.y - 1.8F, spsStr);
 }
 
 void drawText(float x, float y, const char text[]) {
@@ -274,19 +279,19 @@ void normalKey(unsigned char key, int xMousePos, int yMousePos) {
 		animate = (!animate) ? true : false;
 		break;
 
-	case 27:				// ASCII character for Esc key
-		delete socialForce;
-		socialForce = 0;
+	case 'r':				// Rewind replay
+		if (replay) {
+			replayTime = 0;
+			showReplayFrame();
+		}
+		break;
 
-		exit(0);			// Terminate program
+	case 27:				// ASCII character for Esc key
+		quit();
 		break;
 	}
 }
 
-float randomFloat(float lowerBound, float upperBound) {
-	return (lowerBound + (static_cast<float>(rand()) / RAND_MAX) * (upperBound - lowerBound));
-}
-
 void update() {
 	int currTime, frameTime;	// Store time in milliseconds
 	static int prevTime;		// Stores time in milliseconds
@@ -295,8 +300,10 @@ void update() {
 	frameTime = currTime - prevTime;
 	prevTime = currTime;
 
-	if (animate)
-		socialForce->moveCrowd(static_cast<float>(frameTime) / 1000);	// Perform calculations and move agents
+	if (animate && replay) {
+		replayTime += static_cast<float>(frameTime) / 1000;		// Play back at recorded speed
+		showReplayFrame();
+	}
 
 	computeFPS();
 	glutPostRedisplay();
@@ -305,6 +312,7 @@ void update() {
 
 void computeFPS() {
 	static int frameCount = 0;	// Stores number of frames
+	static int prevStepCount = 0;
 	int currTime, frameTime;	// Store time in milliseconds
 	static int prevTime;		// Stores time in milliseconds
 
@@ -315,7 +323,62 @@ void computeFPS() {
 
 	if (frameTime > 1000) {
 		fps = frameCount / (static_cast<float>(frameTime) / 1000);	// Compute the number of FPS
+		sps = (stepCount - prevStepCount) / (static_cast<float>(frameTime) / 1000);
+		prevStepCount = stepCount;
 		prevTime = currTime;
 		frameCount = 0;												// Reset number of frames
 	}
 }
+
+void showReplayFrame() {
+	size_t frameIdx = replay->findFrame(replay->getFrameTime(0) + replayTime);
+
+	if (replayFrame.size() == 0 || replay->getFrameStep(frameIdx) != replayFrame.step)
+		replay->readFrame(frameIdx, replayFrame);
+}
+
+// Simulation Thread  Steps independently of rendering and publishes a snapshot after every step
+void simulate() {
+	chrono::steady_clock::time_point nextStep = chrono::steady_clock::now();
+	const chrono::steady_clock::duration stepDuration = chrono::duration_cast<chrono::steady_clock::duration>(chrono::duration<float>(SIM_STEP_TIME));
+	int step = 0;
+
+	while (!stopSimulation) {
+		if (!animate) {
+			this_thread::sleep_for(chrono::milliseconds(10));
+			nextStep = chrono::steady_clock::now();
+			continue;
+		}
+
+		socialForce->moveCrowd(SIM_STEP_TIME);		// Perform calculations and move agents
+		step++;
+
+		snapshots.getBack().capture(socialForce->getState(), step, step * SIM_STEP_TIME);
+		snapshots.publish();
+		stepCount++;
+
+		// Hold Real Time if Ahead, Never Try to Catch Up if Behind
+		nextStep += stepDuration;
+
+		if (nextStep > chrono::steady_clock::now())
+			this_thread::sleep_until(nextStep);
+		else
+			nextStep = chrono::steady_clock::now();
+	}
+}
+
+void quit() {
+	stopSimulation = true;
+
+	if (simThread.joinable())
+		simThread.join();
+
+	delete socialForce;
+	socialForce = 0;
+	delete replay;
+	replay = 0;
+	delete renderer;
+	renderer = 0;
+
+	exit(0);			// Terminate program
+}
\ No newline at end of file
@@ -0,0 +1,104 @@
+#include <istream>
+#include <ostream>
+#include "CounterRandom.h"
+using namespace std;
+
+// Multipliers and Key Increments of Philox4x32
+const uint32_t PHILOX_M0 = 0xD2511F53U, PHILOX_M1 = 0xCD9E8D57U;
+const uint32_t PHILOX_W0 = 0x9E3779B9U, PHILOX_W1 = 0xBB67AE85U;
+const int PHILOX_ROUNDS = 10;
+
+void CounterRandom::seed(unsigned long long seed, unsigned long long stream) {
+	key[0] = static_cast<uint32_t>(seed);
+	key[1] = static_cast<uint32_t>(seed >> 32);
+	counter[0] = counter[1] = 0;
+	counter[2] = static_cast<uint32_t>(stream);
+	counter[3] = static_cast<uint32_t>(stream >> 32);
+	block[0] = block[1] = block[2] = block[3] = 0;	// Spent, but written to checkpoints
+	used = 4;		// First draw generates block 0
+}
+
+void CounterRandom::generate() {
+	uint32_t value[4] = { counter[0], counter[1], counter[2], counter[3] }, roundKey[2] = { key[0], key[1] };
+
+	for (int round = 0; round < PHILOX_ROUNDS; round++) {
+		uint64_t product0 = static_cast<uint64_t>(PHILOX_M0) * value[0], product1 = static_cast<uint64_t>(PHILOX_M1) * value[2];
+		uint32_t next[4];
+
+		next[0] = static_cast<uint32_t>(product1 >> 32) ^ value[1] ^ roundKey[0];
+		next[1] = static_cast<uint32_t>(product1);
+		next[2] = static_cast<uint32_t>(product0 >> 32) ^ value[3] ^ roundKey[1];
+		next[3] = static_cast<uint32_t>(product0);
+
+		for (int word = 0; word < 4; word++)
+			value[word] = next[word];
+
+		roundKey[0] += PHILOX_W0;
+		roundKey[1] += PHILOX_W1;
+	}
+
+	for (int word = 0; word < 4; word++)
+		block[word] = value[word];
+
+	// Next Block  Wraps within the stream after 2^64 blocks
+	if (++counter[0] == 0)
+		counter[1]++;
+
+	used = 0;
+}
+
+void CounterRandom::discard(unsigned long long count) {
+	unsigned long long blocks, index;
+
+	// Rest of the Current Block
+	while (count > 0 && used < 4) {
+		used++;
+		count--;
+	}
+
+	if (count == 0)
+		return;
+
+	// Whole Blocks Skipped Without Hashing Them
+	blocks = count / 4;
+	index = (counter[0] | static_cast<unsigned long long>(counter[1]) << 32) + blocks;
+	counter[0] = static_cast<uint32_t>(index);
+	counter[1] = static_cast<uint32_t>(index >> 32);
+
+	for (count %= 4; count > 0; count--)
+		(*this)();
+}
+
+ostream &operator<<(ostream &stream, const CounterRandom &engine) {
+	stream << engine.key[0] << ' ' << engine.key[1];
+
+	for (int word = 0; word < 4; word++)
+		stream << ' ' << engine.counter[word];
+
+	for (int word = 0; word < 4; word++)
+		stream << ' ' << engine.block[word];
+
+	return stream << ' ' << engine.used;
+}
+
+istream &operator>>(istream &stream, CounterRandom &engine) {
+	CounterRandom read;
+
+	stream >> read.key[0] >> read.key[1];
+
+	for (int word = 0; word < 4; word++)
+		stream >> read.counter[word];
+
+	for (int word = 0; word < 4; word++)
+		stream >> read.block[word];
+
+	stream >> read.used;
+
+	// Engine Unchanged Unless the Whole State Was Read
+	if (stream && read.used >= 0 && read.used <= 4)
+		engine = read;
+	else
+		stream.setstate(ios::failbit);
+
+	return stream;
+}
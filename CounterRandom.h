@@ -0,0 +1,43 @@
+#ifndef COUNTER_RANDOM_H
+#define COUNTER_RANDOM_H
+
+#include <cstdint>
+#include <iosfwd>
+
+// Counter-Based Random Engine, Philox4x32-10 (Salmon et al., 2011)  Each block of four outputs is a keyed hash of its position,
+// so a seed and a stream number fix a sequence no other stream overlaps  Engines of an ensemble share nothing and cost 48 bytes
+class CounterRandom {
+public:
+	typedef uint32_t result_type;
+
+private:
+	uint32_t key[2];			// Seed
+	uint32_t counter[4];		// Block index (low two words) and stream (high two words) of the next block
+	uint32_t block[4];
+	int used;					// Outputs of 'block' already returned
+
+	void generate();			// Hashes 'counter' into 'block' and advances it
+
+public:
+	explicit CounterRandom(unsigned long long seed = 0, unsigned long long stream = 0) { this->seed(seed, stream); }
+
+	void seed(unsigned long long seed, unsigned long long stream = 0);
+	void discard(unsigned long long count);
+	unsigned long long getStream() const { return counter[2] | static_cast<unsigned long long>(counter[3]) << 32; }
+
+	result_type operator()() {
+		if (used == 4)
+			generate();
+
+		return block[used++];
+	}
+
+	static constexpr result_type min() { return 0; }
+	static constexpr result_type max() { return 0xFFFFFFFFU; }
+
+	// Text Form, as for the Standard Engines
+	friend std::ostream &operator<<(std::ostream &stream, const CounterRandom &engine);
+	friend std::istream &operator>>(std::istream &stream, CounterRandom &engine);
+};
+
+#endif
@@ -0,0 +1,408 @@
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include "CrowdAnalytics.h"
+using namespace std;
+
+const float PI = 3.14159265359F;
+const size_t MAX_DIAGRAM_BINS = 400;	// Densities beyond fall into the last bin
+
+typedef chrono::steady_clock Clock;
+
+double DiagramBin::getSpeedDeviation() const {
+	if (count < 2)
+		return 0.0;
+
+	return sqrt(max((speedSquareSum - speedSum * speedSum / count) / (count - 1), 0.0));
+}
+
+// z Component of the Cross Product, Positive if (bx, by) Lies to the Left of (ax, ay)
+static float cross(float ax, float ay, float bx, float by) {
+	return ax * by - ay * bx;
+}
+
+CrowdAnalytics::CrowdAnalytics() {
+	minX = minY = 0.0F;
+	cellSize = 0.5F;
+	numCols = numRows = 0;
+	kernelRadius = 0.7F;
+	binWidth = 0.25F;
+	sampleInterval = 10;
+
+	file = 0;
+	running = false;
+	closing = false;
+	failed = false;
+
+	previousTime = NAN;
+	numSamples = 0;
+	processTime = 0.0;
+	stallTime = 0.0;
+	numSubmitted = 0;
+}
+
+CrowdAnalytics::~CrowdAnalytics() {
+	close();
+}
+
+void CrowdAnalytics::setGrid(float minX, float minY, float maxX, float maxY, float cellSize) {
+	if (running || cellSize <= 0.0F || maxX <= minX || maxY <= minY)
+		return;
+
+	this->minX = minX;
+	this->minY = minY;
+	this->cellSize = cellSize;
+	numCols = static_cast<int>(ceil((maxX - minX) / cellSize));
+	numRows = static_cast<int>(ceil((maxY - minY) / cellSize));
+}
+
+int CrowdAnalytics::addLine(float startX, float startY, float endX, float endY) {
+	MeasurementLine line = { startX, startY, endX, endY, 0, 0 };
+
+	if (running)
+		return -1;
+
+	lines.push_back(line);
+	return lines.size() - 1;
+}
+
+bool CrowdAnalytics::open(const char *path) {
+	size_t numCells = static_cast<size_t>(numCols) * numRows;
+
+	close();
+
+	if (path) {
+		file = fopen(path, "w");
+
+		if (!file)
+			return false;
+	}
+
+	// Results of the Previous Run are Dropped
+	for (MeasurementLine &line : lines)
+		line.positiveCrossings = line.negativeCrossings = 0;
+
+	cellCounts.assign(numCells, 0);
+	cellSpeeds.assign(numCells, 0.0);
+	sampleCounts.assign(numCells, 0);
+	sampleCrossings.assign(lines.size(), 0);
+	diagram.clear();
+	previousPositions.clear();
+	previousTime = NAN;
+	numSamples = 0;
+	processTime = 0.0;
+	stallTime = 0.0;
+	numSubmitted = 0;
+
+	queued.clear();
+	freed.clear();
+
+	for (int idx = 0; idx < NUM_SNAPSHOTS; idx++)
+		freed.push_back(idx);
+
+	closing = false;
+	failed = false;
+	running = true;
+	thread = std::thread(&CrowdAnalytics::workerLoop, this);
+
+	return true;
+}
+
+bool CrowdAnalytics::close() {
+	bool succeeded;
+
+	if (!running)
+		return true;
+
+	{
+		lock_guard<std::mutex> lock(mutex);
+		closing = true;
+	}
+
+	queuedCondition.notify_one();
+	thread.join();
+	running = false;
+	succeeded = !failed;
+
+	if (file) {
+		succeeded = !failed && fclose(file) == 0;
+		file = 0;
+	}
+
+	return succeeded;
+}
+
+void CrowdAnalytics::submit(const CrowdState &crowd, unsigned long long step, double time) {
+	int snapshotIdx;
+
+	if (!running || step % sampleInterval != 0)
+		return;
+
+	// Wait Only if Measuring Takes Longer Than the Steps Between Samples
+	{
+		unique_lock<std::mutex> lock(mutex);
+
+		if (freed.empty()) {
+			Clock::time_point start = Clock::now();
+
+			freedCondition.wait(lock, [this] { return !freed.empty(); });
+			stallTime += chrono::duration<double>(Clock::now() - start).count();
+		}
+
+		snapshotIdx = freed.front();
+		freed.pop_front();
+	}
+
+	// Copy Without Holding the Lock  Buffers keep their capacity, so steady runs do not allocate
+	Snapshot &snapshot = snapshots[snapshotIdx];
+
+	snapshot.step = step;
+	snapshot.time = time;
+	snapshot.id.assign(crowd.id.begin(), crowd.id.end());
+	snapshot.positionX.assign(crowd.positionX.begin(), crowd.positionX.end());
+	snapshot.positionY.assign(crowd.positionY.begin(), crowd.positionY.end());
+	snapshot.velocityX.assign(crowd.velocityX.begin(), crowd.velocityX.end());
+	snapshot.velocityY.assign(crowd.velocityY.begin(), crowd.velocityY.end());
+
+	{
+		lock_guard<std::mutex> lock(mutex);
+		queued.push_back(snapshotIdx);
+		numSubmitted++;
+	}
+
+	queuedCondition.notify_one();
+}
+
+void CrowdAnalytics::workerLoop() {
+	int snapshotIdx;
+
+	for (;;) {
+		{
+			unique_lock<std::mutex> lock(mutex);
+			queuedCondition.wait(lock, [this] { return closing || !queued.empty(); });
+
+			if (queued.empty())
+				return;		// Closing and nothing left to measure
+
+			snapshotIdx = queued.front();
+			queued.pop_front();
+		}
+
+		measure(snapshots[snapshotIdx]);
+
+		{
+			lock_guard<std::mutex> lock(mutex);
+			freed.push_back(snapshotIdx);
+		}
+
+		freedCondition.notify_one();
+	}
+}
+
+void CrowdAnalytics::measure(const Snapshot &snapshot) {
+	const float cutoff = 3.0F * kernelRadius;		// Kernel below 1.1% of its peak beyond
+	const float normalisation = 1.0F / (2.0F * PI * kernelRadius * kernelRadius);
+	const float exponentScale = -1.0F / (2.0F * kernelRadius * kernelRadius);
+	Clock::time_point start = Clock::now();
+	size_t numAgents = snapshot.id.size();
+	double speedSum = 0.0, densitySum = 0.0, maxDensity = 0.0;
+	unsigned int maxCellCount = 0;
+
+	countCrossings(snapshot);
+
+	// Add Agents to Their Cells
+	sampleCells.clear();
+
+	for (size_t idx = 0; idx < numAgents; idx++) {
+		float speed = sqrt(snapshot.velocityX[idx] * snapshot.velocityX[idx] + snapshot.velocityY[idx] * snapshot.velocityY[idx]);
+		int col = static_cast<int>(floor((snapshot.positionX[idx] - minX) / cellSize));
+		int row = static_cast<int>(floor((snapshot.positionY[idx] - minY) / cellSize));
+
+		speedSum += speed;
+
+		if (col < 0 || col >= numCols || row < 0 || row >= numRows)
+			continue;
+
+		int cell = row * numCols + col;
+
+		if (sampleCounts[cell]++ == 0)
+			sampleCells.push_back(cell);
+
+		cellCounts[cell]++;
+		cellSpeeds[cell] += speed;
+	}
+
+	// Densest Cell of This Sample, Then Clear Only the Cells It Touched
+	for (int cell : sampleCells) {
+		maxCellCount = max(maxCellCount, sampleCounts[cell]);
+		sampleCounts[cell] = 0;
+	}
+
+	// Local Density of Each Agent, Its Own Kernel Included
+	kernelCrowd.positionX.assign(snapshot.positionX.begin(), snapshot.positionX.end());
+	kernelCrowd.positionY.assign(snapshot.positionY.begin(), snapshot.positionY.end());
+	kernelGrid.build(kernelCrowd, cutoff);
+
+	for (size_t idx = 0; idx < numAgents; idx++) {
+		float x = snapshot.positionX[idx], y = snapshot.positionY[idx];
+		double speed = sqrt(snapshot.velocityX[idx] * snapshot.velocityX[idx] + snapshot.velocityY[idx] * snapshot.velocityY[idx]);
+		float density = 0.0F;
+		size_t bin;
+
+		candidates.clear();
+		kernelGrid.query(x, y, candidates);
+
+		for (int other : candidates) {
+			float distanceX = snapshot.positionX[other] - x, distanceY = snapshot.positionY[other] - y;
+			float squaredDistance = distanceX * distanceX + distanceY * distanceY;
+
+			if (squaredDistance < cutoff * cutoff)
+				density += exp(squaredDistance * exponentScale);
+		}
+
+		density *= normalisation;
+		densitySum += density;
+		maxDensity = max(maxDensity, static_cast<double>(density));
+
+		// Fundamental Diagram Grows to the Densest Bin Seen
+		bin = min(static_cast<size_t>(density / binWidth), MAX_DIAGRAM_BINS - 1);
+
+		if (bin >= diagram.size()) {
+			DiagramBin empty = { 0, 0.0, 0.0 };
+			diagram.resize(bin + 1, empty);
+		}
+
+		diagram[bin].count++;
+		diagram[bin].speedSum += speed;
+		diagram[bin].speedSquareSum += speed * speed;
+	}
+
+	numSamples++;
+
+	writeSample(snapshot, (numAgents > 0) ? speedSum / numAgents : 0.0, (numAgents > 0) ? densitySum / numAgents : 0.0, maxDensity,
+				maxCellCount);
+
+	processTime += chrono::duration<double>(Clock::now() - start).count();
+}
+
+// Agents Whose Path From Their Previous Sampled Position Crosses a Line  Agents new to this sample cross nothing
+void CrowdAnalytics::countCrossings(const Snapshot &snapshot) {
+	currentPositions.clear();
+
+	for (size_t idx = 0; idx < snapshot.id.size(); idx++) {
+		float toX = snapshot.positionX[idx], toY = snapshot.positionY[idx];
+		auto previous = previousPositions.find(snapshot.id[idx]);
+
+		currentPositions[snapshot.id[idx]] = make_pair(toX, toY);
+
+		if (previous == previousPositions.end())
+			continue;
+
+		float fromX = previous->second.first, fromY = previous->second.second;
+
+		for (size_t lineIdx = 0; lineIdx < lines.size(); lineIdx++) {
+			MeasurementLine &line = lines[lineIdx];
+			float lineX = line.endX - line.startX, lineY = line.endY - line.startY;
+			bool fromLeft = cross(lineX, lineY, fromX - line.startX, fromY - line.startY) > 0.0F;
+			bool toLeft = cross(lineX, lineY, toX - line.startX, toY - line.startY) > 0.0F;
+
+			// Ends of the Path on Opposite Sides of the Line, and Ends of the Line on Opposite Sides of the Path
+			if (fromLeft == toLeft)
+				continue;
+
+			if ((cross(toX - fromX, toY - fromY, line.startX - fromX, line.startY - fromY) > 0.0F) ==
+				(cross(toX - fromX, toY - fromY, line.endX - fromX, line.endY - fromY) > 0.0F))
+				continue;
+
+			if (fromLeft)
+				line.positiveCrossings++;
+			else
+				line.negativeCrossings++;
+
+			sampleCrossings[lineIdx]++;
+		}
+	}
+
+	previousPositions.swap(currentPositions);
+}
+
+void CrowdAnalytics::writeSample(const Snapshot &snapshot, double meanSpeed, double meanDensity, double maxDensity, unsigned int maxCellCount) {
+	double elapsedTime = snapshot.time - previousTime;		// NaN for the first sample
+
+	previousTime = snapshot.time;
+
+	if (!file) {
+		fill(sampleCrossings.begin(), sampleCrossings.end(), 0);
+		return;
+	}
+
+	failed = fprintf(file, "{\"step\":%llu,\"time\":%.3f,\"agents\":%d,\"mean_speed\":%.3f,\"mean_density\":%.3f,\"max_density\":%.3f,"
+					 "\"max_cell_density\":%.3f,\"lines\":[", snapshot.step, snapshot.time, static_cast<int>(snapshot.id.size()), meanSpeed,
+					 meanDensity, maxDensity, maxCellCount / (cellSize * cellSize)) < 0 || failed;
+
+	// Flow Through Each Line Since the Previous Sample, per Second and per Second and Metre of Line
+	for (size_t lineIdx = 0; lineIdx < lines.size(); lineIdx++) {
+		const MeasurementLine &line = lines[lineIdx];
+		double length = sqrt((line.endX - line.startX) * (line.endX - line.startX) + (line.endY - line.startY) * (line.endY - line.startY));
+		double flow = (elapsedTime > 0.0) ? sampleCrossings[lineIdx] / elapsedTime : 0.0;
+
+		failed = fprintf(file, "%s{\"positive\":%llu,\"negative\":%llu,\"flow\":%.3f,\"specific_flow\":%.3f}", (lineIdx > 0) ? "," : "",
+						 line.positiveCrossings, line.negativeCrossings, flow, (length > 0.0) ? flow / length : 0.0) < 0 || failed;
+		sampleCrossings[lineIdx] = 0;
+	}
+
+	failed = fprintf(file, "]}\n") < 0 || failed;
+}
+
+double CrowdAnalytics::getCellDensity(int col, int row) const {
+	if (col < 0 || col >= numCols || row < 0 || row >= numRows || numSamples == 0)
+		return 0.0;
+
+	return cellCounts[row * numCols + col] / (numSamples * static_cast<double>(cellSize) * cellSize);
+}
+
+double CrowdAnalytics::getCellSpeed(int col, int row) const {
+	if (col < 0 || col >= numCols || row < 0 || row >= numRows || cellCounts[row * numCols + col] == 0)
+		return 0.0;
+
+	return cellSpeeds[row * numCols + col] / cellCounts[row * numCols + col];
+}
+
+bool CrowdAnalytics::writeFields(const char *path) const {
+	FILE *fields = fopen(path, "w");
+	bool succeeded;
+
+	if (!fields)
+		return false;
+
+	succeeded = fprintf(fields, "x,y,density,speed\n") > 0;
+
+	for (int row = 0; succeeded && row < numRows; row++) {
+		for (int col = 0; succeeded && col < numCols; col++)
+			succeeded = fprintf(fields, "%.3f,%.3f,%.4f,%.4f\n", minX + (col + 0.5F) * cellSize, minY + (row + 0.5F) * cellSize,
+								getCellDensity(col, row), getCellSpeed(col, row)) > 0;
+	}
+
+	return fclose(fields) == 0 && succeeded;
+}
+
+// One Row per Occupied Bin  Flow is density times mean speed, agents per second and metre
+bool CrowdAnalytics::writeDiagram(const char *path) const {
+	FILE *output = fopen(path, "w");
+	bool succeeded;
+
+	if (!output)
+		return false;
+
+	succeeded = fprintf(output, "density,samples,speed,speed_deviation,flow\n") > 0;
+
+	for (size_t bin = 0; succeeded && bin < diagram.size(); bin++) {
+		double density = (bin + 0.5) * binWidth;
+
+		if (diagram[bin].count > 0)
+			succeeded = fprintf(output, "%.3f,%llu,%.4f,%.4f,%.4f\n", density, diagram[bin].count, diagram[bin].getMeanSpeed(),
+								diagram[bin].getSpeedDeviation(), density * diagram[bin].getMeanSpeed()) > 0;
+	}
+
+	return fclose(output) == 0 && succeeded;
+}
@@ -0,0 +1,129 @@
+#ifndef CROWD_ANALYTICS_H
+#define CROWD_ANALYTICS_H
+
+#include <condition_variable>
+#include <cstdio>
+#include <deque>
+#include <mutex>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+#include "CrowdState.h"
+#include "SpatialGrid.h"
+
+// Segment Agents are Counted Crossing  Positive crossings go from the left to the right of the line seen from its start, so a line
+// drawn from bottom to top counts movement along +x as positive
+struct MeasurementLine {
+	float startX, startY;
+	float endX, endY;
+	unsigned long long positiveCrossings, negativeCrossings;	// Since 'CrowdAnalytics::open()'
+};
+
+// Speed and Flow of the Agents Whose Local Density Fell Into One Bin of the Fundamental Diagram
+struct DiagramBin {
+	unsigned long long count;		// Agent samples
+	double speedSum, speedSquareSum;
+
+	double getMeanSpeed() const { return (count > 0) ? speedSum / count : 0.0; }
+	double getSpeedDeviation() const;
+};
+
+// Density, Speed and Flow of a Crowd, Measured While It Runs
+// 'submit()' copies the crowd into one of two snapshot buffers and returns, a background thread measures the other  Per sample it
+// adds agents to the cells of a density and speed grid, counts agents crossing measurement lines since the previous sample, estimates
+// each agent's local density with a Gaussian kernel over its neighbours (no Voronoi cells) and bins its speed by that density for the
+// fundamental diagram  Each sample appends one JSON line to the time series
+// Attach with 'SocialForce::setAnalytics()', configure before 'open()' and read results after 'close()'
+class CrowdAnalytics {
+private:
+	// Copy of the Crowd Taken by 'submit()'
+	struct Snapshot {
+		unsigned long long step;
+		double time;
+		std::vector<int> id;
+		std::vector<float> positionX, positionY;
+		std::vector<float> velocityX, velocityY;
+	};
+
+	static const int NUM_SNAPSHOTS = 2;		// One filled by 'submit()' while the other is measured
+
+	// Settings
+	float minX, minY;				// Lower-left corner of the grid
+	float cellSize;
+	int numCols, numRows;
+	float kernelRadius;				// Standard deviation of the density kernel in metres
+	float binWidth;					// Density per bin of the fundamental diagram, agents per square metre
+	int sampleInterval;				// Steps between samples
+	std::vector<MeasurementLine> lines;
+
+	FILE *file;						// Time series, null writes none
+	std::thread thread;
+	std::mutex mutex;
+	std::condition_variable queuedCondition, freedCondition;
+	Snapshot snapshots[NUM_SNAPSHOTS];
+	std::deque<int> queued;
+	std::deque<int> freed;
+	bool running;
+	bool closing;
+	bool failed;					// Set by the worker thread on an I/O error
+
+	// Worker Thread State
+	std::vector<unsigned int> cellCounts;	// Agents per cell, summed over samples
+	std::vector<double> cellSpeeds;			// Speeds per cell, summed over samples
+	std::vector<int> sampleCells;			// Cells occupied in the current sample and their agents in 'sampleCounts'
+	std::vector<unsigned int> sampleCounts;
+	std::vector<DiagramBin> diagram;
+	std::vector<unsigned long long> sampleCrossings;	// Both directions, per line since the previous sample
+	std::unordered_map<int, std::pair<float, float> > previousPositions, currentPositions;	// By agent id
+	CrowdState kernelCrowd;			// Positions only, for 'SpatialGrid'
+	SpatialGrid kernelGrid;
+	std::vector<int> candidates;
+	double previousTime;
+	unsigned long long numSamples;
+	double processTime;				// Seconds the worker thread spent measuring
+
+	double stallTime;				// Seconds 'submit()' spent waiting for a free snapshot
+	unsigned long long numSubmitted;
+
+	void workerLoop();
+	void measure(const Snapshot &snapshot);
+	void countCrossings(const Snapshot &snapshot);
+	void writeSample(const Snapshot &snapshot, double meanSpeed, double meanDensity, double maxDensity, unsigned int maxCellCount);
+
+public:
+	CrowdAnalytics();
+	~CrowdAnalytics();
+
+	CrowdAnalytics(const CrowdAnalytics &) = delete;
+	CrowdAnalytics &operator=(const CrowdAnalytics &) = delete;
+
+	// Settings, Kept Until Changed  Ignored while open
+	void setGrid(float minX, float minY, float maxX, float maxY, float cellSize = 0.5F);	// Agents outside are measured, but not gridded
+	void setKernelRadius(float radius) { kernelRadius = radius > 0.0F ? radius : kernelRadius; }	// Default 0.7 m
+	void setBinWidth(float width) { binWidth = width > 0.0F ? width : binWidth; }				// Default 0.25 per square metre
+	void setSampleInterval(int steps) { sampleInterval = steps > 1 ? steps : 1; }				// Default 10
+	int addLine(float startX, float startY, float endX, float endY);	// Returns its index
+
+	bool open(const char *path);	// Starts measuring, null path keeps no time series  Clears results of the previous run
+	bool close();					// Measures queued samples  Returns false if writing the time series failed
+	void submit(const CrowdState &crowd, unsigned long long step, double time);		// Samples every 'sampleInterval' steps, else returns
+
+	bool isOpen() const { return running; }
+
+	// Results, Complete Once Closed
+	bool writeFields(const char *path) const;		// CSV of each cell's mean density and speed
+	bool writeDiagram(const char *path) const;		// CSV of the fundamental diagram
+	const std::vector<MeasurementLine> &getLines() const { return lines; }
+	const std::vector<DiagramBin> &getDiagram() const { return diagram; }
+	double getCellDensity(int col, int row) const;	// Mean over samples, agents per square metre
+	double getCellSpeed(int col, int row) const;	// Mean over the agents seen in the cell
+	int getNumCols() const { return numCols; }
+	int getNumRows() const { return numRows; }
+	float getCellSize() const { return cellSize; }
+	float getBinWidth() const { return binWidth; }
+	unsigned long long getNumSamples() const { return numSamples; }
+	double getProcessTime() const { return processTime; }
+	double getStallTime() const { return stallTime; }
+};
+
+#endif
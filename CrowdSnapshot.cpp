@@ -0,0 +1,12 @@
+#include "CrowdSnapshot.h"
+using namespace std;
+
+void CrowdSnapshot::capture(const CrowdState &crowd, int step, float time) {
+	this->step = step;
+	this->time = time;
+
+	positionX.assign(crowd.positionX.begin(), crowd.positionX.end());
+	positionY.assign(crowd.positionY.begin(), crowd.positionY.end());
+	radius.assign(crowd.radius.begin(), crowd.radius.end());
+	colour.assign(crowd.colour.begin(), crowd.colour.end());
+}
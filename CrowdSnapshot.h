@@ -0,0 +1,22 @@
+#ifndef CROWD_SNAPSHOT_H
+#define CROWD_SNAPSHOT_H
+
+#include <vector>
+#include "CrowdState.h"
+
+// Copy of What the Viewer Draws, Taken by the Simulation Thread After a Step
+struct CrowdSnapshot {
+	int step;
+	float time;							// Simulated seconds
+	std::vector<float> positionX, positionY;
+	std::vector<float> radius;
+	std::vector<Color3f> colour;
+
+	CrowdSnapshot() : step(0), time(0.0F) {}
+
+	size_t size() const { return positionX.size(); }
+
+	void capture(const CrowdState &crowd, int step, float time);	// Keeps capacity, so steady runs do not allocate
+};
+
+#endif
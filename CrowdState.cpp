@@ -0,0 +1,336 @@
+#include <cmath>
+#include "CrowdState.h"
+using namespace std;
+
+size_t CrowdState::addAgent(int id, float radius, float desiredSpeed, Color3f colour, float x, float y, const vector<Waypoint> &path, int target) {
+	int routeIdx;
+
+	// Reuse Freed Route Entry if Available
+	if (!freeRoutes.empty()) {
+		routeIdx = freeRoutes.back();
+		freeRoutes.pop_back();
+		routes[routeIdx] = path;
+	}
+
+	else {
+		routeIdx = routes.size();
+		routes.push_back(path);
+	}
+
+	positionX.push_back(x);
+	positionY.push_back(y);
+	velocityX.push_back(0.0F);
+	velocityY.push_back(0.0F);
+	this->radius.push_back(radius);
+	this->desiredSpeed.push_back(desiredSpeed);
+
+	forceX.push_back(0.0F);
+	forceY.push_back(0.0F);
+	accelerationX.push_back(NAN);		// No previous step
+	accelerationY.push_back(NAN);
+	driftX.push_back(0.0F);
+	driftY.push_back(0.0F);
+	rateLevel.push_back(0);				// Evaluated on its first substep
+	idleSteps.push_back(0);
+	restTime.push_back(0.0F);
+
+	nextPositionX.push_back(x);
+	nextPositionY.push_back(y);
+	nextVelocityX.push_back(0.0F);
+	nextVelocityY.push_back(0.0F);
+
+	this->id.push_back(id);
+	this->colour.push_back(colour);
+	route.push_back(routeIdx);
+	pathIdx.push_back(0);
+	this->target.push_back(target);
+
+	return size() - 1;
+}
+
+void CrowdState::addWaypoint(size_t idx, Waypoint waypoint) {
+	routes[route[idx]].push_back(waypoint);
+}
+
+void CrowdState::reserve(size_t capacity) {
+	positionX.reserve(capacity);
+	positionY.reserve(capacity);
+	velocityX.reserve(capacity);
+	velocityY.reserve(capacity);
+	radius.reserve(capacity);
+	desiredSpeed.reserve(capacity);
+
+	forceX.reserve(capacity);
+	forceY.reserve(capacity);
+	accelerationX.reserve(capacity);
+	accelerationY.reserve(capacity);
+	driftX.reserve(capacity);
+	driftY.reserve(capacity);
+	rateLevel.reserve(capacity);
+	idleSteps.reserve(capacity);
+	restTime.reserve(capacity);
+
+	nextPositionX.reserve(capacity);
+	nextPositionY.reserve(capacity);
+	nextVelocityX.reserve(capacity);
+	nextVelocityY.reserve(capacity);
+
+	id.reserve(capacity);
+	colour.reserve(capacity);
+	route.reserve(capacity);
+	pathIdx.reserve(capacity);
+	target.reserve(capacity);
+
+	routes.reserve(capacity);
+	freeRoutes.reserve(capacity);
+
+	scratchFloats.reserve(capacity);
+	scratchInts.reserve(capacity);
+	scratchBytes.reserve(capacity);
+	scratchColours.reserve(capacity);
+}
+
+// Swap Remove  Copies last entry of every array over 'idx' and drops the last entry
+template <typename T>
+static void swapRemove(vector<T> &values, size_t idx) {
+	values[idx] = values.back();
+	values.pop_back();
+}
+
+void CrowdState::removeAgent(size_t idx) {
+	if (idx >= size())
+		return;
+
+	// Keep Route's Capacity for the Next Agent
+	routes[route[idx]].clear();
+	freeRoutes.push_back(route[idx]);
+
+	swapRemove(positionX, idx);
+	swapRemove(positionY, idx);
+	swapRemove(velocityX, idx);
+	swapRemove(velocityY, idx);
+	swapRemove(radius, idx);
+	swapRemove(desiredSpeed, idx);
+
+	swapRemove(forceX, idx);
+	swapRemove(forceY, idx);
+	swapRemove(accelerationX, idx);
+	swapRemove(accelerationY, idx);
+	swapRemove(driftX, idx);
+	swapRemove(driftY, idx);
+	swapRemove(rateLevel, idx);
+	swapRemove(idleSteps, idx);
+	swapRemove(restTime, idx);
+
+	swapRemove(nextPositionX, idx);
+	swapRemove(nextPositionY, idx);
+	swapRemove(nextVelocityX, idx);
+	swapRemove(nextVelocityY, idx);
+
+	swapRemove(id, idx);
+	swapRemove(colour, idx);
+	swapRemove(route, idx);
+	swapRemove(pathIdx, idx);
+	swapRemove(target, idx);
+}
+
+void CrowdState::addGhost(int id, float radius, float x, float y, float velocityX, float velocityY, uint8_t rateLevel, uint8_t idleSteps) {
+	positionX.push_back(x);
+	positionY.push_back(y);
+	this->velocityX.push_back(velocityX);
+	this->velocityY.push_back(velocityY);
+	this->radius.push_back(radius);
+	desiredSpeed.push_back(0.0F);
+
+	forceX.push_back(0.0F);
+	forceY.push_back(0.0F);
+	accelerationX.push_back(NAN);
+	accelerationY.push_back(NAN);
+	driftX.push_back(velocityX);
+	driftY.push_back(velocityY);
+	this->rateLevel.push_back(rateLevel);
+	this->idleSteps.push_back(idleSteps);
+	restTime.push_back(0.0F);
+
+	nextPositionX.push_back(x);
+	nextPositionY.push_back(y);
+	nextVelocityX.push_back(velocityX);
+	nextVelocityY.push_back(velocityY);
+
+	this->id.push_back(id);
+	colour.push_back(Color3f());
+	route.push_back(-1);
+	pathIdx.push_back(0);
+	target.push_back(-1);
+}
+
+void CrowdState::truncate(size_t count) {
+	if (count >= size())
+		return;
+
+	// Shrinking Keeps Capacity, So Ghosts Added Every Step Reuse It
+	positionX.resize(count);
+	positionY.resize(count);
+	velocityX.resize(count);
+	velocityY.resize(count);
+	radius.resize(count);
+	desiredSpeed.resize(count);
+
+	forceX.resize(count);
+	forceY.resize(count);
+	accelerationX.resize(count);
+	accelerationY.resize(count);
+	driftX.resize(count);
+	driftY.resize(count);
+	rateLevel.resize(count);
+	idleSteps.resize(count);
+	restTime.resize(count);
+
+	nextPositionX.resize(count);
+	nextPositionY.resize(count);
+	nextVelocityX.resize(count);
+	nextVelocityY.resize(count);
+
+	id.resize(count);
+	colour.resize(count);
+	route.resize(count);
+	pathIdx.resize(count);
+	target.resize(count);
+}
+
+// Gathers 'values' Into the New Order Through 'scratch', So 'values' Keeps Its Capacity
+template <typename T>
+static void permuteValues(vector<T> &values, const vector<uint32_t> &order, vector<T> &scratch) {
+	scratch.assign(values.begin(), values.end());
+
+	for (size_t idx = 0; idx < order.size(); idx++)
+		values[idx] = scratch[order[idx]];
+}
+
+void CrowdState::permute(const vector<uint32_t> &order) {
+	vector<float> &floats = scratchFloats;
+	vector<int> &ints = scratchInts;
+	vector<uint8_t> &bytes = scratchBytes;
+	vector<Color3f> &colours = scratchColours;
+
+	if (order.size() != size())
+		return;
+
+	permuteValues(positionX, order, floats);
+	permuteValues(positionY, order, floats);
+	permuteValues(velocityX, order, floats);
+	permuteValues(velocityY, order, floats);
+	permuteValues(radius, order, floats);
+	permuteValues(desiredSpeed, order, floats);
+
+	permuteValues(forceX, order, floats);
+	permuteValues(forceY, order, floats);
+	permuteValues(accelerationX, order, floats);
+	permuteValues(accelerationY, order, floats);
+	permuteValues(driftX, order, floats);
+	permuteValues(driftY, order, floats);
+	permuteValues(rateLevel, order, bytes);
+	permuteValues(idleSteps, order, bytes);
+	permuteValues(restTime, order, floats);
+
+	permuteValues(nextPositionX, order, floats);
+	permuteValues(nextPositionY, order, floats);
+	permuteValues(nextVelocityX, order, floats);
+	permuteValues(nextVelocityY, order, floats);
+
+	permuteValues(id, order, ints);
+	permuteValues(colour, order, colours);
+	permuteValues(route, order, ints);
+	permuteValues(pathIdx, order, ints);
+	permuteValues(target, order, ints);
+}
+
+void CrowdState::clear() {
+	positionX.clear();
+	positionY.clear();
+	velocityX.clear();
+	velocityY.clear();
+	radius.clear();
+	desiredSpeed.clear();
+
+	forceX.clear();
+	forceY.clear();
+	accelerationX.clear();
+	accelerationY.clear();
+	driftX.clear();
+	driftY.clear();
+	rateLevel.clear();
+	idleSteps.clear();
+	restTime.clear();
+
+	nextPositionX.clear();
+	nextPositionY.clear();
+	nextVelocityX.clear();
+	nextVelocityY.clear();
+
+	id.clear();
+	colour.clear();
+	route.clear();
+	pathIdx.clear();
+	target.clear();
+
+	routes.clear();
+	freeRoutes.clear();
+}
+
+void CrowdState::swapBuffers() {
+	positionX.swap(nextPositionX);
+	positionY.swap(nextPositionY);
+	velocityX.swap(nextVelocityX);
+	velocityY.swap(nextVelocityY);
+}
+
+void CrowdState::wake(size_t idx) {
+	rateLevel[idx] = 0;
+	idleSteps[idx] = 0;
+	restTime[idx] = 0.0F;
+}
+
+void CrowdState::updateTarget(size_t idx, float &targetX, float &targetY) {
+	const vector<Waypoint> &path = routes[route[idx]];
+	float currX, currY, nextX, nextY;
+	int nextIdx;
+
+	// Shared Target  The flow field gives the direction, this is where the agent ends up
+	if (target[idx] >= 0) {
+		targetX = targets[target[idx]].position.x;
+		targetY = targets[target[idx]].position.y;
+		return;
+	}
+
+	// Agent Without Waypoints Holds Its Position
+	if (path.empty()) {
+		targetX = positionX[idx];
+		targetY = positionY[idx];
+		return;
+	}
+
+	// Distance to Current Waypoint
+	currX = path[pathIdx[idx]].position.x - positionX[idx];
+	currY = path[pathIdx[idx]].position.y - positionY[idx];
+
+	if (path.size() > 2) {
+		nextIdx = (pathIdx[idx] + 1) % path.size();
+		nextX = path[nextIdx].position.x - positionX[idx];	// Distance to next waypoint
+		nextY = path[nextIdx].position.y - positionY[idx];
+
+		// Set Next Waypoint as Current Waypoint if Next Waypoint is Nearer
+		if ((nextX * nextX + nextY * nextY) < (currX * currX + currY * currY)) {
+			pathIdx[idx] = nextIdx;
+			currX = nextX;
+			currY = nextY;
+		}
+	}
+
+	// Advance to Next Waypoint if Within Radius  Loops back to the first waypoint after the last
+	if ((currX * currX + currY * currY) < (path[pathIdx[idx]].radius * path[pathIdx[idx]].radius))
+		pathIdx[idx] = (pathIdx[idx] + 1) % path.size();
+
+	targetX = path[pathIdx[idx]].position.x;
+	targetY = path[pathIdx[idx]].position.y;
+}
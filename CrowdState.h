@@ -0,0 +1,73 @@
+#ifndef CROWD_STATE_H
+#define CROWD_STATE_H
+
+#include <vecmath.h>
+#include <cstdint>
+#include <vector>
+
+const uint8_t ASLEEP = 255;		// 'idleSteps' of a sleeping agent, never counted down
+
+struct Waypoint {
+	Point3f position;
+	float radius;
+};
+
+// Structure-of-Arrays Storage of the Crowd  Entry 'i' of every array belongs to the same agent
+struct CrowdState {
+	// Hot Data (Read by the Force Kernels Every Step)
+	std::vector<float> positionX, positionY;
+	std::vector<float> velocityX, velocityY;
+	std::vector<float> radius;
+	std::vector<float> desiredSpeed;
+
+	// Acceleration Accumulated by the Force Phases of a Step (Unit Mass)
+	std::vector<float> forceX, forceY;
+
+	// Acceleration of the Previous Step, Used by Velocity Verlet (NaN for an agent that has not moved yet)
+	std::vector<float> accelerationX, accelerationY;
+
+	// Multirate Stepping and Sleeping (See 'SocialForce::setMultirate()' and 'SocialForce::setSleep()')
+	std::vector<float> driftX, driftY;		// Velocity the agent moves with until its forces are next evaluated
+	std::vector<uint8_t> rateLevel;			// Forces are evaluated every 2^rateLevel substeps
+	std::vector<uint8_t> idleSteps;			// Substeps left before the next evaluation, 0 evaluates this substep, 'ASLEEP' never
+	std::vector<float> restTime;			// Seconds the agent has been nearly still under nearly balanced forces
+
+	// Next State Written During a Step  Swapped with the current state once every agent has moved
+	std::vector<float> nextPositionX, nextPositionY;
+	std::vector<float> nextVelocityX, nextVelocityY;
+
+	// Cold Data
+	std::vector<int> id;
+	std::vector<Color3f> colour;
+	std::vector<int> route;			// Index of agent's waypoints in 'routes'
+	std::vector<int> pathIdx;		// Index of current waypoint in agent's route
+	std::vector<int> target;		// Index of agent's entry in 'targets', -1 follows its route instead
+
+	std::vector<std::vector<Waypoint> > routes;
+	std::vector<int> freeRoutes;	// Unused entries of 'routes'
+	std::vector<Waypoint> targets;	// Shared by any number of agents, each reached through a flow field in 'Navigation'
+
+	// Scratch of 'permute()', Kept So Reordering Does Not Allocate Once Reserved
+	std::vector<float> scratchFloats;
+	std::vector<int> scratchInts;
+	std::vector<uint8_t> scratchBytes;
+	std::vector<Color3f> scratchColours;
+
+	size_t size() const { return positionX.size(); }
+
+	size_t addAgent(int id, float radius, float desiredSpeed, Color3f colour, float x, float y, const std::vector<Waypoint> &path, int target);
+	void addWaypoint(size_t idx, Waypoint waypoint);
+	void removeAgent(size_t idx);	// Last agent takes the place of 'idx'
+	// Neighbour Without Route, Only Read by the Force Phases  Its rate level and sleep state are its own rank's, never counted down
+	void addGhost(int id, float radius, float x, float y, float velocityX, float velocityY, uint8_t rateLevel, uint8_t idleSteps);
+	void truncate(size_t count);	// Drops agents from 'count' on  Their routes must not be in use (ghosts)
+	void permute(const std::vector<uint32_t> &order);	// Agent 'order[i]' moves to 'i'  Covers every agent, keeps capacity
+	void reserve(size_t capacity);
+	void clear();
+	void swapBuffers();
+	void wake(size_t idx);		// Evaluated next substep at rate level 0, its rest starts again
+
+	void updateTarget(size_t idx, float &targetX, float &targetY);	// Advances waypoint cursor and returns current target (or shared target)
+};
+
+#endif
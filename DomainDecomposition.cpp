@@ -0,0 +1,481 @@
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstring>
+#include "DomainDecomposition.h"
+using namespace std;
+
+const int EDGE_SAMPLES = 64;		// Positions per rank a rebalance is computed from
+
+typedef chrono::steady_clock Clock;
+
+static double elapsedSeconds(Clock::time_point &start) {
+	Clock::time_point now = Clock::now();
+	double seconds = chrono::duration<double>(now - start).count();
+
+	start = now;	// Next phase starts here
+	return seconds;
+}
+
+void DecompositionStats::reset() {
+	rebalanceTime = migrationTime = ghostTime = 0.0;
+	agentsSent = agentsReceived = ghostsSent = ghostsReceived = 0;
+	rebalanced = false;
+}
+
+// Messages are Written Raw in Host Byte Order  Every rank runs the same build
+template <typename T>
+static void appendValue(vector<char> &message, const T &value) {
+	const char *bytes = reinterpret_cast<const char *>(&value);
+
+	message.insert(message.end(), bytes, bytes + sizeof(T));
+}
+
+template <typename T>
+static bool readValue(const vector<char> &message, size_t &offset, T &value) {
+	if (offset + sizeof(T) > message.size())
+		return false;
+
+	memcpy(&value, &message[offset], sizeof(T));
+	offset += sizeof(T);
+	return true;
+}
+
+DomainDecomposition::DomainDecomposition(SocialForce *socialForce, Transport *transport) {
+	this->socialForce = socialForce;
+	this->transport = transport;
+	haloWidth = socialForce->getForceModel().getInteractionRange();
+	rebalanceInterval = 50;
+	numSteps = 0;
+	wakeupsFailed = false;
+
+	edges.assign(transport->getNumRanks() + 1, INFINITY);
+	edges[0] = -INFINITY;
+
+	socialForce->setDecomposition(this);
+}
+
+DomainDecomposition::~DomainDecomposition() {
+	socialForce->setDecomposition(0);
+}
+
+int DomainDecomposition::getNeighbour(int side) const {
+	int rank = getRank() + ((side == 0) ? -1 : 1);
+
+	return (rank >= 0 && rank < getNumRanks()) ? rank : -1;
+}
+
+bool DomainDecomposition::exchangeNeighbours() {
+	bool succeeded = true;
+
+	// Left Before Right, So Every Rank Meets Its Partners in Ascending Order
+	for (int side = 0; side < 2; side++) {
+		int neighbour = getNeighbour(side);
+
+		if (neighbour >= 0)
+			succeeded = transport->exchange(neighbour, outgoing[side], incoming[side]) && succeeded;
+		else
+			incoming[side].clear();
+	}
+
+	return succeeded;
+}
+
+bool DomainDecomposition::placeEdges(vector<float> &placed) {
+	int numRanks = getNumRanks(), rank = 1;
+	double total = 0.0, covered = 0.0;
+
+	sort(samples.begin(), samples.end());
+
+	for (const pair<float, float> &sample : samples)
+		total += sample.second;
+
+	if (total <= 0.0)
+		return false;
+
+	placed.assign(numRanks + 1, INFINITY);
+	placed[0] = -INFINITY;
+
+	// Edge Halfway Between the Sample Completing a Share and the Next
+	for (size_t idx = 0; idx < samples.size() && rank < numRanks; idx++) {
+		covered += samples[idx].second;
+
+		while (rank < numRanks && covered >= total * rank / numRanks) {
+			placed[rank] = (idx + 1 < samples.size()) ? 0.5F * (samples[idx].first + samples[idx + 1].first) : samples[idx].first;
+			rank++;
+		}
+	}
+
+	return true;
+}
+
+bool DomainDecomposition::isValid(const vector<float> &candidate) const {
+	for (size_t rank = 1; rank + 1 < candidate.size(); rank++) {
+		if (!(candidate[rank] >= candidate[rank - 1]) || (rank > 1 && candidate[rank] - candidate[rank - 1] < haloWidth))
+			return false;
+	}
+
+	return true;
+}
+
+bool DomainDecomposition::distribute() {
+	const CrowdState &state = socialForce->getState();
+	int numRanks = getNumRanks(), rank = getRank();
+	float minX = INFINITY, maxX = -INFINITY;
+	vector<float> placed;
+	const vector<Source> &sources = socialForce->getSources();
+
+	haloWidth = socialForce->getForceModel().getInteractionRange();
+	samples.clear();
+
+	for (size_t idx = 0; idx < state.size(); idx++)
+		samples.push_back(make_pair(state.positionX[idx], 1.0F));
+
+	// Too Few Agents to Share Out, Split the Extent of the Scene Evenly
+	if (static_cast<int>(state.size()) < numRanks || !placeEdges(placed) || !isValid(placed)) {
+		for (size_t idx = 0; idx < state.size(); idx++) {
+			minX = min(minX, state.positionX[idx]);
+			maxX = max(maxX, state.positionX[idx]);
+		}
+
+		for (const Wall *wall : socialForce->getWalls()) {
+			minX = min(minX, wall->getBoundsMin().x);
+			maxX = max(maxX, wall->getBoundsMax().x);
+		}
+
+		for (const Source &source : sources) {
+			minX = min(minX, source.minX);
+			maxX = max(maxX, source.maxX);
+		}
+
+		if (!(minX <= maxX))
+			minX = maxX = 0.0F;
+
+		placed.assign(numRanks + 1, INFINITY);
+		placed[0] = -INFINITY;
+
+		for (int edge = 1; edge < numRanks; edge++)
+			placed[edge] = minX + (maxX - minX) * edge / numRanks;
+
+		if (!isValid(placed))
+			return false;
+	}
+
+	edges = placed;
+
+	// Keep the Own Strip  Sources stay with the rank holding their centre
+	leaving.clear();
+
+	for (size_t idx = 0; idx < state.size(); idx++) {
+		if (!(state.positionX[idx] >= edges[rank] && state.positionX[idx] < edges[rank + 1]))
+			leaving.push_back(idx);
+	}
+
+	socialForce->removeAgentsAt(leaving);
+	socialForce->removeSourcesOutside(edges[rank], edges[rank + 1]);
+
+	// Every Rank Built the Same Scene, So Its Ids Continue From the Same Point
+	socialForce->setIdSequence(socialForce->getNextId() + rank, numRanks);
+
+	numSteps = 0;
+	stats.reset();
+
+	return true;
+}
+
+bool DomainDecomposition::migrate() {
+	const CrowdState &state = socialForce->getState();
+	int rank = getRank();
+
+	leaving.clear();
+	outgoing[0].clear();
+	outgoing[1].clear();
+
+	// Whole Agent With Its Route and Motion, Including Multirate and Sleep State, Enough to Carry On Exactly Where It Left
+	for (size_t idx = 0; idx < state.size(); idx++) {
+		const vector<Waypoint> &path = state.routes[state.route[idx]];
+		AgentDynamics dynamics = AgentDynamics();	// Padding zeroed, messages carry no indeterminate bytes
+		int side;
+
+		if (state.positionX[idx] < edges[rank])
+			side = 0;
+		else if (state.positionX[idx] >= edges[rank + 1])
+			side = 1;
+		else
+			continue;
+
+		vector<char> &message = outgoing[side];
+
+		appendValue(message, state.id[idx]);
+		appendValue(message, state.radius[idx]);
+		appendValue(message, state.desiredSpeed[idx]);
+		appendValue(message, state.colour[idx]);
+		appendValue(message, state.positionX[idx]);
+		appendValue(message, state.positionY[idx]);
+		socialForce->getDynamics(idx, dynamics);
+		appendValue(message, dynamics);
+		appendValue(message, state.target[idx]);
+		appendValue(message, static_cast<unsigned int>(path.size()));
+
+		for (const Waypoint &waypoint : path)
+			appendValue(message, waypoint);
+
+		leaving.push_back(idx);
+	}
+
+	stats.agentsSent = leaving.size();
+	socialForce->removeAgentsAt(leaving);
+
+	if (!exchangeNeighbours())
+		return false;
+
+	stats.agentsReceived = 0;
+
+	for (int side = 0; side < 2; side++) {
+		const vector<char> &message = incoming[side];
+		size_t offset = 0;
+
+		while (offset < message.size()) {
+			Agent *agent = new Agent;
+			AgentDynamics dynamics;
+			unsigned int pathSize;
+			bool complete;
+
+			complete = readValue(message, offset, agent->id) && readValue(message, offset, agent->radius) &&
+					   readValue(message, offset, agent->desiredSpeed) && readValue(message, offset, agent->colour) &&
+					   readValue(message, offset, agent->position.x) && readValue(message, offset, agent->position.y) &&
+					   readValue(message, offset, dynamics) && readValue(message, offset, agent->target) && readValue(message, offset, pathSize);
+
+			agent->path.resize(complete ? pathSize : 0);
+
+			for (unsigned int waypoint = 0; complete && waypoint < pathSize; waypoint++)
+				complete = readValue(message, offset, agent->path[waypoint]);
+
+			if (!complete) {
+				delete agent;
+				return false;
+			}
+
+			socialForce->adoptAgent(agent, dynamics);
+			stats.agentsReceived++;
+		}
+	}
+
+	return true;
+}
+
+bool DomainDecomposition::exchangeGhosts() {
+	const CrowdState &state = socialForce->getState();
+	int rank = getRank();
+
+	outgoing[0].clear();
+	outgoing[1].clear();
+	stats.ghostsSent = 0;
+
+	// Agents Within Interaction Range of an Edge Act on the Neighbour's Agents Beyond It
+	for (size_t idx = 0; idx < state.size(); idx++) {
+		RemoteAgent ghost = { state.id[idx], state.radius[idx], state.positionX[idx], state.positionY[idx], state.velocityX[idx], state.velocityY[idx],
+							  state.rateLevel[idx], state.idleSteps[idx] };
+
+		if (getNeighbour(0) >= 0 && ghost.x < edges[rank] + haloWidth) {
+			appendValue(outgoing[0], ghost);
+			stats.ghostsSent++;
+		}
+
+		if (getNeighbour(1) >= 0 && ghost.x >= edges[rank + 1] - haloWidth) {
+			appendValue(outgoing[1], ghost);
+			stats.ghostsSent++;
+		}
+	}
+
+	if (!exchangeNeighbours())
+		return false;
+
+	ghosts.clear();
+
+	for (int side = 0; side < 2; side++) {
+		size_t offset = 0;
+		RemoteAgent ghost;
+
+		while (readValue(incoming[side], offset, ghost))
+			ghosts.push_back(ghost);
+
+		if (offset != incoming[side].size())
+			return false;
+	}
+
+	// By Id, So the Same Ghosts Keep Their Slots However the Neighbours Store Them and the Neighbour List Survives
+	sort(ghosts.begin(), ghosts.end(), [](const RemoteAgent &first, const RemoteAgent &second) { return first.id < second.id; });
+
+	stats.ghostsReceived = ghosts.size();
+	socialForce->setGhosts(ghosts);
+
+	return true;
+}
+
+void DomainDecomposition::exchangeWakeups() {
+	Clock::time_point start = Clock::now();
+	const CrowdState &state = socialForce->getState();
+	int id;
+	uint8_t level;
+
+	outgoing[0].clear();
+	outgoing[1].clear();
+
+	// Either Neighbour May Own a Ghost, the Other Finds No Agent of Its Id
+	for (const pair<int, uint8_t> &wakeup : socialForce->getGhostWakeups()) {
+		for (int side = 0; side < 2; side++) {
+			appendValue(outgoing[side], wakeup.first);
+			appendValue(outgoing[side], wakeup.second);
+		}
+	}
+
+	wakeupsFailed = !exchangeNeighbours() || wakeupsFailed;
+	wakeups.clear();
+
+	for (int side = 0; side < 2; side++) {
+		size_t offset = 0;
+
+		while (readValue(incoming[side], offset, id) && readValue(incoming[side], offset, level))
+			wakeups.push_back(make_pair(id, level));
+
+		wakeupsFailed = offset != incoming[side].size() || wakeupsFailed;
+	}
+
+	sort(wakeups.begin(), wakeups.end());
+
+	for (size_t idx = 0; !wakeups.empty() && idx < socialForce->getNumOwned(); idx++) {
+		auto first = lower_bound(wakeups.begin(), wakeups.end(), make_pair(state.id[idx], static_cast<uint8_t>(0)));
+
+		for (auto wakeup = first; wakeup != wakeups.end() && wakeup->first == state.id[idx]; wakeup++)
+			socialForce->wakeAgent(idx, wakeup->second);
+	}
+
+	stats.ghostTime += elapsedSeconds(start);
+}
+
+bool DomainDecomposition::step() {
+	Clock::time_point phaseStart = Clock::now();
+	float substepTime = socialForce->getTimeStep() / socialForce->getNumSubsteps();
+
+	stats.reset();
+
+	if (rebalanceInterval > 0 && numSteps > 0 && numSteps % rebalanceInterval == 0) {
+		if (!rebalance())
+			return false;
+	}
+
+	stats.rebalanceTime = elapsedSeconds(phaseStart);
+
+	// Neighbours Exchanged Before Every Substep, Since Each Reads the Positions of the One Before
+	for (int substep = 0; substep < socialForce->getNumSubsteps(); substep++) {
+		if (!migrate())
+			return false;
+
+		stats.migrationTime += elapsedSeconds(phaseStart);
+
+		if (!exchangeGhosts())
+			return false;
+
+		stats.ghostTime += elapsedSeconds(phaseStart);
+
+		// Every Rank Has the Same Settings, So All of Them Exchange Wakeups During the Step or None
+		socialForce->moveCrowd(substepTime);
+		phaseStart = Clock::now();
+
+		if (wakeupsFailed)
+			return false;
+	}
+
+	numSteps++;
+
+	return true;
+}
+
+bool DomainDecomposition::rebalance() {
+	const CrowdState &state = socialForce->getState();
+	vector<float> positions(state.positionX), placed;
+	unsigned long long count = state.size(), rankCount;
+	int numSamples = min(static_cast<int>(count), EDGE_SAMPLES);
+	float position;
+
+	// A Few Quantiles of Each Rank Stand for All of Its Agents
+	sort(positions.begin(), positions.end());
+	outgoing[0].clear();
+	appendValue(outgoing[0], count);
+
+	for (int sample = 0; sample < numSamples; sample++)
+		appendValue(outgoing[0], positions[(2 * sample + 1) * count / (2 * numSamples)]);
+
+	if (!transport->allGather(outgoing[0], gathered))
+		return false;
+
+	samples.clear();
+
+	for (const vector<char> &message : gathered) {
+		size_t offset = 0;
+
+		if (!readValue(message, offset, rankCount))
+			return false;
+
+		numSamples = (message.size() - offset) / sizeof(float);
+
+		while (readValue(message, offset, position))
+			samples.push_back(make_pair(position, static_cast<float>(rankCount) / numSamples));
+	}
+
+	// Every Rank Computes the Same Edges From the Same Samples
+	if (!placeEdges(placed))
+		return true;
+
+	for (size_t edge = 1; edge + 1 < edges.size(); edge++)
+		placed[edge] = min(max(placed[edge], edges[edge] - haloWidth), edges[edge] + haloWidth);
+
+	if (isValid(placed)) {
+		edges = placed;
+		stats.rebalanced = true;
+	}
+
+	return true;
+}
+
+bool DomainDecomposition::gather(vector<RemoteAgent> &agents) {
+	const CrowdState &state = socialForce->getState();
+	vector<char> &message = outgoing[0];
+	bool succeeded = true;
+
+	agents.clear();
+
+	for (size_t idx = 0; idx < state.size(); idx++) {
+		RemoteAgent agent = { state.id[idx], state.radius[idx], state.positionX[idx], state.positionY[idx], state.velocityX[idx], state.velocityY[idx],
+							  state.rateLevel[idx], state.idleSteps[idx] };
+		agents.push_back(agent);
+	}
+
+	// Other Ranks Only Talk to Rank 0, Which Listens in Rank Order
+	if (getRank() != 0) {
+		message.clear();
+
+		for (const RemoteAgent &agent : agents)
+			appendValue(message, agent);
+
+		agents.clear();
+		return transport->exchange(0, message, incoming[0]);
+	}
+
+	message.clear();
+
+	for (int rank = 1; rank < getNumRanks(); rank++) {
+		size_t offset = 0;
+		RemoteAgent agent;
+
+		succeeded = transport->exchange(rank, message, incoming[0]) && succeeded;
+
+		while (readValue(incoming[0], offset, agent))
+			agents.push_back(agent);
+	}
+
+	sort(agents.begin(), agents.end(), [](const RemoteAgent &first, const RemoteAgent &second) { return first.id < second.id; });
+
+	return succeeded;
+}
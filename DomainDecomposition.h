@@ -0,0 +1,82 @@
+#ifndef DOMAIN_DECOMPOSITION_H
+#define DOMAIN_DECOMPOSITION_H
+
+#include <utility>
+#include <vector>
+#include "SocialForce.h"
+#include "Transport.h"
+
+// Timings (Seconds) and Counters of the Last Call to 'DomainDecomposition::step()'
+struct DecompositionStats {
+	double rebalanceTime;
+	double migrationTime;			// Sending agents that left the strip and adding those that entered it
+	double ghostTime;				// Exchanging agents within interaction range of the strip edges, and waking them after the step
+	unsigned int agentsSent, agentsReceived;
+	unsigned int ghostsSent, ghostsReceived;
+	bool rebalanced;
+
+	DecompositionStats() { reset(); }
+	void reset();
+};
+
+// Splits a Scene Into Strips Along x, One per Rank of a 'Transport'
+// Every rank builds the same scene, then 'distribute()' keeps the agents and sources of its own strip  Before each step agents
+// that crossed an edge migrate to the neighbouring rank, and agents within interaction range of an edge are sent across as ghosts
+// Edges follow the crowd towards equal agent counts, moving at most the interaction range per rebalance
+class DomainDecomposition {
+private:
+	SocialForce *socialForce;		// Not owned
+	Transport *transport;			// Not owned
+	std::vector<float> edges;		// Strip of rank r is [edges[r], edges[r + 1]), outer edges are infinite
+	float haloWidth;				// Interaction range of the force model, also the narrowest strip
+	int rebalanceInterval;			// Steps between rebalances, 0 keeps the edges of 'distribute()'
+	unsigned long long numSteps;
+	DecompositionStats stats;
+	bool wakeupsFailed;				// A transport failed while 'SocialForce' exchanged wakeups in the current step
+
+	// Scratch, Capacity Reused Across Steps
+	std::vector<char> outgoing[2], incoming[2];		// To and from the left and right neighbour
+	std::vector<std::vector<char> > gathered;
+	std::vector<size_t> leaving;
+	std::vector<RemoteAgent> ghosts;
+	std::vector<std::pair<int, uint8_t> > wakeups;	// Own agents woken by a neighbour's agents, by id
+	std::vector<std::pair<float, float> > samples;	// Position along x and agents it stands for
+
+	int getNeighbour(int side) const;		// Rank to the left (0) or right (1), -1 beyond the outer strips
+	bool exchangeNeighbours();				// Sends 'outgoing' to and fills 'incoming' from both neighbours
+	bool placeEdges(std::vector<float> &placed);	// Equal shares of 'samples', unconstrained
+	bool isValid(const std::vector<float> &candidate) const;	// Ascending, interior strips no narrower than 'haloWidth'
+	bool migrate();
+	bool exchangeGhosts();
+
+public:
+	DomainDecomposition(SocialForce *socialForce, Transport *transport);	// Attaches itself to 'socialForce' until destroyed
+	~DomainDecomposition();
+
+	DomainDecomposition(const DomainDecomposition &) = delete;
+	DomainDecomposition &operator=(const DomainDecomposition &) = delete;
+
+	// Splits the Scene at Equal Agent Counts, or Evenly Across Its Bounds While Nearly Empty  Every rank must have built the same scene
+	// Drops agents and sources outside the own strip  False if the scene is too narrow for the number of ranks
+	bool distribute();
+
+	bool step();				// One fixed step of 'SocialForce' (every substep)  False if a transport failed
+	bool rebalance();			// Moves edges towards equal agent counts  Every rank must call it in the same step
+	bool gather(std::vector<RemoteAgent> &agents);	// Rank 0 receives every agent ordered by id, others send theirs
+
+	// Hands Ghosts Woken by Multirate Stepping or Sleeping Back to Their Own Rank and Wakes the Own Agents Woken Over There
+	// Called by 'SocialForce' between choosing rate levels and kicking agents, so a wake shortens a kick as in one engine
+	void exchangeWakeups();
+
+	void setRebalanceInterval(int steps) { rebalanceInterval = steps > 0 ? steps : 0; }	// Default 50
+
+	int getRank() const { return transport->getRank(); }
+	int getNumRanks() const { return transport->getNumRanks(); }
+	const std::vector<float> &getEdges() const { return edges; }
+	float getHaloWidth() const { return haloWidth; }
+	int getRebalanceInterval() const { return rebalanceInterval; }
+	const DecompositionStats &getStats() const { return stats; }
+	const Transport &getTransport() const { return *transport; }
+};
+
+#endif
@@ -0,0 +1,162 @@
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <thread>
+#include "Ensemble.h"
+#include "Scene.h"
+#include "SocialForce.h"
+using namespace std;
+
+typedef chrono::steady_clock Clock;
+
+EnsembleRun::EnsembleRun() {
+	scene = "bottleneck";
+	numAgents = 100;
+	numWalls = 2000;
+	seed = 1604010629;
+	stream = -1;
+	stepTime = 0.02F;
+	maxTime = 300.0;
+	exits = true;
+}
+
+void RunningStatistic::reset() {
+	count = 0;
+	mean = sumSquares = 0.0;
+	minimum = INFINITY;
+	maximum = -INFINITY;
+}
+
+void RunningStatistic::add(double value) {
+	double delta;
+
+	if (std::isnan(value))
+		return;
+
+	count++;
+	delta = value - mean;
+	mean += delta / count;
+	sumSquares += delta * (value - mean);
+	minimum = min(minimum, value);
+	maximum = max(maximum, value);
+}
+
+double RunningStatistic::getDeviation() const {
+	return (count > 1) ? sqrt(sumSquares / (count - 1)) : 0.0;
+}
+
+void EnsembleSummary::reset() {
+	numFinished = numEvacuated = 0;
+	evacuationTime.reset();
+	meanSpeed.reset();
+	wallTime = 0.0;
+}
+
+Ensemble::Ensemble(int numThreads) {
+	pool = new ThreadPool((numThreads > 0) ? numThreads : max(static_cast<int>(thread::hardware_concurrency()), 1));
+}
+
+Ensemble::~Ensemble() {
+	delete pool;
+}
+
+size_t Ensemble::addRun(const EnsembleRun &run) {
+	runs.push_back(run);
+	return runs.size() - 1;
+}
+
+void Ensemble::clear() {
+	runs.clear();
+	results.clear();
+	summary.reset();
+}
+
+RunSummary Ensemble::execute(size_t idx) const {
+	const EnsembleRun &run = runs[idx];
+	Clock::time_point start = Clock::now();
+	RunSummary result;
+	double speedSum = 0.0;
+	unsigned long long agentSteps = 0;
+
+	result.run = idx;
+	result.numSteps = result.agentsRetired = 0;
+	result.simulatedTime = result.meanSpeed = result.wallTime = 0.0;
+	result.evacuationTime = NAN;
+
+	// Whole Run on This Worker, No Threads of Its Own
+	SocialForce socialForce(1);
+
+	socialForce.setSeed(run.seed, (run.stream >= 0) ? run.stream : idx);
+	socialForce.setForceModel(new RuntimeForceModel(run.params));
+	socialForce.setTimeStep(run.stepTime);
+
+	result.valid = run.stepTime > 0.0F && createScene(&socialForce, run.scene.c_str(), run.numAgents, run.numWalls);
+	result.numAgents = socialForce.getCrowdSize();
+
+	if (run.exits)
+		createSceneExits(&socialForce, run.scene.c_str(), run.numAgents);
+
+	while (result.valid && socialForce.getTime() < run.maxTime) {
+		const CrowdState &state = socialForce.getState();
+		bool arrivalsLeft = false;
+
+		socialForce.moveCrowd(run.stepTime);
+
+		for (size_t agent = 0; agent < state.size(); agent++)
+			speedSum += sqrt(state.velocityX[agent] * state.velocityX[agent] + state.velocityY[agent] * state.velocityY[agent]);
+
+		agentSteps += state.size();
+
+		// Empty Once Every Agent Has Left and No Source Will Add Another
+		for (const Source &source : socialForce.getSources())
+			arrivalsLeft = arrivalsLeft || !source.isExhausted();
+
+		if (state.size() == 0 && !arrivalsLeft) {
+			result.evacuationTime = socialForce.getTime();
+			break;
+		}
+	}
+
+	result.numSteps = socialForce.getStepCount();
+	result.simulatedTime = socialForce.getTime();
+	result.meanSpeed = (agentSteps > 0) ? speedSum / agentSteps : 0.0;
+	result.agentsRetired = socialForce.getNumRetired();
+	result.wallTime = chrono::duration<double>(Clock::now() - start).count();
+
+	return result;
+}
+
+bool Ensemble::run(const FinishCallback &onFinish) {
+	Clock::time_point start = Clock::now();
+	bool succeeded = true;
+
+	results.assign(runs.size(), RunSummary());
+	summary.reset();
+
+	// One Run per Chunk, Claimed by Whichever Worker Is Free
+	auto executeRuns = [&](size_t begin, size_t end, int) {
+		for (size_t idx = begin; idx < end; idx++) {
+			RunSummary result = execute(idx);
+			lock_guard<mutex> lock(summaryMutex);
+
+			results[idx] = result;
+			succeeded = succeeded && result.valid;
+
+			summary.numFinished++;
+			summary.wallTime = chrono::duration<double>(Clock::now() - start).count();
+
+			if (!std::isnan(result.evacuationTime))
+				summary.numEvacuated++;
+
+			summary.evacuationTime.add(result.evacuationTime);
+			summary.meanSpeed.add(result.meanSpeed);
+
+			if (onFinish)
+				onFinish(results[idx], summary);
+		}
+	};
+
+	pool->parallelFor(runs.size(), 1, executeRuns);
+
+	return succeeded;
+}
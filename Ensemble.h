@@ -0,0 +1,100 @@
+#ifndef ENSEMBLE_H
+#define ENSEMBLE_H
+
+#include <cstddef>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <vector>
+#include "ModelParams.h"
+#include "ThreadPool.h"
+
+// One Member of an Ensemble: Scene, Model Parameters and Random Stream
+struct EnsembleRun {
+	std::string scene;				// See 'createScene()'
+	int numAgents;
+	int numWalls;					// Walls of the maze scene
+	RuntimeParams<float> params;
+	unsigned long long seed;
+	long long stream;				// Negative uses the run's index, so replicas of one seed never share draws
+	float stepTime;
+	double maxTime;					// Simulated seconds after which a run that has not emptied stops
+	bool exits;						// Retire agents past the exits of room scenes (see 'createSceneExits()')
+
+	EnsembleRun();
+};
+
+// Outcome of One Run
+struct RunSummary {
+	size_t run;						// Index in 'Ensemble'
+	bool valid;						// False if the scene is unknown
+	int numAgents;					// At the start
+	unsigned long long numSteps;
+	double simulatedTime;
+	double evacuationTime;			// Simulated seconds until the scene emptied, NaN if agents remained at 'maxTime'
+	double meanSpeed;				// Over every agent and step
+	unsigned long long agentsRetired;
+	double wallTime;				// Seconds spent on the run
+};
+
+// Count, Mean, Spread and Range of One Statistic, Updated One Value at a Time (Welford)  NaN values are skipped
+struct RunningStatistic {
+	unsigned long long count;
+	double mean, sumSquares, minimum, maximum;
+
+	RunningStatistic() { reset(); }
+	void reset();
+	void add(double value);
+	double getDeviation() const;	// Sample standard deviation, 0 below two values
+};
+
+// Aggregate of the Runs Finished So Far
+struct EnsembleSummary {
+	unsigned long long numFinished;
+	unsigned long long numEvacuated;	// Runs that emptied before 'maxTime'
+	RunningStatistic evacuationTime;
+	RunningStatistic meanSpeed;
+	double wallTime;					// Seconds since 'Ensemble::run()' started
+
+	EnsembleSummary() { reset(); }
+	void reset();
+};
+
+// Independent 'SocialForce' Runs Sharing One Thread Pool
+// Each run steps on a single worker, and workers claim the next run as they finish one, so sweeps of small scenes still keep
+// every core busy  Every run draws from its own 'CounterRandom' stream and uses its own parameters
+class Ensemble {
+public:
+	typedef std::function<void(const RunSummary &run, const EnsembleSummary &summary)> FinishCallback;
+
+private:
+	ThreadPool *pool;
+	std::vector<EnsembleRun> runs;
+	std::vector<RunSummary> results;	// Indexed by run
+	EnsembleSummary summary;
+	std::mutex summaryMutex;			// Guards 'summary' and calls of the finish callback
+
+	RunSummary execute(size_t idx) const;
+
+public:
+	explicit Ensemble(int numThreads = 0);	// 0 uses every hardware thread
+	~Ensemble();
+
+	Ensemble(const Ensemble &) = delete;
+	Ensemble &operator=(const Ensemble &) = delete;
+
+	size_t addRun(const EnsembleRun &run);	// Returns its index
+	void clear();
+
+	// Runs Every Member  'onFinish' is called once per run as it finishes, one call at a time, with the summary so far
+	// False if any run had an unknown scene
+	bool run(const FinishCallback &onFinish = FinishCallback());
+
+	int getNumThreads() const { return pool->getNumThreads(); }
+	size_t getNumRuns() const { return runs.size(); }
+	const EnsembleRun &getRun(size_t idx) const { return runs[idx]; }
+	const std::vector<RunSummary> &getResults() const { return results; }
+	const EnsembleSummary &getSummary() const { return summary; }
+};
+
+#endif
@@ -0,0 +1,90 @@
+#ifndef FAST_MATH_H
+#define FAST_MATH_H
+
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+
+#if defined(__SSE__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 1)
+#include <xmmintrin.h>
+#define FAST_MATH_SSE
+#endif
+
+// Approximations Behind 'MathMode::Fast'  Vector kernels evaluate the same polynomials with the same coefficients
+// Maximum relative error of each function over the arguments the interaction kernel passes:
+//   fastExp()          5.4e-6  (degree 4 minimax polynomial after range reduction)
+//   fastAtan2Upper()   8.2e-7  (degree 7 minimax polynomial after octant reduction)
+//   fastRsqrt()        2.7e-7  (hardware estimate and one Newton step)
+// Errors in theta are amplified a few hundred times by the exponents, the summed interaction force of one agent stays
+// within the bounds below of the precise scalar kernel  Both, and the drift of whole runs, are checked by 'sfm_bench --validate'
+
+const float FAST_MATH_RELATIVE_BOUND = 5.0e-4F;	// For summed forces above 1e-3
+const float FAST_MATH_ABSOLUTE_BOUND = 1.0e-4F;
+
+const float FAST_EXP_C2 = 0.50005119F;			// exp(r) = 1 + r + r^2 * (c2 + c3 * r + c4 * r^2)  for |r| <= ln2 / 2
+const float FAST_EXP_C3 = 0.16753517F;
+const float FAST_EXP_C4 = 0.041277327F;
+const float FAST_ATAN_C3 = -0.33325506F;		// atan(a) = a + a^3 * (c3 + c5 * a^2 + c7 * a^4)  for 0 <= a <= tan(PI / 8)
+const float FAST_ATAN_C5 = 0.19714105F;
+const float FAST_ATAN_C7 = -0.11224968F;
+
+// exp(x), Exactly 0 Below the Float Range
+inline float fastExp(float x) {
+	float n, r, p, scale;
+	int32_t bits;
+
+	if (x < -87.3F)
+		return 0.0F;
+
+	x = (x < 88.3F) ? x : 88.3F;
+
+	// Split x = n * ln2 + r  Adding 1.5 * 2^23 rounds to an integer without a library call
+	n = (x * 1.44269504088896341F + 12582912.0F) - 12582912.0F;
+	r = x - n * 0.693359375F;
+	r = r + n * 2.12194440e-4F;
+
+	p = 1.0F + r + r * r * (FAST_EXP_C2 + r * (FAST_EXP_C3 + r * FAST_EXP_C4));
+
+	// Multiply by 2^n Through the Exponent Bits
+	bits = (static_cast<int32_t>(n) + 127) << 23;
+	std::memcpy(&scale, &bits, sizeof(scale));
+
+	return p * scale;
+}
+
+// atan2(y, x) for y >= 0
+inline float fastAtan2Upper(float y, float x) {
+	float absX = std::fabs(x), a, z, p, larger, offset = 0.0F;
+	bool swap = y > absX;
+
+	// Fold into First Octant, Then Reduce a > tan(PI / 8) with atan(a) = PI / 4 + atan((a - 1) / (a + 1))
+	larger = swap ? y : absX;
+	a = (swap ? absX : y) / ((larger > 1.0e-30F) ? larger : 1.0e-30F);
+
+	if (a > 0.4142135623730950F) {
+		a = (a - 1.0F) / (a + 1.0F);
+		offset = 0.78539816339744831F;
+	}
+
+	z = a * a;
+	p = a + a * z * (FAST_ATAN_C3 + z * (FAST_ATAN_C5 + z * FAST_ATAN_C7)) + offset;
+
+	// Unfold Octants
+	if (swap)
+		p = 1.57079632679489662F - p;
+
+	return (x < 0.0F) ? 3.14159265358979324F - p : p;
+}
+
+// 1 / sqrt(x) for x > 0
+inline float fastRsqrt(float x) {
+#ifdef FAST_MATH_SSE
+	float y = _mm_cvtss_f32(_mm_rsqrt_ss(_mm_set_ss(x)));
+
+	return y * (1.5F - 0.5F * x * y * y);		// Newton step, 12 to 23 bits
+#else
+	return 1.0F / std::sqrt(x);
+#endif
+}
+
+#endif
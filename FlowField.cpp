@@ -0,0 +1,326 @@
+#include <algorithm>
+#include <climits>
+#include <cmath>
+#include <functional>
+#include "FlowField.h"
+using namespace std;
+
+// Neighbour Offsets, Orthogonal First
+const int NEIGHBOUR_COLS[8] = { 1, -1, 0, 0, 1, -1, 1, -1 };
+const int NEIGHBOUR_ROWS[8] = { 0, 0, 1, -1, 1, 1, -1, -1 };
+const float NEIGHBOUR_COSTS[8] = { 1.0F, 1.0F, 1.0F, 1.0F, 1.41421356F, 1.41421356F, 1.41421356F, 1.41421356F };	// In cells
+
+int NavigationGrid::cellOf(float x, float y) const {
+	float col = floor((x - originX) / cellSize), row = floor((y - originY) / cellSize);
+
+	if (!(col >= 0.0F && col < numCols && row >= 0.0F && row < numRows))
+		return -1;
+
+	return static_cast<int>(row) * numCols + static_cast<int>(col);
+}
+
+FlowField::FlowField(Waypoint target) {
+	this->target = target;
+	built = false;
+
+	touchedMinCol = touchedMinRow = INT_MAX;
+	touchedMaxCol = touchedMaxRow = -1;
+}
+
+void FlowField::touch(const NavigationGrid &grid, int cell) {
+	int col = cell % grid.numCols, row = cell / grid.numCols;
+
+	touchedMinCol = min(touchedMinCol, col);
+	touchedMaxCol = max(touchedMaxCol, col);
+	touchedMinRow = min(touchedMinRow, row);
+	touchedMaxRow = max(touchedMaxRow, row);
+}
+
+void FlowField::build(const NavigationGrid &grid) {
+	float radius = max(target.radius, 0.5F * grid.cellSize), centreX, centreY;
+	int colBegin, colEnd, rowBegin, rowEnd, targetCell;
+
+	distance.assign(grid.size(), INFINITY);
+	parent.assign(grid.size(), -1);
+	directionX.assign(grid.size(), 0.0F);
+	directionY.assign(grid.size(), 0.0F);
+	queue.clear();
+	built = true;
+
+	if (grid.size() == 0)
+		return;
+
+	// Seed Every Cell Within the Target's Radius, and the Cell Holding the Target
+	colBegin = max(static_cast<int>(floor((target.position.x - radius - grid.originX) / grid.cellSize)), 0);
+	colEnd = min(static_cast<int>(floor((target.position.x + radius - grid.originX) / grid.cellSize)), grid.numCols - 1);
+	rowBegin = max(static_cast<int>(floor((target.position.y - radius - grid.originY) / grid.cellSize)), 0);
+	rowEnd = min(static_cast<int>(floor((target.position.y + radius - grid.originY) / grid.cellSize)), grid.numRows - 1);
+
+	for (int row = rowBegin; row <= rowEnd; row++) {
+		for (int col = colBegin; col <= colEnd; col++) {
+			centreX = grid.originX + (col + 0.5F) * grid.cellSize - target.position.x;
+			centreY = grid.originY + (row + 0.5F) * grid.cellSize - target.position.y;
+
+			if (centreX * centreX + centreY * centreY <= radius * radius) {
+				distance[row * grid.numCols + col] = 0.0F;
+				queue.push_back(QueueEntry(0.0F, row * grid.numCols + col));
+			}
+		}
+	}
+
+	targetCell = grid.cellOf(target.position.x, target.position.y);
+
+	if (targetCell >= 0 && distance[targetCell] != 0.0F) {
+		distance[targetCell] = 0.0F;
+		queue.push_back(QueueEntry(0.0F, targetCell));
+	}
+
+	make_heap(queue.begin(), queue.end(), greater<QueueEntry>());
+	propagate(grid);
+
+	touchedMinCol = touchedMinRow = 0;
+	touchedMaxCol = grid.numCols - 1;
+	touchedMaxRow = grid.numRows - 1;
+	computeDirections(grid);
+}
+
+void FlowField::update(const NavigationGrid &grid, const vector<int> &changedCells) {
+	vector<int> reset, stack;
+
+	if (!built || distance.size() != grid.size()) {
+		build(grid);
+		return;
+	}
+
+	// Reset a Cell and Every Cell Whose Shortest Path Runs Through It
+	auto resetSubtree = [&](int root) {
+		if (distance[root] == 0.0F || isinf(distance[root]))
+			return;
+
+		distance[root] = INFINITY;
+		parent[root] = -1;
+		stack.push_back(root);
+
+		while (!stack.empty()) {
+			int cell = stack.back(), col = cell % grid.numCols, row = cell / grid.numCols;
+
+			stack.pop_back();
+			reset.push_back(cell);
+			touch(grid, cell);
+
+			for (int k = 0; k < 8; k++) {
+				int nextCol = col + NEIGHBOUR_COLS[k], nextRow = row + NEIGHBOUR_ROWS[k], next;
+
+				if (nextCol < 0 || nextCol >= grid.numCols || nextRow < 0 || nextRow >= grid.numRows)
+					continue;
+
+				next = nextRow * grid.numCols + nextCol;
+
+				if (parent[next] == cell) {
+					distance[next] = INFINITY;
+					parent[next] = -1;
+					stack.push_back(next);
+				}
+			}
+		}
+	};
+
+	for (int cell : changedCells) {
+		int col = cell % grid.numCols, row = cell / grid.numCols;
+
+		touch(grid, cell);
+
+		if (!grid.blocked[cell] || distance[cell] == 0.0F)
+			continue;	// Opened cells are filled from their neighbours below
+
+		resetSubtree(cell);
+
+		// Diagonal Steps Past the Newly Blocked Cell Now Cut Its Corner
+		for (int k = 0; k < 8; k++) {
+			int nextCol = col + NEIGHBOUR_COLS[k], nextRow = row + NEIGHBOUR_ROWS[k], next, parentCol, parentRow;
+
+			if (nextCol < 0 || nextCol >= grid.numCols || nextRow < 0 || nextRow >= grid.numRows)
+				continue;
+
+			next = nextRow * grid.numCols + nextCol;
+
+			if (parent[next] < 0)
+				continue;
+
+			parentCol = parent[next] % grid.numCols;
+			parentRow = parent[next] / grid.numCols;
+
+			if (parentCol != nextCol && parentRow != nextRow &&
+				((nextCol == col && parentRow == row) || (parentCol == col && nextRow == row)))
+				resetSubtree(next);
+		}
+	}
+
+	// Continue From the Cells Bordering Those Reset or Opened
+	queue.clear();
+
+	for (int pass = 0; pass < 2; pass++) {
+		const vector<int> &cells = (pass == 0) ? reset : changedCells;
+
+		for (int cell : cells) {
+			int col = cell % grid.numCols, row = cell / grid.numCols;
+
+			if (!isOpen(grid, cell))
+				continue;
+
+			for (int k = 0; k < 8; k++) {
+				int nextCol = col + NEIGHBOUR_COLS[k], nextRow = row + NEIGHBOUR_ROWS[k], next;
+
+				if (nextCol < 0 || nextCol >= grid.numCols || nextRow < 0 || nextRow >= grid.numRows)
+					continue;
+
+				next = nextRow * grid.numCols + nextCol;
+
+				if (isOpen(grid, next) && !isinf(distance[next]))
+					queue.push_back(QueueEntry(distance[next], next));
+			}
+		}
+	}
+
+	make_heap(queue.begin(), queue.end(), greater<QueueEntry>());
+	propagate(grid);
+	computeDirections(grid);
+}
+
+void FlowField::propagate(const NavigationGrid &grid) {
+	while (!queue.empty()) {
+		QueueEntry entry;
+		int col, row;
+
+		pop_heap(queue.begin(), queue.end(), greater<QueueEntry>());
+		entry = queue.back();
+		queue.pop_back();
+
+		// Skip Entries Superseded by a Shorter Path
+		if (entry.first > distance[entry.second])
+			continue;
+
+		col = entry.second % grid.numCols;
+		row = entry.second / grid.numCols;
+
+		for (int k = 0; k < 8; k++) {
+			int nextCol = col + NEIGHBOUR_COLS[k], nextRow = row + NEIGHBOUR_ROWS[k], next;
+			float candidate;
+
+			if (nextCol < 0 || nextCol >= grid.numCols || nextRow < 0 || nextRow >= grid.numRows)
+				continue;
+
+			next = nextRow * grid.numCols + nextCol;
+
+			if (!isOpen(grid, next))
+				continue;
+
+			// Diagonal Step Needs Both Cells Beside It Open
+			if (k >= 4 && (!isOpen(grid, row * grid.numCols + nextCol) || !isOpen(grid, nextRow * grid.numCols + col)))
+				continue;
+
+			candidate = entry.first + NEIGHBOUR_COSTS[k] * grid.cellSize;
+
+			if (candidate < distance[next]) {
+				distance[next] = candidate;
+				parent[next] = entry.second;
+				touch(grid, next);
+
+				queue.push_back(QueueEntry(candidate, next));
+				push_heap(queue.begin(), queue.end(), greater<QueueEntry>());
+			}
+		}
+	}
+}
+
+void FlowField::computeDirections(const NavigationGrid &grid) {
+	int colBegin = max(touchedMinCol - 1, 0), colEnd = min(touchedMaxCol + 1, grid.numCols - 1);
+	int rowBegin = max(touchedMinRow - 1, 0), rowEnd = min(touchedMaxRow + 1, grid.numRows - 1);
+
+	// Distance of a Neighbour, or INFINITY if It Cannot Be Walked To
+	auto neighbourDistance = [&](int col, int row) {
+		int cell = row * grid.numCols + col;
+
+		if (col < 0 || col >= grid.numCols || row < 0 || row >= grid.numRows || !isOpen(grid, cell))
+			return INFINITY;
+
+		return distance[cell];
+	};
+
+	for (int row = rowBegin; row <= rowEnd; row++) {
+		for (int col = colBegin; col <= colEnd; col++) {
+			int cell = row * grid.numCols + col;
+			float gradientX = 0.0F, gradientY = 0.0F, length, left, right, down, up, best;
+
+			if (isOpen(grid, cell) && distance[cell] > 0.0F && !isinf(distance[cell])) {
+				// Central Difference, One-Sided Beside Walls
+				left = neighbourDistance(col - 1, row);
+				right = neighbourDistance(col + 1, row);
+				down = neighbourDistance(col, row - 1);
+				up = neighbourDistance(col, row + 1);
+
+				if (!isinf(left) && !isinf(right))
+					gradientX = 0.5F * (right - left);
+				else if (!isinf(right))
+					gradientX = right - distance[cell];
+				else if (!isinf(left))
+					gradientX = distance[cell] - left;
+
+				if (!isinf(down) && !isinf(up))
+					gradientY = 0.5F * (up - down);
+				else if (!isinf(up))
+					gradientY = up - distance[cell];
+				else if (!isinf(down))
+					gradientY = distance[cell] - down;
+
+				gradientX = -gradientX;		// Downhill
+				gradientY = -gradientY;
+			}
+
+			// Agents Pressed Into a Wall's Clearance Head for the Nearest Open Cell Closest to the Target
+			else if (!isOpen(grid, cell)) {
+				best = INFINITY;
+
+				for (int k = 0; k < 8; k++) {
+					float candidate = neighbourDistance(col + NEIGHBOUR_COLS[k], row + NEIGHBOUR_ROWS[k]);
+
+					if (candidate < best) {
+						best = candidate;
+						gradientX = NEIGHBOUR_COLS[k];
+						gradientY = NEIGHBOUR_ROWS[k];
+					}
+				}
+			}
+
+			length = sqrt(gradientX * gradientX + gradientY * gradientY);
+
+			if (length > 1e-6F) {
+				directionX[cell] = gradientX / length;
+				directionY[cell] = gradientY / length;
+			}
+
+			else
+				directionX[cell] = directionY[cell] = 0.0F;
+		}
+	}
+
+	touchedMinCol = touchedMinRow = INT_MAX;
+	touchedMaxCol = touchedMaxRow = -1;
+}
+
+bool FlowField::sample(const NavigationGrid &grid, float x, float y, float &directionX, float &directionY) const {
+	int cell = grid.cellOf(x, y);
+
+	if (cell < 0 || (this->directionX[cell] == 0.0F && this->directionY[cell] == 0.0F))
+		return false;
+
+	directionX = this->directionX[cell];
+	directionY = this->directionY[cell];
+	return true;
+}
+
+float FlowField::getDistance(const NavigationGrid &grid, float x, float y) const {
+	int cell = grid.cellOf(x, y);
+
+	return (cell < 0) ? INFINITY : distance[cell];
+}
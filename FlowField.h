@@ -0,0 +1,56 @@
+#ifndef FLOW_FIELD_H
+#define FLOW_FIELD_H
+
+#include <cstddef>
+#include <utility>
+#include <vector>
+#include "CrowdState.h"
+
+// Uniform Grid of Cells Blocked by Walls, Shared by Every 'FlowField' of a 'Navigation'
+struct NavigationGrid {
+	float cellSize;
+	float originX, originY;				// Lower-left corner of the grid
+	int numCols, numRows;
+	std::vector<unsigned char> blocked;	// 1 where the cell centre lies within the clearance of a wall
+
+	NavigationGrid() : cellSize(0.25F), originX(0.0F), originY(0.0F), numCols(0), numRows(0) {}
+
+	size_t size() const { return blocked.size(); }
+	int cellOf(float x, float y) const;	// -1 outside the grid
+};
+
+// Walking Distance to One Target Over a 'NavigationGrid', and the Direction Down Its Gradient
+// Computed with Dijkstra over the 8 neighbours of each cell  Diagonal steps may not cut a blocked corner
+class FlowField {
+private:
+	typedef std::pair<float, int> QueueEntry;	// Tentative distance and cell
+
+	Waypoint target;
+	bool built;
+
+	std::vector<float> distance;		// INFINITY where the target cannot be reached
+	std::vector<int> parent;			// Next cell on the shortest path, -1 in the target and where unreachable
+	std::vector<float> directionX, directionY;	// Unit vector, zero in the target and where unreachable
+	std::vector<QueueEntry> queue;		// Heap reused across builds and updates
+
+	int touchedMinCol, touchedMaxCol, touchedMinRow, touchedMaxRow;	// Cells whose distance changed since directions were computed
+
+	void touch(const NavigationGrid &grid, int cell);
+	bool isOpen(const NavigationGrid &grid, int cell) const { return !grid.blocked[cell] || distance[cell] == 0.0F; }	// Target cells are always open
+	void propagate(const NavigationGrid &grid);		// Runs Dijkstra from the cells in 'queue'
+	void computeDirections(const NavigationGrid &grid);	// Over the touched cells and their neighbours
+
+public:
+	explicit FlowField(Waypoint target);
+
+	const Waypoint &getTarget() const { return target; }
+	bool isBuilt() const { return built; }
+
+	void build(const NavigationGrid &grid);
+	void update(const NavigationGrid &grid, const std::vector<int> &changedCells);	// Cells that flipped between blocked and open
+
+	bool sample(const NavigationGrid &grid, float x, float y, float &directionX, float &directionY) const;	// False where no direction helps
+	float getDistance(const NavigationGrid &grid, float x, float y) const;	// INFINITY outside the grid and where unreachable
+};
+
+#endif
@@ -0,0 +1,276 @@
+#include <cmath>
+#include <cstring>
+#include "ForceModel.h"
+using namespace std;
+
+ForceModel::ForceModel(bool singlePrecision) {
+	this->singlePrecision = singlePrecision;
+
+	mathMode = MathMode::Precise;
+	setKernelPath(detectKernelPath());
+	integrator = Integrator::SemiImplicitEuler;
+}
+
+void ForceModel::setKernelPath(KernelPath path) {
+	kernelPath = (singlePrecision && isKernelPathSupported(path)) ? path : KernelPath::Scalar;
+	kernel = getInteractionKernel(kernelPath, mathMode);
+}
+
+void ForceModel::setMathMode(MathMode mode) {
+	mathMode = singlePrecision ? mode : MathMode::Precise;
+	kernel = getInteractionKernel(kernelPath, mathMode);
+}
+
+template <typename Params>
+BasicForceModel<Params>::BasicForceModel(const Params &params) : ForceModel(sizeof(Real) == sizeof(float)) {
+	setParams(params);
+}
+
+template <typename Params>
+void BasicForceModel<Params>::setParams(const Params &params) {
+	this->params = params;
+
+	vectorParams.lambda = static_cast<float>(params.lambda);
+	vectorParams.gamma = static_cast<float>(params.gamma);
+	vectorParams.n_prime = static_cast<float>(params.n_prime);
+	vectorParams.n = static_cast<float>(params.n);
+	vectorParams.A = static_cast<float>(params.A);
+}
+
+template <typename Params>
+void BasicForceModel<Params>::drivingForce(const StepContext &context, size_t begin, size_t end) const {
+	CrowdState &crowd = *context.crowd;
+	float targetX, targetY, directionX, directionY;
+
+	for (size_t entry = begin; entry < end; entry++) {
+		size_t idx = context.getAgent(entry);
+
+		crowd.updateTarget(idx, targetX, targetY);
+
+		// Follow Flow Field Around Walls  Aim one metre along it, straight at the target where it gives no direction
+		if (crowd.target[idx] >= 0 && context.navigation->sample(crowd.target[idx], crowd.positionX[idx], crowd.positionY[idx], directionX, directionY)) {
+			targetX = crowd.positionX[idx] + directionX;
+			targetY = crowd.positionY[idx] + directionY;
+		}
+
+		computeDrivingForce(crowd, idx, targetX, targetY, crowd.forceX[idx], crowd.forceY[idx]);
+	}
+}
+
+template <typename Params>
+void BasicForceModel<Params>::agentInteractForce(const StepContext &context, size_t begin, size_t end, const NeighbourList &neighbours,
+												 StepScratch &scratch) const {
+	CrowdState &crowd = *context.crowd;
+	float forceX, forceY;
+
+	for (size_t entry = begin; entry < end; entry++) {
+		size_t idx = context.getAgent(entry);
+
+		computeAgentInteractForce(crowd, idx, neighbours.getNeighbours(idx), neighbours.getNumNeighbours(idx), scratch, forceX, forceY);
+		crowd.forceX[idx] += forceX;
+		crowd.forceY[idx] += forceY;
+	}
+}
+
+template <typename Params>
+void BasicForceModel<Params>::wallInteractForce(const StepContext &context, size_t begin, size_t end) const {
+	CrowdState &crowd = *context.crowd;
+	float forceX, forceY;
+
+	for (size_t entry = begin; entry < end; entry++) {
+		size_t idx = context.getAgent(entry);
+
+		computeWallInteractForce(crowd, idx, *context.walls, forceX, forceY);
+		crowd.forceX[idx] += forceX;
+		crowd.forceY[idx] += forceY;
+	}
+}
+
+// Scale (x, y) Down to 'maxSpeed' if Longer
+static inline void truncateSpeed(float &velocityX, float &velocityY, float maxSpeed) {
+	float speedSquared = velocityX * velocityX + velocityY * velocityY, scale;
+
+	if (speedSquared > (maxSpeed * maxSpeed)) {
+		scale = maxSpeed / sqrt(speedSquared);
+		velocityX *= scale;
+		velocityY *= scale;
+	}
+}
+
+// Kick Lasts Until the Agent's Next Evaluation, 2^rateLevel Substeps  Uniform stepping keeps every level at 0
+void ForceModel::integrate(const StepContext &context, size_t begin, size_t end) const {
+	for (size_t entry = begin; entry < end; entry++) {
+		size_t idx = context.getAgent(entry);
+		integrateAgent(*context.crowd, idx, context.stepTime * (1 << context.crowd->rateLevel[idx]), context.stepTime);
+	}
+}
+
+// Agents Skipped by the Force Phases Keep Their Velocity and Move Along the Drift of Their Last Kick
+void ForceModel::drift(const StepContext &context, size_t begin, size_t end) const {
+	CrowdState &crowd = *context.crowd;
+
+	for (size_t idx = begin; idx < end; idx++) {
+		crowd.nextVelocityX[idx] = crowd.velocityX[idx];
+		crowd.nextVelocityY[idx] = crowd.velocityY[idx];
+		crowd.nextPositionX[idx] = crowd.positionX[idx] + crowd.driftX[idx] * context.stepTime;
+		crowd.nextPositionY[idx] = crowd.positionY[idx] + crowd.driftY[idx] * context.stepTime;
+	}
+}
+
+void ForceModel::integrateAgent(CrowdState &crowd, size_t idx, float dt, float substepTime) const {
+	float velocityX, velocityY, driftX, driftY, previousX, previousY;
+
+	switch (integrator) {
+	case Integrator::SemiImplicitEuler:
+		// Compute New Velocity, Truncated if Exceed Maximum Speed (Magnitude)
+		velocityX = crowd.velocityX[idx] + crowd.forceX[idx] * dt;
+		velocityY = crowd.velocityY[idx] + crowd.forceY[idx] * dt;
+		truncateSpeed(velocityX, velocityY, crowd.desiredSpeed[idx]);
+
+		driftX = velocityX;
+		driftY = velocityY;
+		break;
+
+	case Integrator::ExplicitEuler:
+		// Move With Old Velocity, Then Update Velocity
+		driftX = crowd.velocityX[idx];
+		driftY = crowd.velocityY[idx];
+
+		velocityX = crowd.velocityX[idx] + crowd.forceX[idx] * dt;
+		velocityY = crowd.velocityY[idx] + crowd.forceY[idx] * dt;
+		truncateSpeed(velocityX, velocityY, crowd.desiredSpeed[idx]);
+		break;
+
+	default:
+		// Stored velocity is a prediction v_n' = v_(n-1/2) + a_(n-1) * dt / 2 that the forces were evaluated with
+		// Formula: v_(n+1/2) = v_n' + (a_n - a_(n-1) / 2) * dt,  x_(n+1) = x_n + v_(n+1/2) * dt,  v_(n+1)' = v_(n+1/2) + a_n * dt / 2
+		// An agent without previous acceleration starts with the half step v_(1/2) = v_0 + a_0 * dt / 2
+		previousX = isnan(crowd.accelerationX[idx]) ? crowd.forceX[idx] : crowd.accelerationX[idx];
+		previousY = isnan(crowd.accelerationY[idx]) ? crowd.forceY[idx] : crowd.accelerationY[idx];
+
+		driftX = crowd.velocityX[idx] + (crowd.forceX[idx] - 0.5F * previousX) * dt;
+		driftY = crowd.velocityY[idx] + (crowd.forceY[idx] - 0.5F * previousY) * dt;
+		truncateSpeed(driftX, driftY, crowd.desiredSpeed[idx]);
+
+		velocityX = driftX + 0.5F * crowd.forceX[idx] * dt;
+		velocityY = driftY + 0.5F * crowd.forceY[idx] * dt;
+		truncateSpeed(velocityX, velocityY, crowd.desiredSpeed[idx]);
+		break;
+	}
+
+	// Kept for Velocity Verlet Whichever Integrator Ran, So Switching Integrators Mid-Run Stays Consistent
+	crowd.accelerationX[idx] = crowd.forceX[idx];	// Only this agent's entry is read or written
+	crowd.accelerationY[idx] = crowd.forceY[idx];
+
+	// Compute New Position  Multirate stepping keeps the drift for the substeps until the next kick
+	crowd.driftX[idx] = driftX;
+	crowd.driftY[idx] = driftY;
+	crowd.nextVelocityX[idx] = velocityX;
+	crowd.nextVelocityY[idx] = velocityY;
+	crowd.nextPositionX[idx] = crowd.positionX[idx] + driftX * substepTime;
+	crowd.nextPositionY[idx] = crowd.positionY[idx] + driftY * substepTime;
+}
+
+template <typename Params>
+void BasicForceModel<Params>::computeDrivingForce(const CrowdState &crowd, size_t idx, float targetX, float targetY, float &forceX, float &forceY) const {
+	Real e_iX, e_iY, length;
+
+	// Compute Desired Direction
+	// Formula: e_i = (position_target - position_i) / ||(position_target - position_i)||
+	e_iX = Real(targetX) - Real(crowd.positionX[idx]);
+	e_iY = Real(targetY) - Real(crowd.positionY[idx]);
+	length = sqrt(e_iX * e_iX + e_iY * e_iY);
+
+	if (length > 0) {
+		e_iX /= length;
+		e_iY /= length;
+	}
+
+	// Compute Driving Force
+	// Formula: f_i = ((desiredSpeed * e_i) - velocity_i) / T
+	forceX = static_cast<float>(((crowd.desiredSpeed[idx] * e_iX) - crowd.velocityX[idx]) * (1 / params.T));
+	forceY = static_cast<float>(((crowd.desiredSpeed[idx] * e_iY) - crowd.velocityY[idx]) * (1 / params.T));
+}
+
+template <typename Params>
+void BasicForceModel<Params>::computeAgentInteractForce(const CrowdState &crowd, size_t idx, const int *neighbours, size_t numNeighbours,
+														StepScratch &scratch, float &forceX, float &forceY) const {
+	const float rangeSquared = params.interactionRange * params.interactionRange;
+	const float positionX = crowd.positionX[idx], positionY = crowd.positionY[idx];
+	const float velocityX = crowd.velocityX[idx], velocityY = crowd.velocityY[idx];
+	float distanceX, distanceY;
+
+	scratch.batch.clear();
+
+	scratch.pairsConsidered += numNeighbours;
+
+	// Pack Neighbours Within Interaction Range  The list never contains the agent itself
+	for (size_t k = 0; k < numNeighbours; k++) {
+		int j = neighbours[k];
+
+		// Compute Distance Between Agent j and i
+		distanceX = crowd.positionX[j] - positionX;
+		distanceY = crowd.positionY[j] - positionY;
+
+		// Skip Computation if Agents i and j are Too Far Away
+		if ((distanceX * distanceX + distanceY * distanceY) > rangeSquared)
+			continue;
+
+		scratch.batch.add(distanceX, distanceY, velocityX - crowd.velocityX[j], velocityY - crowd.velocityY[j]);
+	}
+
+	scratch.pairsWithinRange += scratch.batch.count;
+
+	// Precise Scalar Path Folds the Policy's Constants, Other Kernels Take Them as Values
+	if (kernelPath == KernelPath::Scalar && mathMode == MathMode::Precise)
+		interactScalar(scratch.batch, params, forceX, forceY);
+
+	else {
+		scratch.batch.pad(getKernelWidth(kernelPath));
+		kernel(scratch.batch, vectorParams, forceX, forceY);
+	}
+}
+
+template <typename Params>
+void BasicForceModel<Params>::computeWallInteractForce(const CrowdState &crowd, size_t idx, const WallIndex &walls, float &forceX, float &forceY) const {
+	//const float repulsionRange = 0.3F;	// Repulsion range based on (Moussaid et al., 2009)
+	float minVector_wiX, minVector_wiY, minDistanceSquared;
+	Real d_w, f_iw;
+
+	forceX = forceY = 0.0F;
+
+	// Nearest Wall Within Range, Vector Points from Wall to Agent i
+	if (!walls.nearest(crowd.positionX[idx], crowd.positionY[idx], minVector_wiX, minVector_wiY, minDistanceSquared))
+		return;
+
+	d_w = sqrt(Real(minDistanceSquared));		// Distance between wall and agent i centre
+
+	// Compute Interaction Force
+	// Formula: f_iw = a * exp(-(d_w - radius_i) / b)
+	f_iw = params.wallA * exp(-(d_w - crowd.radius[idx]) / params.wallB);
+
+	forceX = static_cast<float>(f_iw * minVector_wiX / d_w);
+	forceY = static_cast<float>(f_iw * minVector_wiY / d_w);
+}
+
+// Every Policy a Scene Can Select by Name
+template class BasicForceModel<MoussaidParams<float> >;
+template class BasicForceModel<MoussaidParams<double> >;
+template class BasicForceModel<RuntimeParams<float> >;
+template class BasicForceModel<RuntimeParams<double> >;
+
+ForceModel *createForceModel(const char *name) {
+	if (strcmp(name, "moussaid") == 0)
+		return new BasicForceModel<MoussaidParams<float> >;
+
+	if (strcmp(name, "moussaid-double") == 0)
+		return new BasicForceModel<MoussaidParams<double> >;
+
+	if (strcmp(name, "runtime") == 0)
+		return new BasicForceModel<RuntimeParams<float> >;
+
+	if (strcmp(name, "runtime-double") == 0)
+		return new BasicForceModel<RuntimeParams<double> >;
+
+	return 0;
+}
@@ -0,0 +1,114 @@
+#ifndef FORCE_MODEL_H
+#define FORCE_MODEL_H
+
+#include <cstdint>
+#include <utility>
+#include <vector>
+#include "CrowdState.h"
+#include "InteractionKernel.h"
+#include "ModelParams.h"
+#include "Navigation.h"
+#include "NeighbourList.h"
+#include "WallIndex.h"
+
+// Per-Step Inputs of the 'ForceModel' Phases  Views into engine-owned storage, never copied
+struct StepContext {
+	CrowdState *crowd;		// Current state is read, forces and next state are written
+	const WallIndex *walls;
+	const Navigation *navigation;	// Directions to shared targets
+	const uint32_t *agents;		// Agents the phases cover, range 'begin' to 'end' indexes this list  Null covers agents 'begin' to 'end' themselves
+	float stepTime;				// Substep, agents whose forces are evaluated are kicked for 2^rateLevel of them
+
+	size_t getAgent(size_t entry) const { return agents ? agents[entry] : entry; }
+};
+
+// Per-Thread Scratch Buffers and Counters  Capacity reused across steps
+struct StepScratch {
+	NeighbourBatch batch;			// Neighbours within interaction range, packed for the kernel
+
+	unsigned long long pairsConsidered;		// Neighbour list entries examined
+	unsigned long long pairsWithinRange;	// Entries passed to the kernel
+	std::vector<std::pair<uint32_t, uint8_t> > wakeups;	// Neighbours to evaluate sooner and the rate level each is limited to
+
+	StepScratch() : pairsConsidered(0), pairsWithinRange(0) {}
+};
+
+enum class Integrator {
+	SemiImplicitEuler,	// v += a * dt, then x += v * dt (default)
+	ExplicitEuler,		// x += v * dt with the old velocity, then v += a * dt
+	VelocityVerlet		// Second order, one force evaluation per step using the previous step's acceleration
+};
+
+// Step Phases of the Social Force Model of (Moussaid et al., 2009) on 'CrowdState', Independent of Its Parameters
+// Phases run in this order over ranges of agents  Each is safe to call concurrently for disjoint ranges
+class ForceModel {
+protected:
+	KernelPath kernelPath;
+	InteractionKernel kernel;
+	Integrator integrator;
+	MathMode mathMode;
+	bool singlePrecision;		// Vector kernels and fast math compute in float, double precision models always use the precise scalar kernel
+
+	void integrateAgent(CrowdState &crowd, size_t idx, float dt, float substepTime) const;	// Kicks for 'dt', moves for 'substepTime'
+
+public:
+	ForceModel(bool singlePrecision);
+	virtual ~ForceModel() {}
+
+	ForceModel(const ForceModel &) = delete;
+	ForceModel &operator=(const ForceModel &) = delete;
+
+	void setKernelPath(KernelPath path);	// Unsupported paths fall back to the scalar kernel
+	KernelPath getKernelPath() const { return kernelPath; }
+	void setMathMode(MathMode mode);
+	MathMode getMathMode() const { return mathMode; }
+	void setIntegrator(Integrator integrator) { this->integrator = integrator; }
+	Integrator getIntegrator() const { return integrator; }
+
+	virtual const char *getName() const = 0;
+	virtual float getInteractionRange() const = 0;	// Agents farther apart than this do not interact
+	virtual float getWallRange() const = 0;			// Walls farther than this from an agent's centre exert no force
+
+	virtual void drivingForce(const StepContext &context, size_t begin, size_t end) const = 0;		// Sets force to f_i
+	virtual void agentInteractForce(const StepContext &context, size_t begin, size_t end, const NeighbourList &neighbours,
+									StepScratch &scratch) const = 0;								// Adds f_ij over each agent's neighbours
+	virtual void wallInteractForce(const StepContext &context, size_t begin, size_t end) const = 0;	// Adds f_iw
+	void integrate(const StepContext &context, size_t begin, size_t end) const;						// Writes next state from force with 'integrator'
+	void drift(const StepContext &context, size_t begin, size_t end) const;	// Writes next state of agents 'begin' to 'end' (ignoring 'agents') without forces
+};
+
+// Force Model Specialised on a Parameter Policy (See ModelParams.h)  Instantiated in ForceModel.cpp for the policies there
+template <typename Params>
+class BasicForceModel : public ForceModel {
+private:
+	typedef typename Params::Scalar Real;
+
+	Params params;
+	InteractionParams vectorParams;		// 'params' as the vector kernels take them
+
+	void computeDrivingForce(const CrowdState &crowd, size_t idx, float targetX, float targetY, float &forceX, float &forceY) const;	// Computes f_i
+	void computeAgentInteractForce(const CrowdState &crowd, size_t idx, const int *neighbours, size_t numNeighbours, StepScratch &scratch,
+								   float &forceX, float &forceY) const;	// Computes f_ij
+	void computeWallInteractForce(const CrowdState &crowd, size_t idx, const WallIndex &walls, float &forceX, float &forceY) const;	// Computes f_iw
+
+public:
+	BasicForceModel(const Params &params = Params());
+
+	void setParams(const Params &params);
+	const Params &getParams() const { return params; }
+
+	const char *getName() const { return Params::name(); }
+	float getInteractionRange() const { return params.interactionRange; }
+	float getWallRange() const { return params.wallRange; }
+
+	void drivingForce(const StepContext &context, size_t begin, size_t end) const;
+	void agentInteractForce(const StepContext &context, size_t begin, size_t end, const NeighbourList &neighbours, StepScratch &scratch) const;
+	void wallInteractForce(const StepContext &context, size_t begin, size_t end) const;
+};
+
+typedef BasicForceModel<MoussaidParams<float> > MoussaidForceModel;		// Default
+typedef BasicForceModel<RuntimeParams<float> > RuntimeForceModel;
+
+ForceModel *createForceModel(const char *name);	// moussaid, moussaid-double, runtime or runtime-double  Null if unknown
+
+#endif
@@ -0,0 +1,253 @@
+#include <algorithm>
+#include <cmath>
+#include "FastMath.h"
+#include "InteractionKernel.h"
+#include "ModelParams.h"
+
+#if defined(_MSC_VER) && (defined(_M_X64) || defined(_M_IX86))
+#include <intrin.h>
+#include <immintrin.h>
+#endif
+
+using namespace std;
+
+const float PAD_DISTANCE = 1.0e6F;		// Distance of padding entries  exp() of it underflows to exactly zero
+
+void NeighbourBatch::add(float distanceX, float distanceY, float velocityX, float velocityY) {
+	// Grow Only When Needed, Capacity is Reused Across Steps
+	if (count == this->distanceX.size()) {
+		this->distanceX.push_back(distanceX);
+		this->distanceY.push_back(distanceY);
+		this->velocityX.push_back(velocityX);
+		this->velocityY.push_back(velocityY);
+	}
+
+	else {
+		this->distanceX[count] = distanceX;
+		this->distanceY[count] = distanceY;
+		this->velocityX[count] = velocityX;
+		this->velocityY[count] = velocityY;
+	}
+
+	count++;
+}
+
+void NeighbourBatch::reserve(size_t capacity) {
+	if (capacity <= distanceX.capacity())
+		return;
+
+	capacity = max(capacity, 2 * distanceX.capacity());
+	distanceX.reserve(capacity);
+	distanceY.reserve(capacity);
+	velocityX.reserve(capacity);
+	velocityY.reserve(capacity);
+}
+
+void NeighbourBatch::pad(size_t width) {
+	size_t packed = count;
+
+	while (count % width != 0)
+		add(PAD_DISTANCE, 0.0F, 0.0F, 0.0F);
+
+	count = packed;		// Padding lies past 'count' and is only read by vector kernels
+}
+
+template <typename Params>
+void interactScalar(const NeighbourBatch &batch, const Params &params, float &forceX, float &forceY) {
+	typedef typename Params::Scalar Real;
+
+	Real sumX = 0, sumY = 0;
+	Real distanceX, distanceY, distance, e_ijX, e_ijY, D_ijX, D_ijY, D_ijLength, t_ijX, t_ijY, B, theta, f_v, f_theta;
+	int K;
+
+	for (size_t idx = 0; idx < batch.count; idx++) {
+		// Compute Direction of Agent j from i
+		// Formula: e_ij = (position_j - position_i) / ||position_j - position_i||
+		distanceX = batch.distanceX[idx];
+		distanceY = batch.distanceY[idx];
+		distance = sqrt(distanceX * distanceX + distanceY * distanceY);
+		e_ijX = distanceX / distance;
+		e_ijY = distanceY / distance;
+
+		// Compute Interaction Vector Between Agent i and j
+		// Formula: D = lambda * (velocity_i - velocity_j) + e_ij
+		D_ijX = params.lambda * Real(batch.velocityX[idx]) + e_ijX;
+		D_ijY = params.lambda * Real(batch.velocityY[idx]) + e_ijY;
+
+		// Compute Modal Parameter B
+		// Formula: B = gamma * ||D_ij||
+		D_ijLength = sqrt(D_ijX * D_ijX + D_ijY * D_ijY);
+		B = params.gamma * D_ijLength;
+
+		// Compute Interaction Direction
+		// Formula: t_ij = D_ij / ||D_ij||
+		t_ijX = D_ijX / D_ijLength;
+		t_ijY = D_ijY / D_ijLength;
+
+		// Compute Angle Between Interaction Direction (t_ij) and Vector Pointing from Agent i to j (e_ij)
+		// Formula: theta = |atan2(||t_ij x e_ij||, t_ij . e_ij)|  (as 'Vector3f::angle()', stable near 0 and PI)
+		theta = atan2(abs(t_ijX * e_ijY - t_ijY * e_ijX), t_ijX * e_ijX + t_ijY * e_ijY);
+
+		// Compute Sign of Angle 'theta'
+		// Formula: K = theta / |theta|
+		K = (theta == 0) ? 0 : static_cast<int>(theta / abs(theta));
+
+		// Compute Amount of Deceleration
+		// Formula: f_v = -A * exp(-distance_ij / B - ((n_prime * B * theta) * (n_prime * B * theta)))
+		f_v = -params.A * exp(-distance / B - ((params.n_prime * B * theta) * (params.n_prime * B * theta)));
+
+		// Compute Amount of Directional Changes
+		// Formula: f_theta = -A * K * exp(-distance_ij / B - ((n * B * theta) * (n * B * theta)))
+		f_theta = -params.A * K * exp(-distance / B - ((params.n * B * theta) * (params.n * B * theta)));
+
+		// Compute Interaction Force
+		// Formula: f_ij = f_v * t_ij + f_theta * n_ij  where n_ij = (-t_ij.y, t_ij.x) is the normal oriented to the left
+		sumX += f_v * t_ijX - f_theta * t_ijY;
+		sumY += f_v * t_ijY + f_theta * t_ijX;
+	}
+
+	forceX = static_cast<float>(sumX);
+	forceY = static_cast<float>(sumY);
+}
+
+// Policies the Force Models and Vector Fallbacks Use
+template void interactScalar(const NeighbourBatch &, const InteractionParams &, float &, float &);
+template void interactScalar(const NeighbourBatch &, const MoussaidParams<float> &, float &, float &);
+template void interactScalar(const NeighbourBatch &, const MoussaidParams<double> &, float &, float &);
+template void interactScalar(const NeighbourBatch &, const RuntimeParams<float> &, float &, float &);
+template void interactScalar(const NeighbourBatch &, const RuntimeParams<double> &, float &, float &);
+
+void interactScalarFast(const NeighbourBatch &batch, const InteractionParams &params, float &forceX, float &forceY) {
+	const float n_primeSquared = params.n_prime * params.n_prime, nSquared = params.n * params.n;
+	float distanceSquared, inverseDistance, distance, e_ijX, e_ijY, D_ijX, D_ijY, D_ijSquared, inverseLength, t_ijX, t_ijY;
+	float B, theta, decay, spread, f_v, f_theta;
+
+	forceX = forceY = 0.0F;
+
+	for (size_t idx = 0; idx < batch.count; idx++) {
+		// e_ij = (position_j - position_i) / ||position_j - position_i||
+		distanceSquared = batch.distanceX[idx] * batch.distanceX[idx] + batch.distanceY[idx] * batch.distanceY[idx];
+		inverseDistance = fastRsqrt(distanceSquared);
+		distance = distanceSquared * inverseDistance;
+		e_ijX = batch.distanceX[idx] * inverseDistance;
+		e_ijY = batch.distanceY[idx] * inverseDistance;
+
+		// D = lambda * (velocity_i - velocity_j) + e_ij,  B = gamma * ||D_ij||,  t_ij = D_ij / ||D_ij||
+		D_ijX = params.lambda * batch.velocityX[idx] + e_ijX;
+		D_ijY = params.lambda * batch.velocityY[idx] + e_ijY;
+		D_ijSquared = D_ijX * D_ijX + D_ijY * D_ijY;
+		inverseLength = fastRsqrt(D_ijSquared);
+		B = params.gamma * D_ijSquared * inverseLength;
+		t_ijX = D_ijX * inverseLength;
+		t_ijY = D_ijY * inverseLength;
+
+		// theta = |atan2(||t_ij x e_ij||, t_ij . e_ij)|
+		theta = fastAtan2Upper(fabs(t_ijX * e_ijY - t_ijY * e_ijX), t_ijX * e_ijX + t_ijY * e_ijY);
+
+		// Both Exponents Share -distance_ij / B and (B * theta)^2, f_theta Vanishes With theta (K = 0)
+		decay = distance / B;
+		spread = (B * theta) * (B * theta);
+		f_v = -params.A * fastExp(-decay - n_primeSquared * spread);
+		f_theta = (theta == 0.0F) ? 0.0F : -params.A * fastExp(-decay - nSquared * spread);
+
+		// f_ij = f_v * t_ij + f_theta * n_ij  where n_ij = (-t_ij.y, t_ij.x)
+		forceX += f_v * t_ijX - f_theta * t_ijY;
+		forceY += f_v * t_ijY + f_theta * t_ijX;
+	}
+}
+
+bool isKernelPathSupported(KernelPath path) {
+	switch (path) {
+	case KernelPath::Scalar:
+		return true;
+
+#if (defined(__GNUC__) || defined(__clang__)) && (defined(__x86_64__) || defined(__i386__))
+	case KernelPath::AVX2:
+		return __builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma");
+
+	case KernelPath::AVX512:
+		return __builtin_cpu_supports("avx512f");
+#elif defined(_MSC_VER) && (defined(_M_X64) || defined(_M_IX86))
+	case KernelPath::AVX2:
+	case KernelPath::AVX512: {
+		int info[4];
+		bool osSupport, avx2, fma, avx512f;
+
+		// Check OS Saves AVX (and AVX-512) Registers on Context Switch
+		__cpuid(info, 1);
+		osSupport = (info[2] & (1 << 27)) && (info[2] & (1 << 28));	// OSXSAVE and AVX
+		fma = (info[2] & (1 << 12)) != 0;
+
+		if (!osSupport || (_xgetbv(0) & 0x6) != 0x6)
+			return false;
+
+		__cpuidex(info, 7, 0);
+		avx2 = (info[1] & (1 << 5)) != 0;
+		avx512f = (info[1] & (1 << 16)) != 0;
+
+		if (path == KernelPath::AVX2)
+			return avx2 && fma;
+
+		return avx512f && (_xgetbv(0) & 0xE6) == 0xE6;				// Opmask and upper ZMM state
+	}
+#endif
+
+	default:
+		return false;
+	}
+}
+
+KernelPath detectKernelPath() {
+	if (isKernelPathSupported(KernelPath::AVX512))
+		return KernelPath::AVX512;
+
+	if (isKernelPathSupported(KernelPath::AVX2))
+		return KernelPath::AVX2;
+
+	return KernelPath::Scalar;
+}
+
+size_t getKernelWidth(KernelPath path) {
+	switch (path) {
+	case KernelPath::AVX2:
+		return 8;
+
+	case KernelPath::AVX512:
+		return 16;
+
+	default:
+		return 1;
+	}
+}
+
+InteractionKernel getInteractionKernel(KernelPath path, MathMode mode) {
+	bool fast = (mode == MathMode::Fast);
+
+	// Fall Back to Scalar Kernel When Path Cannot Run Here
+	if (!isKernelPathSupported(path))
+		path = KernelPath::Scalar;
+
+	switch (path) {
+	case KernelPath::AVX2:
+		return fast ? interactAVX2Fast : interactAVX2;
+
+	case KernelPath::AVX512:
+		return fast ? interactAVX512Fast : interactAVX512;
+
+	default:
+		return fast ? interactScalarFast : interactScalar<InteractionParams>;
+	}
+}
+
+const char *getKernelPathName(KernelPath path) {
+	switch (path) {
+	case KernelPath::AVX2:
+		return "avx2";
+
+	case KernelPath::AVX512:
+		return "avx512";
+
+	default:
+		return "scalar";
+	}
+}
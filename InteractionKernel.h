@@ -0,0 +1,66 @@
+#ifndef INTERACTION_KERNEL_H
+#define INTERACTION_KERNEL_H
+
+#include <cstddef>
+#include <vector>
+
+// Constants of the Agent Interaction Force f_ij (Moussaid et al., 2009) as Passed to Vector Kernels
+// Also a parameter policy for 'interactScalar()' (See ModelParams.h)
+struct InteractionParams {
+	typedef float Scalar;
+
+	float lambda;	// Weight reflecting relative importance of velocity vector against position vector
+	float gamma;	// Speed interaction
+	float n_prime;	// Angular interaction
+	float n;		// Angular interaction
+	float A;		// Modal parameter A
+};
+
+// Neighbours of One Agent Packed for Batch Evaluation  Only pairs within the interaction range are packed
+struct NeighbourBatch {
+	std::vector<float> distanceX, distanceY;	// position_j - position_i
+	std::vector<float> velocityX, velocityY;	// velocity_i - velocity_j
+	size_t count;
+
+	NeighbourBatch() : count(0) {}
+
+	void clear() { count = 0; }
+	void reserve(size_t capacity);	// At least doubles when it grows, so a slowly rising longest row reallocates rarely
+	void add(float distanceX, float distanceY, float velocityX, float velocityY);
+	void pad(size_t width);		// Fills up to a multiple of 'width' with entries that contribute no force
+};
+
+enum class KernelPath {
+	Scalar,
+	AVX2,		// 8 neighbours per instruction
+	AVX512		// 16 neighbours per instruction
+};
+
+enum class MathMode {
+	Precise,	// Library exp and atan2 on the scalar path, vector paths accurate to about 2e-7
+	Fast		// Low-degree polynomials and reciprocal square root estimates, error budget in FastMath.h
+};
+
+// Sums f_ij Over Every Neighbour in 'batch'
+typedef void (*InteractionKernel)(const NeighbourBatch &batch, const InteractionParams &params, float &forceX, float &forceY);
+
+KernelPath detectKernelPath();					// Widest path supported by this CPU and OS
+bool isKernelPathSupported(KernelPath path);
+size_t getKernelWidth(KernelPath path);
+InteractionKernel getInteractionKernel(KernelPath path, MathMode mode = MathMode::Precise);
+const char *getKernelPathName(KernelPath path);
+
+// Path Specific Kernels
+// The scalar kernel takes any parameter policy and computes in 'Params::Scalar', instantiated in InteractionKernel.cpp
+// Vector paths use polynomial exp and atan approximations with a relative error of about 2e-7 per call
+template <typename Params>
+void interactScalar(const NeighbourBatch &batch, const Params &params, float &forceX, float &forceY);
+void interactAVX2(const NeighbourBatch &batch, const InteractionParams &params, float &forceX, float &forceY);
+void interactAVX512(const NeighbourBatch &batch, const InteractionParams &params, float &forceX, float &forceY);
+
+// Fast Mode Kernels  Share the exponents' common terms and skip f_theta where theta is 0
+void interactScalarFast(const NeighbourBatch &batch, const InteractionParams &params, float &forceX, float &forceY);
+void interactAVX2Fast(const NeighbourBatch &batch, const InteractionParams &params, float &forceX, float &forceY);
+void interactAVX512Fast(const NeighbourBatch &batch, const InteractionParams &params, float &forceX, float &forceY);
+
+#endif
@@ -0,0 +1,248 @@
+#include "FastMath.h"
+#include "InteractionKernel.h"
+
+#if defined(__x86_64__) || defined(__i386__) || defined(_M_X64) || defined(_M_IX86)
+#include <immintrin.h>
+
+// Compile Only These Functions for AVX2, the Rest of the Program Keeps the Baseline Instruction Set
+#if defined(__GNUC__) || defined(__clang__)
+#define TARGET_AVX2 __attribute__((target("avx2,fma")))
+#else
+#define TARGET_AVX2
+#endif
+
+// exp(x) by Range Reduction to [-ln2 / 2, ln2 / 2] and Degree 6 Polynomial (Cephes expf)
+TARGET_AVX2 static inline __m256 exp256(__m256 x) {
+	const __m256 underflow = _mm256_set1_ps(-87.3F);
+	__m256 n, r, p;
+	__m256i scale;
+
+	x = _mm256_min_ps(x, _mm256_set1_ps(88.3F));
+
+	// Split x = n * ln2 + r
+	n = _mm256_round_ps(_mm256_mul_ps(x, _mm256_set1_ps(1.44269504088896341F)), _MM_FROUND_TO_NEAREST_INT | _MM_FROUND_NO_EXC);
+	r = _mm256_fnmadd_ps(n, _mm256_set1_ps(0.693359375F), x);
+	r = _mm256_fnmadd_ps(n, _mm256_set1_ps(-2.12194440e-4F), r);
+
+	// exp(r)
+	p = _mm256_set1_ps(1.9875691500e-4F);
+	p = _mm256_fmadd_ps(p, r, _mm256_set1_ps(1.3981999507e-3F));
+	p = _mm256_fmadd_ps(p, r, _mm256_set1_ps(8.3334519073e-3F));
+	p = _mm256_fmadd_ps(p, r, _mm256_set1_ps(4.1665795894e-2F));
+	p = _mm256_fmadd_ps(p, r, _mm256_set1_ps(1.6666665459e-1F));
+	p = _mm256_fmadd_ps(p, r, _mm256_set1_ps(5.0000001201e-1F));
+	p = _mm256_fmadd_ps(p, _mm256_mul_ps(r, r), _mm256_add_ps(r, _mm256_set1_ps(1.0F)));
+
+	// Multiply by 2^n Through the Exponent Bits, Flush Results Below the Float Range to Zero
+	scale = _mm256_slli_epi32(_mm256_add_epi32(_mm256_cvtps_epi32(n), _mm256_set1_epi32(127)), 23);
+	p = _mm256_mul_ps(p, _mm256_castsi256_ps(scale));
+
+	return _mm256_andnot_ps(_mm256_cmp_ps(x, underflow, _CMP_LT_OQ), p);
+}
+
+// atan2(y, x) for y >= 0 by Reduction to [0, tan(PI / 8)] and Degree 9 Polynomial (Cephes atanf)
+TARGET_AVX2 static inline __m256 atan2Upper256(__m256 y, __m256 x) {
+	const __m256 absMask = _mm256_castsi256_ps(_mm256_set1_epi32(0x7FFFFFFF));
+	__m256 absX, numerator, denominator, swap, a, reduce, z, p, offset;
+
+	// Fold into First Octant: a = min(|x|, y) / max(|x|, y)
+	absX = _mm256_and_ps(x, absMask);
+	swap = _mm256_cmp_ps(y, absX, _CMP_GT_OQ);
+	numerator = _mm256_min_ps(absX, y);
+	denominator = _mm256_max_ps(absX, y);
+	a = _mm256_div_ps(numerator, _mm256_max_ps(denominator, _mm256_set1_ps(1.0e-30F)));
+
+	// Reduce a > tan(PI / 8) with atan(a) = PI / 4 + atan((a - 1) / (a + 1))
+	reduce = _mm256_cmp_ps(a, _mm256_set1_ps(0.4142135623730950F), _CMP_GT_OQ);
+	offset = _mm256_and_ps(reduce, _mm256_set1_ps(0.78539816339744831F));
+	a = _mm256_blendv_ps(a, _mm256_div_ps(_mm256_sub_ps(a, _mm256_set1_ps(1.0F)), _mm256_add_ps(a, _mm256_set1_ps(1.0F))), reduce);
+
+	z = _mm256_mul_ps(a, a);
+	p = _mm256_set1_ps(8.05374449538e-2F);
+	p = _mm256_fmadd_ps(p, z, _mm256_set1_ps(-1.38776856032e-1F));
+	p = _mm256_fmadd_ps(p, z, _mm256_set1_ps(1.99777106478e-1F));
+	p = _mm256_fmadd_ps(p, z, _mm256_set1_ps(-3.33329491539e-1F));
+	p = _mm256_add_ps(_mm256_fmadd_ps(_mm256_mul_ps(p, z), a, a), offset);
+
+	// Unfold Octants
+	p = _mm256_blendv_ps(p, _mm256_sub_ps(_mm256_set1_ps(1.57079632679489662F), p), swap);
+	p = _mm256_blendv_ps(p, _mm256_sub_ps(_mm256_set1_ps(3.14159265358979324F), p), _mm256_cmp_ps(x, _mm256_setzero_ps(), _CMP_LT_OQ));
+
+	return p;
+}
+
+// Fast Mode Counterparts  Same polynomials as FastMath.h, reciprocal estimates refined by one Newton step
+TARGET_AVX2 static inline __m256 exp256Fast(__m256 x) {
+	const __m256 underflow = _mm256_set1_ps(-87.3F);
+	__m256 n, r, p;
+	__m256i scale;
+
+	x = _mm256_min_ps(x, _mm256_set1_ps(88.3F));
+
+	n = _mm256_round_ps(_mm256_mul_ps(x, _mm256_set1_ps(1.44269504088896341F)), _MM_FROUND_TO_NEAREST_INT | _MM_FROUND_NO_EXC);
+	r = _mm256_fnmadd_ps(n, _mm256_set1_ps(0.693359375F), x);
+	r = _mm256_fnmadd_ps(n, _mm256_set1_ps(-2.12194440e-4F), r);
+
+	p = _mm256_fmadd_ps(_mm256_set1_ps(FAST_EXP_C4), r, _mm256_set1_ps(FAST_EXP_C3));
+	p = _mm256_fmadd_ps(p, r, _mm256_set1_ps(FAST_EXP_C2));
+	p = _mm256_fmadd_ps(p, _mm256_mul_ps(r, r), _mm256_add_ps(r, _mm256_set1_ps(1.0F)));
+
+	scale = _mm256_slli_epi32(_mm256_add_epi32(_mm256_cvtps_epi32(n), _mm256_set1_epi32(127)), 23);
+	p = _mm256_mul_ps(p, _mm256_castsi256_ps(scale));
+
+	return _mm256_andnot_ps(_mm256_cmp_ps(x, underflow, _CMP_LT_OQ), p);
+}
+
+TARGET_AVX2 static inline __m256 reciprocal256(__m256 x) {
+	__m256 y = _mm256_rcp_ps(x);
+
+	return _mm256_mul_ps(y, _mm256_fnmadd_ps(x, y, _mm256_set1_ps(2.0F)));
+}
+
+TARGET_AVX2 static inline __m256 rsqrt256(__m256 x) {
+	__m256 y = _mm256_rsqrt_ps(x);
+
+	return _mm256_mul_ps(y, _mm256_fnmadd_ps(_mm256_mul_ps(_mm256_set1_ps(0.5F), x), _mm256_mul_ps(y, y), _mm256_set1_ps(1.5F)));
+}
+
+TARGET_AVX2 static inline __m256 atan2Upper256Fast(__m256 y, __m256 x) {
+	const __m256 absMask = _mm256_castsi256_ps(_mm256_set1_epi32(0x7FFFFFFF));
+	__m256 absX, swap, a, reduce, z, p, offset;
+
+	absX = _mm256_and_ps(x, absMask);
+	swap = _mm256_cmp_ps(y, absX, _CMP_GT_OQ);
+	a = _mm256_mul_ps(_mm256_min_ps(absX, y), reciprocal256(_mm256_max_ps(_mm256_max_ps(absX, y), _mm256_set1_ps(1.0e-30F))));
+
+	reduce = _mm256_cmp_ps(a, _mm256_set1_ps(0.4142135623730950F), _CMP_GT_OQ);
+	offset = _mm256_and_ps(reduce, _mm256_set1_ps(0.78539816339744831F));
+	a = _mm256_blendv_ps(a, _mm256_mul_ps(_mm256_sub_ps(a, _mm256_set1_ps(1.0F)), reciprocal256(_mm256_add_ps(a, _mm256_set1_ps(1.0F)))), reduce);
+
+	z = _mm256_mul_ps(a, a);
+	p = _mm256_fmadd_ps(_mm256_set1_ps(FAST_ATAN_C7), z, _mm256_set1_ps(FAST_ATAN_C5));
+	p = _mm256_fmadd_ps(p, z, _mm256_set1_ps(FAST_ATAN_C3));
+	p = _mm256_add_ps(_mm256_fmadd_ps(_mm256_mul_ps(p, z), a, a), offset);
+
+	p = _mm256_blendv_ps(p, _mm256_sub_ps(_mm256_set1_ps(1.57079632679489662F), p), swap);
+	p = _mm256_blendv_ps(p, _mm256_sub_ps(_mm256_set1_ps(3.14159265358979324F), p), _mm256_cmp_ps(x, _mm256_setzero_ps(), _CMP_LT_OQ));
+
+	return p;
+}
+
+TARGET_AVX2 static inline float horizontalSum256(__m256 v) {
+	__m128 sum = _mm_add_ps(_mm256_castps256_ps128(v), _mm256_extractf128_ps(v, 1));
+
+	sum = _mm_add_ps(sum, _mm_movehl_ps(sum, sum));
+	sum = _mm_add_ss(sum, _mm_movehdup_ps(sum));
+
+	return _mm_cvtss_f32(sum);
+}
+
+TARGET_AVX2 void interactAVX2(const NeighbourBatch &batch, const InteractionParams &params, float &forceX, float &forceY) {
+	const __m256 lambda = _mm256_set1_ps(params.lambda), gamma = _mm256_set1_ps(params.gamma);
+	const __m256 n_prime = _mm256_set1_ps(params.n_prime), n = _mm256_set1_ps(params.n), minusA = _mm256_set1_ps(-params.A);
+	const __m256 absMask = _mm256_castsi256_ps(_mm256_set1_epi32(0x7FFFFFFF)), zero = _mm256_setzero_ps();
+	__m256 sumX = zero, sumY = zero;
+	__m256 distanceX, distanceY, distance, e_ijX, e_ijY, D_ijX, D_ijY, D_ijLength, t_ijX, t_ijY;
+	__m256 B, theta, K, decay, angle_v, angle_theta, f_v, f_theta;
+
+	// Entries Past 'count' are Padding that Contributes Exactly Zero (See 'NeighbourBatch::pad()')
+	for (size_t idx = 0; idx < batch.count; idx += 8) {
+		distanceX = _mm256_loadu_ps(&batch.distanceX[idx]);
+		distanceY = _mm256_loadu_ps(&batch.distanceY[idx]);
+
+		// e_ij = (position_j - position_i) / ||position_j - position_i||
+		distance = _mm256_sqrt_ps(_mm256_fmadd_ps(distanceX, distanceX, _mm256_mul_ps(distanceY, distanceY)));
+		e_ijX = _mm256_div_ps(distanceX, distance);
+		e_ijY = _mm256_div_ps(distanceY, distance);
+
+		// D = lambda * (velocity_i - velocity_j) + e_ij
+		D_ijX = _mm256_fmadd_ps(lambda, _mm256_loadu_ps(&batch.velocityX[idx]), e_ijX);
+		D_ijY = _mm256_fmadd_ps(lambda, _mm256_loadu_ps(&batch.velocityY[idx]), e_ijY);
+
+		// B = gamma * ||D_ij||,  t_ij = D_ij / ||D_ij||
+		D_ijLength = _mm256_sqrt_ps(_mm256_fmadd_ps(D_ijX, D_ijX, _mm256_mul_ps(D_ijY, D_ijY)));
+		B = _mm256_mul_ps(gamma, D_ijLength);
+		t_ijX = _mm256_div_ps(D_ijX, D_ijLength);
+		t_ijY = _mm256_div_ps(D_ijY, D_ijLength);
+
+		// theta = |atan2(||t_ij x e_ij||, t_ij . e_ij)|,  K = 1 unless theta is exactly 0
+		theta = atan2Upper256(_mm256_and_ps(_mm256_fmsub_ps(t_ijX, e_ijY, _mm256_mul_ps(t_ijY, e_ijX)), absMask),
+							  _mm256_fmadd_ps(t_ijX, e_ijX, _mm256_mul_ps(t_ijY, e_ijY)));
+		K = _mm256_and_ps(_mm256_cmp_ps(theta, zero, _CMP_NEQ_OQ), _mm256_set1_ps(1.0F));
+
+		// f_v = -A * exp(-distance_ij / B - (n_prime * B * theta)^2),  f_theta = -A * K * exp(-distance_ij / B - (n * B * theta)^2)
+		decay = _mm256_div_ps(distance, B);
+		angle_v = _mm256_mul_ps(_mm256_mul_ps(n_prime, B), theta);
+		angle_theta = _mm256_mul_ps(_mm256_mul_ps(n, B), theta);
+		f_v = _mm256_mul_ps(minusA, exp256(_mm256_fnmadd_ps(angle_v, angle_v, _mm256_sub_ps(zero, decay))));
+		f_theta = _mm256_mul_ps(_mm256_mul_ps(minusA, K), exp256(_mm256_fnmadd_ps(angle_theta, angle_theta, _mm256_sub_ps(zero, decay))));
+
+		// f_ij = f_v * t_ij + f_theta * n_ij  where n_ij = (-t_ij.y, t_ij.x)
+		sumX = _mm256_add_ps(sumX, _mm256_fmsub_ps(f_v, t_ijX, _mm256_mul_ps(f_theta, t_ijY)));
+		sumY = _mm256_add_ps(sumY, _mm256_fmadd_ps(f_v, t_ijY, _mm256_mul_ps(f_theta, t_ijX)));
+	}
+
+	forceX = horizontalSum256(sumX);
+	forceY = horizontalSum256(sumY);
+}
+
+TARGET_AVX2 void interactAVX2Fast(const NeighbourBatch &batch, const InteractionParams &params, float &forceX, float &forceY) {
+	const __m256 lambda = _mm256_set1_ps(params.lambda), gamma = _mm256_set1_ps(params.gamma), minusA = _mm256_set1_ps(-params.A);
+	const __m256 n_primeSquared = _mm256_set1_ps(params.n_prime * params.n_prime), nSquared = _mm256_set1_ps(params.n * params.n);
+	const __m256 absMask = _mm256_castsi256_ps(_mm256_set1_epi32(0x7FFFFFFF)), zero = _mm256_setzero_ps();
+	__m256 sumX = zero, sumY = zero;
+	__m256 distanceX, distanceY, distanceSquared, inverseDistance, e_ijX, e_ijY, D_ijX, D_ijY, D_ijSquared, inverseLength, t_ijX, t_ijY;
+	__m256 B, theta, K, decay, spread, f_v, f_theta;
+
+	for (size_t idx = 0; idx < batch.count; idx += 8) {
+		distanceX = _mm256_loadu_ps(&batch.distanceX[idx]);
+		distanceY = _mm256_loadu_ps(&batch.distanceY[idx]);
+
+		// e_ij = (position_j - position_i) / ||position_j - position_i||
+		distanceSquared = _mm256_fmadd_ps(distanceX, distanceX, _mm256_mul_ps(distanceY, distanceY));
+		inverseDistance = rsqrt256(distanceSquared);
+		e_ijX = _mm256_mul_ps(distanceX, inverseDistance);
+		e_ijY = _mm256_mul_ps(distanceY, inverseDistance);
+
+		// D = lambda * (velocity_i - velocity_j) + e_ij,  B = gamma * ||D_ij||,  t_ij = D_ij / ||D_ij||
+		D_ijX = _mm256_fmadd_ps(lambda, _mm256_loadu_ps(&batch.velocityX[idx]), e_ijX);
+		D_ijY = _mm256_fmadd_ps(lambda, _mm256_loadu_ps(&batch.velocityY[idx]), e_ijY);
+		D_ijSquared = _mm256_fmadd_ps(D_ijX, D_ijX, _mm256_mul_ps(D_ijY, D_ijY));
+		inverseLength = rsqrt256(D_ijSquared);
+		B = _mm256_mul_ps(gamma, _mm256_mul_ps(D_ijSquared, inverseLength));
+		t_ijX = _mm256_mul_ps(D_ijX, inverseLength);
+		t_ijY = _mm256_mul_ps(D_ijY, inverseLength);
+
+		// theta = |atan2(||t_ij x e_ij||, t_ij . e_ij)|,  K = 1 unless theta is exactly 0
+		theta = atan2Upper256Fast(_mm256_and_ps(_mm256_fmsub_ps(t_ijX, e_ijY, _mm256_mul_ps(t_ijY, e_ijX)), absMask),
+								  _mm256_fmadd_ps(t_ijX, e_ijX, _mm256_mul_ps(t_ijY, e_ijY)));
+		K = _mm256_and_ps(_mm256_cmp_ps(theta, zero, _CMP_NEQ_OQ), _mm256_set1_ps(1.0F));
+
+		// Both Exponents Share -distance_ij / B and (B * theta)^2
+		decay = _mm256_mul_ps(_mm256_mul_ps(distanceSquared, inverseDistance), reciprocal256(B));
+		spread = _mm256_mul_ps(B, theta);
+		spread = _mm256_mul_ps(spread, spread);
+		f_v = _mm256_mul_ps(minusA, exp256Fast(_mm256_fnmadd_ps(n_primeSquared, spread, _mm256_sub_ps(zero, decay))));
+		f_theta = _mm256_mul_ps(_mm256_mul_ps(minusA, K), exp256Fast(_mm256_fnmadd_ps(nSquared, spread, _mm256_sub_ps(zero, decay))));
+
+		// f_ij = f_v * t_ij + f_theta * n_ij  where n_ij = (-t_ij.y, t_ij.x)
+		sumX = _mm256_add_ps(sumX, _mm256_fmsub_ps(f_v, t_ijX, _mm256_mul_ps(f_theta, t_ijY)));
+		sumY = _mm256_add_ps(sumY, _mm256_fmadd_ps(f_v, t_ijY, _mm256_mul_ps(f_theta, t_ijX)));
+	}
+
+	forceX = horizontalSum256(sumX);
+	forceY = horizontalSum256(sumY);
+}
+
+#else
+
+// No x86 Vector Units, 'getInteractionKernel()' Never Selects This Path
+void interactAVX2(const NeighbourBatch &batch, const InteractionParams &params, float &forceX, float &forceY) {
+	interactScalar(batch, params, forceX, forceY);
+}
+
+void interactAVX2Fast(const NeighbourBatch &batch, const InteractionParams &params, float &forceX, float &forceY) {
+	interactScalarFast(batch, params, forceX, forceY);
+}
+
+#endif
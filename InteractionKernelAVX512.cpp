@@ -0,0 +1,233 @@
+#include "FastMath.h"
+#include "InteractionKernel.h"
+
+#if defined(__x86_64__) || defined(__i386__) || defined(_M_X64) || defined(_M_IX86)
+#include <immintrin.h>
+
+// Compile Only These Functions for AVX-512, the Rest of the Program Keeps the Baseline Instruction Set
+#if defined(__GNUC__) || defined(__clang__)
+#define TARGET_AVX512 __attribute__((target("avx512f")))
+#else
+#define TARGET_AVX512
+#endif
+
+// exp(x) by Range Reduction to [-ln2 / 2, ln2 / 2] and Degree 6 Polynomial (Cephes expf)
+TARGET_AVX512 static inline __m512 exp512(__m512 x) {
+	__m512 n, r, p;
+	__mmask16 inRange;
+
+	inRange = _mm512_cmp_ps_mask(x, _mm512_set1_ps(-87.3F), _CMP_GE_OQ);
+	x = _mm512_min_ps(x, _mm512_set1_ps(88.3F));
+
+	// Split x = n * ln2 + r
+	n = _mm512_roundscale_ps(_mm512_mul_ps(x, _mm512_set1_ps(1.44269504088896341F)), _MM_FROUND_TO_NEAREST_INT | _MM_FROUND_NO_EXC);
+	r = _mm512_fnmadd_ps(n, _mm512_set1_ps(0.693359375F), x);
+	r = _mm512_fnmadd_ps(n, _mm512_set1_ps(-2.12194440e-4F), r);
+
+	// exp(r)
+	p = _mm512_set1_ps(1.9875691500e-4F);
+	p = _mm512_fmadd_ps(p, r, _mm512_set1_ps(1.3981999507e-3F));
+	p = _mm512_fmadd_ps(p, r, _mm512_set1_ps(8.3334519073e-3F));
+	p = _mm512_fmadd_ps(p, r, _mm512_set1_ps(4.1665795894e-2F));
+	p = _mm512_fmadd_ps(p, r, _mm512_set1_ps(1.6666665459e-1F));
+	p = _mm512_fmadd_ps(p, r, _mm512_set1_ps(5.0000001201e-1F));
+	p = _mm512_fmadd_ps(p, _mm512_mul_ps(r, r), _mm512_add_ps(r, _mm512_set1_ps(1.0F)));
+
+	// Multiply by 2^n, Flush Results Below the Float Range to Zero
+	return _mm512_maskz_scalef_ps(inRange, p, n);
+}
+
+// atan2(y, x) for y >= 0 by Reduction to [0, tan(PI / 8)] and Degree 9 Polynomial (Cephes atanf)
+TARGET_AVX512 static inline __m512 atan2Upper512(__m512 y, __m512 x) {
+	__m512 absX, a, z, p;
+	__mmask16 swap, reduce;
+
+	// Fold into First Octant: a = min(|x|, y) / max(|x|, y)
+	absX = _mm512_abs_ps(x);
+	swap = _mm512_cmp_ps_mask(y, absX, _CMP_GT_OQ);
+	a = _mm512_div_ps(_mm512_min_ps(absX, y), _mm512_max_ps(_mm512_max_ps(absX, y), _mm512_set1_ps(1.0e-30F)));
+
+	// Reduce a > tan(PI / 8) with atan(a) = PI / 4 + atan((a - 1) / (a + 1))
+	reduce = _mm512_cmp_ps_mask(a, _mm512_set1_ps(0.4142135623730950F), _CMP_GT_OQ);
+	a = _mm512_mask_div_ps(a, reduce, _mm512_sub_ps(a, _mm512_set1_ps(1.0F)), _mm512_add_ps(a, _mm512_set1_ps(1.0F)));
+
+	z = _mm512_mul_ps(a, a);
+	p = _mm512_set1_ps(8.05374449538e-2F);
+	p = _mm512_fmadd_ps(p, z, _mm512_set1_ps(-1.38776856032e-1F));
+	p = _mm512_fmadd_ps(p, z, _mm512_set1_ps(1.99777106478e-1F));
+	p = _mm512_fmadd_ps(p, z, _mm512_set1_ps(-3.33329491539e-1F));
+	p = _mm512_fmadd_ps(_mm512_mul_ps(p, z), a, a);
+	p = _mm512_mask_add_ps(p, reduce, p, _mm512_set1_ps(0.78539816339744831F));
+
+	// Unfold Octants
+	p = _mm512_mask_sub_ps(p, swap, _mm512_set1_ps(1.57079632679489662F), p);
+	p = _mm512_mask_sub_ps(p, _mm512_cmp_ps_mask(x, _mm512_setzero_ps(), _CMP_LT_OQ), _mm512_set1_ps(3.14159265358979324F), p);
+
+	return p;
+}
+
+// Fast Mode Counterparts  Same polynomials as FastMath.h, reciprocal estimates refined by one Newton step
+TARGET_AVX512 static inline __m512 exp512Fast(__m512 x) {
+	__m512 n, r, p;
+	__mmask16 inRange;
+
+	inRange = _mm512_cmp_ps_mask(x, _mm512_set1_ps(-87.3F), _CMP_GE_OQ);
+	x = _mm512_min_ps(x, _mm512_set1_ps(88.3F));
+
+	n = _mm512_roundscale_ps(_mm512_mul_ps(x, _mm512_set1_ps(1.44269504088896341F)), _MM_FROUND_TO_NEAREST_INT | _MM_FROUND_NO_EXC);
+	r = _mm512_fnmadd_ps(n, _mm512_set1_ps(0.693359375F), x);
+	r = _mm512_fnmadd_ps(n, _mm512_set1_ps(-2.12194440e-4F), r);
+
+	p = _mm512_fmadd_ps(_mm512_set1_ps(FAST_EXP_C4), r, _mm512_set1_ps(FAST_EXP_C3));
+	p = _mm512_fmadd_ps(p, r, _mm512_set1_ps(FAST_EXP_C2));
+	p = _mm512_fmadd_ps(p, _mm512_mul_ps(r, r), _mm512_add_ps(r, _mm512_set1_ps(1.0F)));
+
+	return _mm512_maskz_scalef_ps(inRange, p, n);
+}
+
+TARGET_AVX512 static inline __m512 reciprocal512(__m512 x) {
+	__m512 y = _mm512_rcp14_ps(x);
+
+	return _mm512_mul_ps(y, _mm512_fnmadd_ps(x, y, _mm512_set1_ps(2.0F)));
+}
+
+TARGET_AVX512 static inline __m512 rsqrt512(__m512 x) {
+	__m512 y = _mm512_rsqrt14_ps(x);
+
+	return _mm512_mul_ps(y, _mm512_fnmadd_ps(_mm512_mul_ps(_mm512_set1_ps(0.5F), x), _mm512_mul_ps(y, y), _mm512_set1_ps(1.5F)));
+}
+
+TARGET_AVX512 static inline __m512 atan2Upper512Fast(__m512 y, __m512 x) {
+	__m512 absX, a, z, p;
+	__mmask16 swap, reduce;
+
+	absX = _mm512_abs_ps(x);
+	swap = _mm512_cmp_ps_mask(y, absX, _CMP_GT_OQ);
+	a = _mm512_mul_ps(_mm512_min_ps(absX, y), reciprocal512(_mm512_max_ps(_mm512_max_ps(absX, y), _mm512_set1_ps(1.0e-30F))));
+
+	reduce = _mm512_cmp_ps_mask(a, _mm512_set1_ps(0.4142135623730950F), _CMP_GT_OQ);
+	a = _mm512_mask_mul_ps(a, reduce, _mm512_sub_ps(a, _mm512_set1_ps(1.0F)), reciprocal512(_mm512_add_ps(a, _mm512_set1_ps(1.0F))));
+
+	z = _mm512_mul_ps(a, a);
+	p = _mm512_fmadd_ps(_mm512_set1_ps(FAST_ATAN_C7), z, _mm512_set1_ps(FAST_ATAN_C5));
+	p = _mm512_fmadd_ps(p, z, _mm512_set1_ps(FAST_ATAN_C3));
+	p = _mm512_fmadd_ps(_mm512_mul_ps(p, z), a, a);
+	p = _mm512_mask_add_ps(p, reduce, p, _mm512_set1_ps(0.78539816339744831F));
+
+	p = _mm512_mask_sub_ps(p, swap, _mm512_set1_ps(1.57079632679489662F), p);
+	p = _mm512_mask_sub_ps(p, _mm512_cmp_ps_mask(x, _mm512_setzero_ps(), _CMP_LT_OQ), _mm512_set1_ps(3.14159265358979324F), p);
+
+	return p;
+}
+
+TARGET_AVX512 void interactAVX512(const NeighbourBatch &batch, const InteractionParams &params, float &forceX, float &forceY) {
+	const __m512 lambda = _mm512_set1_ps(params.lambda), gamma = _mm512_set1_ps(params.gamma);
+	const __m512 n_prime = _mm512_set1_ps(params.n_prime), n = _mm512_set1_ps(params.n), minusA = _mm512_set1_ps(-params.A);
+	const __m512 zero = _mm512_setzero_ps();
+	__m512 sumX = zero, sumY = zero;
+	__m512 distanceX, distanceY, distance, e_ijX, e_ijY, D_ijX, D_ijY, D_ijLength, t_ijX, t_ijY;
+	__m512 B, theta, decay, angle_v, angle_theta, f_v, f_theta;
+	__mmask16 K;
+
+	// Entries Past 'count' are Padding that Contributes Exactly Zero (See 'NeighbourBatch::pad()')
+	for (size_t idx = 0; idx < batch.count; idx += 16) {
+		distanceX = _mm512_loadu_ps(&batch.distanceX[idx]);
+		distanceY = _mm512_loadu_ps(&batch.distanceY[idx]);
+
+		// e_ij = (position_j - position_i) / ||position_j - position_i||
+		distance = _mm512_sqrt_ps(_mm512_fmadd_ps(distanceX, distanceX, _mm512_mul_ps(distanceY, distanceY)));
+		e_ijX = _mm512_div_ps(distanceX, distance);
+		e_ijY = _mm512_div_ps(distanceY, distance);
+
+		// D = lambda * (velocity_i - velocity_j) + e_ij
+		D_ijX = _mm512_fmadd_ps(lambda, _mm512_loadu_ps(&batch.velocityX[idx]), e_ijX);
+		D_ijY = _mm512_fmadd_ps(lambda, _mm512_loadu_ps(&batch.velocityY[idx]), e_ijY);
+
+		// B = gamma * ||D_ij||,  t_ij = D_ij / ||D_ij||
+		D_ijLength = _mm512_sqrt_ps(_mm512_fmadd_ps(D_ijX, D_ijX, _mm512_mul_ps(D_ijY, D_ijY)));
+		B = _mm512_mul_ps(gamma, D_ijLength);
+		t_ijX = _mm512_div_ps(D_ijX, D_ijLength);
+		t_ijY = _mm512_div_ps(D_ijY, D_ijLength);
+
+		// theta = |atan2(||t_ij x e_ij||, t_ij . e_ij)|,  K = 1 unless theta is exactly 0
+		theta = atan2Upper512(_mm512_abs_ps(_mm512_fmsub_ps(t_ijX, e_ijY, _mm512_mul_ps(t_ijY, e_ijX))),
+							  _mm512_fmadd_ps(t_ijX, e_ijX, _mm512_mul_ps(t_ijY, e_ijY)));
+		K = _mm512_cmp_ps_mask(theta, zero, _CMP_NEQ_OQ);
+
+		// f_v = -A * exp(-distance_ij / B - (n_prime * B * theta)^2),  f_theta = -A * K * exp(-distance_ij / B - (n * B * theta)^2)
+		decay = _mm512_div_ps(distance, B);
+		angle_v = _mm512_mul_ps(_mm512_mul_ps(n_prime, B), theta);
+		angle_theta = _mm512_mul_ps(_mm512_mul_ps(n, B), theta);
+		f_v = _mm512_mul_ps(minusA, exp512(_mm512_fnmadd_ps(angle_v, angle_v, _mm512_sub_ps(zero, decay))));
+		f_theta = _mm512_maskz_mul_ps(K, minusA, exp512(_mm512_fnmadd_ps(angle_theta, angle_theta, _mm512_sub_ps(zero, decay))));
+
+		// f_ij = f_v * t_ij + f_theta * n_ij  where n_ij = (-t_ij.y, t_ij.x)
+		sumX = _mm512_add_ps(sumX, _mm512_fmsub_ps(f_v, t_ijX, _mm512_mul_ps(f_theta, t_ijY)));
+		sumY = _mm512_add_ps(sumY, _mm512_fmadd_ps(f_v, t_ijY, _mm512_mul_ps(f_theta, t_ijX)));
+	}
+
+	forceX = _mm512_reduce_add_ps(sumX);
+	forceY = _mm512_reduce_add_ps(sumY);
+}
+
+TARGET_AVX512 void interactAVX512Fast(const NeighbourBatch &batch, const InteractionParams &params, float &forceX, float &forceY) {
+	const __m512 lambda = _mm512_set1_ps(params.lambda), gamma = _mm512_set1_ps(params.gamma), minusA = _mm512_set1_ps(-params.A);
+	const __m512 n_primeSquared = _mm512_set1_ps(params.n_prime * params.n_prime), nSquared = _mm512_set1_ps(params.n * params.n);
+	const __m512 zero = _mm512_setzero_ps();
+	__m512 sumX = zero, sumY = zero;
+	__m512 distanceX, distanceY, distanceSquared, inverseDistance, e_ijX, e_ijY, D_ijX, D_ijY, D_ijSquared, inverseLength, t_ijX, t_ijY;
+	__m512 B, theta, decay, spread, f_v, f_theta;
+	__mmask16 K;
+
+	for (size_t idx = 0; idx < batch.count; idx += 16) {
+		distanceX = _mm512_loadu_ps(&batch.distanceX[idx]);
+		distanceY = _mm512_loadu_ps(&batch.distanceY[idx]);
+
+		// e_ij = (position_j - position_i) / ||position_j - position_i||
+		distanceSquared = _mm512_fmadd_ps(distanceX, distanceX, _mm512_mul_ps(distanceY, distanceY));
+		inverseDistance = rsqrt512(distanceSquared);
+		e_ijX = _mm512_mul_ps(distanceX, inverseDistance);
+		e_ijY = _mm512_mul_ps(distanceY, inverseDistance);
+
+		// D = lambda * (velocity_i - velocity_j) + e_ij,  B = gamma * ||D_ij||,  t_ij = D_ij / ||D_ij||
+		D_ijX = _mm512_fmadd_ps(lambda, _mm512_loadu_ps(&batch.velocityX[idx]), e_ijX);
+		D_ijY = _mm512_fmadd_ps(lambda, _mm512_loadu_ps(&batch.velocityY[idx]), e_ijY);
+		D_ijSquared = _mm512_fmadd_ps(D_ijX, D_ijX, _mm512_mul_ps(D_ijY, D_ijY));
+		inverseLength = rsqrt512(D_ijSquared);
+		B = _mm512_mul_ps(gamma, _mm512_mul_ps(D_ijSquared, inverseLength));
+		t_ijX = _mm512_mul_ps(D_ijX, inverseLength);
+		t_ijY = _mm512_mul_ps(D_ijY, inverseLength);
+
+		// theta = |atan2(||t_ij x e_ij||, t_ij . e_ij)|,  K = 1 unless theta is exactly 0
+		theta = atan2Upper512Fast(_mm512_abs_ps(_mm512_fmsub_ps(t_ijX, e_ijY, _mm512_mul_ps(t_ijY, e_ijX))),
+								  _mm512_fmadd_ps(t_ijX, e_ijX, _mm512_mul_ps(t_ijY, e_ijY)));
+		K = _mm512_cmp_ps_mask(theta, zero, _CMP_NEQ_OQ);
+
+		// Both Exponents Share -distance_ij / B and (B * theta)^2
+		decay = _mm512_mul_ps(_mm512_mul_ps(distanceSquared, inverseDistance), reciprocal512(B));
+		spread = _mm512_mul_ps(B, theta);
+		spread = _mm512_mul_ps(spread, spread);
+		f_v = _mm512_mul_ps(minusA, exp512Fast(_mm512_fnmadd_ps(n_primeSquared, spread, _mm512_sub_ps(zero, decay))));
+		f_theta = _mm512_maskz_mul_ps(K, minusA, exp512Fast(_mm512_fnmadd_ps(nSquared, spread, _mm512_sub_ps(zero, decay))));
+
+		// f_ij = f_v * t_ij + f_theta * n_ij  where n_ij = (-t_ij.y, t_ij.x)
+		sumX = _mm512_add_ps(sumX, _mm512_fmsub_ps(f_v, t_ijX, _mm512_mul_ps(f_theta, t_ijY)));
+		sumY = _mm512_add_ps(sumY, _mm512_fmadd_ps(f_v, t_ijY, _mm512_mul_ps(f_theta, t_ijX)));
+	}
+
+	forceX = _mm512_reduce_add_ps(sumX);
+	forceY = _mm512_reduce_add_ps(sumY);
+}
+
+#else
+
+// No x86 Vector Units, 'getInteractionKernel()' Never Selects This Path
+void interactAVX512(const NeighbourBatch &batch, const InteractionParams &params, float &forceX, float &forceY) {
+	interactScalar(batch, params, forceX, forceY);
+}
+
+void interactAVX512Fast(const NeighbourBatch &batch, const InteractionParams &params, float &forceX, float &forceY) {
+	interactScalarFast(batch, params, forceX, forceY);
+}
+
+#endif
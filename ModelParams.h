@@ -0,0 +1,57 @@
+#ifndef MODEL_PARAMS_H
+#define MODEL_PARAMS_H
+
+// Parameter Policies of 'BasicForceModel'  Force code reads every constant as 'params.name', so one code path either folds
+// compile-time constants ('MoussaidParams') or loads run-time values ('RuntimeParams')
+// 'Scalar' is the precision forces are computed in, agent state stays float either way
+
+// Calibration of (Moussaid et al., 2009), Fixed at Compile Time
+template <typename Real>
+struct MoussaidParams {
+	typedef Real Scalar;
+
+	static constexpr Real lambda = Real(2.0);		// Weight reflecting relative importance of velocity vector against position vector
+	static constexpr Real gamma = Real(0.35);		// Speed interaction
+	static constexpr Real n_prime = Real(3.0);		// Angular interaction
+	static constexpr Real n = Real(2.0);			// Angular interaction
+	static constexpr Real A = Real(4.5);			// Modal parameter A
+	static constexpr Real T = Real(0.54);			// Relaxation time of the driving force
+	static constexpr Real wallA = Real(3.0);		// Wall repulsion strength
+	static constexpr Real wallB = Real(0.1);		// Wall repulsion range
+	static constexpr float interactionRange = 2.0F;	// Agents farther apart than this do not interact
+	static constexpr float wallRange = 2.0F;		// f_iw has decayed below 1e-7 here for agents of radius 0.2
+
+	static const char *name() { return sizeof(Real) == sizeof(float) ? "moussaid" : "moussaid-double"; }
+};
+
+// Definitions for Uses that Take the Address, e.g. Binding to a Reference
+template <typename Real> constexpr Real MoussaidParams<Real>::lambda;
+template <typename Real> constexpr Real MoussaidParams<Real>::gamma;
+template <typename Real> constexpr Real MoussaidParams<Real>::n_prime;
+template <typename Real> constexpr Real MoussaidParams<Real>::n;
+template <typename Real> constexpr Real MoussaidParams<Real>::A;
+template <typename Real> constexpr Real MoussaidParams<Real>::T;
+template <typename Real> constexpr Real MoussaidParams<Real>::wallA;
+template <typename Real> constexpr Real MoussaidParams<Real>::wallB;
+template <typename Real> constexpr float MoussaidParams<Real>::interactionRange;
+template <typename Real> constexpr float MoussaidParams<Real>::wallRange;
+
+// Same Constants Set at Run Time, for Calibration Sweeps  Starts from the compile-time calibration
+template <typename Real>
+struct RuntimeParams {
+	typedef Real Scalar;
+	typedef MoussaidParams<Real> Defaults;
+
+	Real lambda, gamma, n_prime, n, A;
+	Real T;
+	Real wallA, wallB;
+	float interactionRange, wallRange;
+
+	RuntimeParams() : lambda(Defaults::lambda), gamma(Defaults::gamma), n_prime(Defaults::n_prime), n(Defaults::n), A(Defaults::A),
+					  T(Defaults::T), wallA(Defaults::wallA), wallB(Defaults::wallB),
+					  interactionRange(Defaults::interactionRange), wallRange(Defaults::wallRange) {}
+
+	static const char *name() { return sizeof(Real) == sizeof(float) ? "runtime" : "runtime-double"; }
+};
+
+#endif
@@ -0,0 +1,33 @@
+#include <climits>
+#include <mpi.h>
+#include "MpiTransport.h"
+using namespace std;
+
+const int EXCHANGE_TAG = 7071;
+
+MpiTransport::MpiTransport(int *argc, char ***argv) {
+	MPI_Init(argc, argv);
+	MPI_Comm_rank(MPI_COMM_WORLD, &rank);
+	MPI_Comm_size(MPI_COMM_WORLD, &numRanks);
+}
+
+MpiTransport::~MpiTransport() {
+	MPI_Finalize();
+}
+
+bool MpiTransport::exchange(int rank, const vector<char> &outgoing, vector<char> &incoming) {
+	unsigned long long sendSize = outgoing.size(), receiveSize = 0;
+
+	if (rank < 0 || rank >= numRanks || rank == this->rank || outgoing.size() > INT_MAX)
+		return false;
+
+	// Sizes First, Then Bytes  'MPI_Sendrecv' cannot deadlock on either
+	if (MPI_Sendrecv(&sendSize, 1, MPI_UNSIGNED_LONG_LONG, rank, EXCHANGE_TAG, &receiveSize, 1, MPI_UNSIGNED_LONG_LONG, rank, EXCHANGE_TAG,
+					 MPI_COMM_WORLD, MPI_STATUS_IGNORE) != MPI_SUCCESS || receiveSize > INT_MAX)
+		return false;
+
+	incoming.resize(receiveSize);
+
+	return MPI_Sendrecv(outgoing.data(), static_cast<int>(sendSize), MPI_CHAR, rank, EXCHANGE_TAG, incoming.data(), static_cast<int>(receiveSize),
+						MPI_CHAR, rank, EXCHANGE_TAG, MPI_COMM_WORLD, MPI_STATUS_IGNORE) == MPI_SUCCESS;
+}
@@ -0,0 +1,24 @@
+#ifndef MPI_TRANSPORT_H
+#define MPI_TRANSPORT_H
+
+#include "Transport.h"
+
+// Ranks of an MPI Job  Built with the SFM_WITH_MPI CMake option, launch with 'mpirun'
+class MpiTransport : public Transport {
+private:
+	int rank, numRanks;
+
+public:
+	MpiTransport(int *argc, char ***argv);		// Initialises MPI, one instance per process
+	~MpiTransport();							// Finalises MPI
+
+	MpiTransport(const MpiTransport &) = delete;
+	MpiTransport &operator=(const MpiTransport &) = delete;
+
+	int getRank() const { return rank; }
+	int getNumRanks() const { return numRanks; }
+	bool exchange(int rank, const std::vector<char> &outgoing, std::vector<char> &incoming);
+	const char *getName() const { return "mpi"; }
+};
+
+#endif
@@ -0,0 +1,186 @@
+#include <algorithm>
+#include <cmath>
+#include "Navigation.h"
+using namespace std;
+
+const float NAVIGATION_MARGIN = 2.0F;			// Grid extends this far beyond walls and targets
+const size_t MAX_NAVIGATION_CELLS = 1 << 22;	// Cells are enlarged if the grid would exceed this
+const size_t ROWS_PER_CHUNK = 16;				// Grid rows rasterised at once by a worker thread
+
+static bool sameTarget(const Waypoint &first, const Waypoint &second) {
+	return first.position.x == second.position.x && first.position.y == second.position.y && first.radius == second.radius;
+}
+
+Navigation::Navigation() {
+	cellSize = 0.25F;
+	clearance = 0.3F;
+	gridValid = false;
+	wallsChanged = false;
+	numBuilds = numUpdates = 0;
+}
+
+void Navigation::setCellSize(float cellSize) {
+	this->cellSize = max(cellSize, 0.05F);
+	gridValid = false;
+}
+
+void Navigation::setClearance(float clearance) {
+	this->clearance = max(clearance, 0.0F);
+	gridValid = false;
+}
+
+bool Navigation::resize(const vector<Waypoint> &targets, const vector<Wall *> &walls) {
+	float minX = INFINITY, minY = INFINITY, maxX = -INFINITY, maxY = -INFINITY, size;
+	size_t neededCells;
+
+	// Bounding Box of Walls and Targets
+	for (const Wall *wall : walls) {
+		minX = min(minX, wall->getBoundsMin().x);
+		minY = min(minY, wall->getBoundsMin().y);
+		maxX = max(maxX, wall->getBoundsMax().x);
+		maxY = max(maxY, wall->getBoundsMax().y);
+	}
+
+	for (const Waypoint &target : targets) {
+		minX = min(minX, target.position.x - target.radius);
+		minY = min(minY, target.position.y - target.radius);
+		maxX = max(maxX, target.position.x + target.radius);
+		maxY = max(maxY, target.position.y + target.radius);
+	}
+
+	minX -= NAVIGATION_MARGIN;
+	minY -= NAVIGATION_MARGIN;
+	maxX += NAVIGATION_MARGIN;
+	maxY += NAVIGATION_MARGIN;
+
+	// Keep Grid While It Covers the Box Without Being Much Larger
+	if (gridValid) {
+		neededCells = static_cast<size_t>((maxX - minX) / grid.cellSize + 1) * static_cast<size_t>((maxY - minY) / grid.cellSize + 1);
+
+		if (minX >= grid.originX && minY >= grid.originY && maxX <= grid.originX + grid.numCols * grid.cellSize &&
+			maxY <= grid.originY + grid.numRows * grid.cellSize && grid.size() <= 4 * neededCells)
+			return false;
+	}
+
+	size = cellSize;
+
+	for (;;) {
+		grid.numCols = static_cast<int>((maxX - minX) / size) + 1;
+		grid.numRows = static_cast<int>((maxY - minY) / size) + 1;
+
+		if (static_cast<size_t>(grid.numCols) * grid.numRows <= MAX_NAVIGATION_CELLS)
+			break;
+
+		size *= 2.0F;
+	}
+
+	grid.cellSize = size;
+	grid.originX = minX;
+	grid.originY = minY;
+	grid.blocked.assign(static_cast<size_t>(grid.numCols) * grid.numRows, 0);
+	gridValid = true;
+
+	return true;
+}
+
+void Navigation::rasterise(const WallIndex &wallIndex, ThreadPool &pool) {
+	const float limit = min(clearance, wallIndex.getRange());	// 'wallIndex' finds no wall beyond its range
+
+	blocked.assign(grid.size(), 0);
+
+	// A Cell is Blocked if Its Centre Lies Within 'limit' of a Wall
+	auto fill = [&](size_t begin, size_t end, int) {
+		float vectorX, vectorY, distanceSquared;
+
+		for (size_t row = begin; row < end; row++) {
+			float y = grid.originY + (row + 0.5F) * grid.cellSize;
+
+			for (int col = 0; col < grid.numCols; col++) {
+				float x = grid.originX + (col + 0.5F) * grid.cellSize;
+
+				if (wallIndex.nearest(x, y, vectorX, vectorY, distanceSquared) && distanceSquared < limit * limit)
+					blocked[row * grid.numCols + col] = 1;
+			}
+		}
+	};
+
+	pool.parallelFor(grid.numRows, ROWS_PER_CHUNK, fill);
+}
+
+void Navigation::update(const vector<Waypoint> &targets, const vector<Wall *> &walls, const WallIndex &wallIndex, ThreadPool &pool) {
+	bool targetsChanged = fields.size() != targets.size();
+
+	for (size_t idx = 0; !targetsChanged && idx < fields.size(); idx++)
+		targetsChanged = !sameTarget(fields[idx].getTarget(), targets[idx]);
+
+	if (!targetsChanged && !wallsChanged && gridValid)
+		return;
+
+	// Nothing to Navigate To  Grid is laid out again once targets are added
+	if (targets.empty()) {
+		fields.clear();
+		gridValid = false;
+		wallsChanged = false;
+		return;
+	}
+
+	changedCells.clear();
+
+	if (resize(targets, walls)) {
+		rasterise(wallIndex, pool);
+		grid.blocked.swap(blocked);
+		fields.clear();		// Laid out on the old grid
+	}
+
+	// Compare Cells With the Previous Walls, Fields Only Revisit Those That Flipped
+	else if (wallsChanged) {
+		rasterise(wallIndex, pool);
+
+		for (size_t cell = 0; cell < grid.size(); cell++) {
+			if (blocked[cell] != grid.blocked[cell])
+				changedCells.push_back(cell);
+		}
+
+		grid.blocked.swap(blocked);
+	}
+
+	wallsChanged = false;
+
+	// Fields of Moved Targets Start Over
+	if (fields.size() > targets.size())
+		fields.erase(fields.begin() + targets.size(), fields.end());
+
+	for (size_t idx = 0; idx < fields.size(); idx++) {
+		if (!sameTarget(fields[idx].getTarget(), targets[idx]))
+			fields[idx] = FlowField(targets[idx]);
+	}
+
+	for (size_t idx = fields.size(); idx < targets.size(); idx++)
+		fields.push_back(FlowField(targets[idx]));
+
+	for (const FlowField &field : fields) {
+		if (!field.isBuilt())
+			numBuilds++;
+		else if (!changedCells.empty())
+			numUpdates++;
+	}
+
+	// Dijkstra is Sequential, So Each Worker Takes Whole Fields
+	auto buildFields = [&](size_t begin, size_t end, int) {
+		for (size_t idx = begin; idx < end; idx++) {
+			if (!fields[idx].isBuilt())
+				fields[idx].build(grid);
+			else if (!changedCells.empty())
+				fields[idx].update(grid, changedCells);
+		}
+	};
+
+	pool.parallelFor(fields.size(), 1, buildFields);
+}
+
+float Navigation::getDistance(int target, float x, float y) const {
+	if (target < 0 || static_cast<size_t>(target) >= fields.size() || !fields[target].isBuilt())
+		return INFINITY;
+
+	return fields[target].getDistance(grid, x, y);
+}
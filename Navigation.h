@@ -0,0 +1,57 @@
+#ifndef NAVIGATION_H
+#define NAVIGATION_H
+
+#include <cstddef>
+#include <vector>
+#include "CrowdState.h"
+#include "FlowField.h"
+#include "ThreadPool.h"
+#include "Wall.h"
+#include "WallIndex.h"
+
+// Flow Fields to the Shared Targets of 'CrowdState', Cached Until Walls or Targets Change
+// Fields are built in parallel, one per worker  After a wall change only cells whose shortest path changed are recomputed
+class Navigation {
+private:
+	NavigationGrid grid;
+	std::vector<FlowField> fields;		// One per entry of 'CrowdState::targets'
+	std::vector<unsigned char> blocked;	// Cells blocked by the current walls, compared with 'grid' to find changes
+	std::vector<int> changedCells;
+
+	float cellSize;
+	float clearance;					// Cells closer than this to a wall are avoided
+	bool gridValid;						// False once settings change or the grid no longer covers walls and targets
+	bool wallsChanged;
+	unsigned long long numBuilds, numUpdates;	// Full field builds and incremental updates
+
+	void rasterise(const WallIndex &wallIndex, ThreadPool &pool);	// Fills 'blocked'
+	bool resize(const std::vector<Waypoint> &targets, const std::vector<Wall *> &walls);	// True if the grid had to change
+
+public:
+	Navigation();
+
+	void setCellSize(float cellSize);		// Default 0.25 m
+	void setClearance(float clearance);		// Default 0.3 m, limited to the wall range of the force model
+	float getCellSize() const { return cellSize; }
+	float getClearance() const { return clearance; }
+
+	void invalidateWalls() { wallsChanged = true; }
+
+	// Builds Missing Fields and Updates Fields After Wall Changes  Cheap when nothing changed
+	// 'wallIndex' must have been built from 'walls'
+	void update(const std::vector<Waypoint> &targets, const std::vector<Wall *> &walls, const WallIndex &wallIndex, ThreadPool &pool);
+
+	// Direction Towards 'target' Around Walls  False outside the grid, inside the target and where it cannot be reached
+	bool sample(int target, float x, float y, float &directionX, float &directionY) const {
+		return target >= 0 && static_cast<size_t>(target) < fields.size() && fields[target].isBuilt() &&
+			   fields[target].sample(grid, x, y, directionX, directionY);
+	}
+
+	float getDistance(int target, float x, float y) const;	// Walking distance, INFINITY if unknown
+	const NavigationGrid &getGrid() const { return grid; }
+	size_t getNumFields() const { return fields.size(); }
+	unsigned long long getNumBuilds() const { return numBuilds; }
+	unsigned long long getNumUpdates() const { return numUpdates; }
+};
+
+#endif
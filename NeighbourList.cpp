@@ -0,0 +1,122 @@
+#include <algorithm>
+#include "NeighbourList.h"
+using namespace std;
+
+const size_t AGENTS_PER_BUILD_CHUNK = 256;
+
+NeighbourList::NeighbourList() {
+	skin = 0.3F;
+	valid = false;
+	numBuilds = 0;
+	maxNeighbours = 0;
+
+	offsets.assign(1, 0);
+}
+
+void NeighbourList::setSkin(float skin) {
+	this->skin = max(skin, 0.0F);
+	valid = false;
+}
+
+bool NeighbourList::needsRebuild(const CrowdState &crowd) const {
+	const float limit = 0.25F * skin * skin;	// (skin / 2)^2
+	float displacementX, displacementY;
+
+	if (!valid || skin <= 0.0F || builtX.size() != crowd.size())
+		return true;
+
+	// Two Agents Each Moving Less Than Half the Skin Cannot Close the Skin Between Them
+	for (size_t idx = 0; idx < crowd.size(); idx++) {
+		displacementX = crowd.positionX[idx] - builtX[idx];
+		displacementY = crowd.positionY[idx] - builtY[idx];
+
+		if (displacementX * displacementX + displacementY * displacementY > limit)
+			return true;
+	}
+
+	return false;
+}
+
+void NeighbourList::build(const CrowdState &crowd, const SpatialGrid &grid, float cutoff, ThreadPool &pool) {
+	const float rangeSquared = (cutoff + skin) * (cutoff + skin);
+	size_t numChunks = (crowd.size() + AGENTS_PER_BUILD_CHUNK - 1) / AGENTS_PER_BUILD_CHUNK;
+
+	candidates.resize(pool.getNumThreads());
+	workerNeighbours.resize(pool.getNumThreads());
+	chunks.resize(numChunks);
+	offsets.resize(crowd.size() + 1);
+	offsets[0] = 0;
+
+	for (vector<int> &buffer : workerNeighbours)
+		buffer.clear();		// Keeps capacity, no reallocation once warmed up
+
+	// Collect Neighbours of Each Chunk Into the Claiming Worker's Buffer, Counting Them per Agent
+	auto collect = [&](size_t begin, size_t end, int worker) {
+		vector<int> &candidate = candidates[worker];
+		vector<int> &buffer = workerNeighbours[worker];
+
+		// Small crowds arrive as one range on the calling thread, so record every chunk inside it
+		for (size_t idx = begin; idx < end; idx++) {
+			const float positionX = crowd.positionX[idx], positionY = crowd.positionY[idx];
+			size_t count = buffer.size();
+
+			if (idx % AGENTS_PER_BUILD_CHUNK == 0) {
+				chunks[idx / AGENTS_PER_BUILD_CHUNK].worker = worker;
+				chunks[idx / AGENTS_PER_BUILD_CHUNK].start = count;
+			}
+
+			candidate.clear();
+			grid.query(positionX, positionY, candidate);
+
+			for (int j : candidate) {
+				float distanceX = crowd.positionX[j] - positionX, distanceY = crowd.positionY[j] - positionY;
+
+				if (static_cast<size_t>(j) != idx && distanceX * distanceX + distanceY * distanceY <= rangeSquared)
+					buffer.push_back(j);
+			}
+
+			offsets[idx + 1] = buffer.size() - count;
+		}
+	};
+
+	pool.parallelFor(crowd.size(), AGENTS_PER_BUILD_CHUNK, collect);
+
+	// Convert Counts into Row Offsets
+	maxNeighbours = 0;
+
+	for (size_t idx = 1; idx <= crowd.size(); idx++) {
+		maxNeighbours = max(maxNeighbours, offsets[idx]);
+		offsets[idx] += offsets[idx - 1];
+	}
+
+	neighbours.resize(offsets[crowd.size()]);
+
+	// Move Each Chunk's Rows Into Place  Rows of a chunk are contiguous in both buffers
+	auto gather = [&](size_t begin, size_t end, int) {
+		for (size_t chunkIdx = begin; chunkIdx < end; chunkIdx++) {
+			size_t first = chunkIdx * AGENTS_PER_BUILD_CHUNK, last = min(first + AGENTS_PER_BUILD_CHUNK, crowd.size());
+			const ChunkSource &chunk = chunks[chunkIdx];
+
+			copy(workerNeighbours[chunk.worker].begin() + chunk.start,
+				 workerNeighbours[chunk.worker].begin() + chunk.start + (offsets[last] - offsets[first]),
+				 neighbours.begin() + offsets[first]);
+		}
+	};
+
+	pool.parallelFor(numChunks, 16, gather);
+
+	// Any Worker May Claim Every Chunk Next Time, so Each Buffer Gets Room for Every Row  Pages it never fills stay untouched
+	for (vector<int> &buffer : workerNeighbours) {
+		if (buffer.capacity() < neighbours.size())
+			buffer.reserve(max(neighbours.size(), 2 * buffer.capacity()));
+	}
+
+	// Resized Rather Than Assigned, so a Growing Crowd Reallocates Geometrically
+	builtX.resize(crowd.size());
+	builtY.resize(crowd.size());
+	copy(crowd.positionX.begin(), crowd.positionX.end(), builtX.begin());
+	copy(crowd.positionY.begin(), crowd.positionY.end(), builtY.begin());
+
+	valid = true;
+	numBuilds++;
+}
@@ -0,0 +1,50 @@
+#ifndef NEIGHBOUR_LIST_H
+#define NEIGHBOUR_LIST_H
+
+#include <cstddef>
+#include <vector>
+#include "CrowdState.h"
+#include "SpatialGrid.h"
+#include "ThreadPool.h"
+
+// Verlet Neighbour List  Agents within 'cutoff + skin' of each agent, kept until some agent has moved more than 'skin / 2'
+// Stored as compressed sparse rows: neighbours of agent i are 'neighbours[offsets[i]]' to 'neighbours[offsets[i + 1] - 1]'
+class NeighbourList {
+private:
+	// Where the Rows of One Build Chunk Were Collected
+	struct ChunkSource {
+		int worker;
+		size_t start;			// Offset in 'workerNeighbours[worker]'
+	};
+
+	float skin;
+	bool valid;							// False after changes to the crowd that moving agents cannot explain
+	unsigned long long numBuilds;
+	size_t maxNeighbours;				// Longest row of the last build
+
+	std::vector<size_t> offsets;
+	std::vector<int> neighbours;
+	std::vector<float> builtX, builtY;	// Positions at the last build
+	std::vector<std::vector<int> > candidates;			// Grid query results, one per worker thread
+	std::vector<std::vector<int> > workerNeighbours;	// Rows collected by each worker thread
+	std::vector<ChunkSource> chunks;
+
+public:
+	NeighbourList();
+
+	void setSkin(float skin);			// 0 rebuilds every step
+	float getSkin() const { return skin; }
+	unsigned long long getNumBuilds() const { return numBuilds; }
+	size_t getMaxNeighbours() const { return maxNeighbours; }
+
+	void invalidate() { valid = false; }	// Call when agents are added, removed or reordered  Moves are detected
+	bool needsRebuild(const CrowdState &crowd) const;
+
+	// 'grid' must have been built from 'crowd' with cells of at least 'cutoff + skin'
+	void build(const CrowdState &crowd, const SpatialGrid &grid, float cutoff, ThreadPool &pool);
+
+	const int *getNeighbours(size_t idx) const { return neighbours.data() + offsets[idx]; }
+	size_t getNumNeighbours(size_t idx) const { return offsets[idx + 1] - offsets[idx]; }
+};
+
+#endif
@@ -0,0 +1,233 @@
+#include <algorithm>
+#include "Profiler.h"
+#include "SocialForce.h"
+using namespace std;
+
+const char *PHASE_NAMES[NUM_PROFILE_PHASES] = { "neighbour_search", "driving", "agent_interaction", "wall_interaction", "integration" };
+
+atomic<unsigned long long> Profiler::numAllocations(0), Profiler::numAllocatedBytes(0);
+
+static double elapsedSeconds(Profiler::Clock::time_point start, Profiler::Clock::time_point end) {
+	return chrono::duration<double>(end - start).count();
+}
+
+void StepProfile::reset() {
+	step = 0;
+	time = totalTime = 0.0;
+
+	for (int phase = 0; phase < NUM_PROFILE_PHASES; phase++) {
+		phaseTime[phase] = 0.0;
+		imbalance[phase] = 0.0F;
+	}
+
+	for (int counter = 0; counter < NUM_PROFILE_COUNTERS; counter++)
+		counters[counter] = 0;
+
+	pairsConsidered = pairsWithinRange = 0;
+	neighbourRebuilds = 0;
+	allocations = allocatedBytes = 0;
+}
+
+Profiler::Profiler() {
+	origin = stepStart = Clock::now();
+	allocationsAtStart = bytesAtStart = 0;
+	numSteps = 0;
+
+	jsonFile = traceFile = 0;
+	firstTraceEvent = true;
+}
+
+Profiler::~Profiler() {
+	close();
+}
+
+bool Profiler::openJson(const char *path) {
+	if (jsonFile)
+		fclose(jsonFile);
+
+	jsonFile = fopen(path, "w");
+	return jsonFile != 0;
+}
+
+bool Profiler::openTrace(const char *path) {
+	if (traceFile)
+		fclose(traceFile);
+
+	traceFile = fopen(path, "w");
+	firstTraceEvent = true;
+
+	if (!traceFile)
+		return false;
+
+	fprintf(traceFile, "{\"traceEvents\":[\n");
+	return true;
+}
+
+bool Profiler::close() {
+	bool succeeded = true;
+
+	if (jsonFile) {
+		succeeded = !ferror(jsonFile) && succeeded;
+		succeeded = (fclose(jsonFile) == 0) && succeeded;
+		jsonFile = 0;
+	}
+
+	if (traceFile) {
+		fprintf(traceFile, "\n]}\n");
+		succeeded = !ferror(traceFile) && succeeded;
+		succeeded = (fclose(traceFile) == 0) && succeeded;
+		traceFile = 0;
+	}
+
+	return succeeded;
+}
+
+void Profiler::beginStep(int numThreads) {
+	slots.resize(max(numThreads, 1));
+
+	for (WorkerSlot &slot : slots) {
+		for (int phase = 0; phase < NUM_PROFILE_PHASES; phase++) {
+			slot.busy[phase] = 0.0;
+			slot.active[phase] = false;
+		}
+
+		for (int counter = 0; counter < NUM_PROFILE_COUNTERS; counter++)
+			slot.counters[counter] = 0;
+	}
+
+	allocationsAtStart = getAllocations();
+	bytesAtStart = getAllocatedBytes();
+	stepStart = Clock::now();
+}
+
+void Profiler::addBusy(ProfilePhase phase, int worker, Clock::time_point start, Clock::time_point end) {
+	WorkerSlot &slot = slots[worker];
+	int phaseIdx = static_cast<int>(phase);
+
+	slot.busy[phaseIdx] += elapsedSeconds(start, end);
+
+	if (!slot.active[phaseIdx]) {
+		slot.spanStart[phaseIdx] = start;
+		slot.active[phaseIdx] = true;
+	}
+
+	slot.spanEnd[phaseIdx] = end;
+}
+
+void Profiler::endStep(unsigned long long step, double time, const StepStats &stats) {
+	Clock::time_point stepEnd = Clock::now();
+	double maxBusy, sumBusy;
+
+	last.reset();
+	last.step = step;
+	last.time = time;
+	last.totalTime = stats.totalTime;
+	last.phaseTime[static_cast<int>(ProfilePhase::NeighbourSearch)] = stats.neighbourSearchTime;
+	last.phaseTime[static_cast<int>(ProfilePhase::Driving)] = stats.drivingTime;
+	last.phaseTime[static_cast<int>(ProfilePhase::AgentInteract)] = stats.agentInteractTime;
+	last.phaseTime[static_cast<int>(ProfilePhase::WallInteract)] = stats.wallInteractTime;
+	last.phaseTime[static_cast<int>(ProfilePhase::Integration)] = stats.integrationTime;
+	last.pairsConsidered = stats.pairsConsidered;
+	last.pairsWithinRange = stats.pairsWithinRange;
+	last.neighbourRebuilds = stats.neighbourListRebuilt ? 1 : 0;
+	last.allocations = getAllocations() - allocationsAtStart;
+	last.allocatedBytes = getAllocatedBytes() - bytesAtStart;
+
+	// Idle Workers Count Towards the Mean, So a Phase Left to One Thread Shows as Imbalanced  Neighbour search is timed as a whole
+	last.imbalance[static_cast<int>(ProfilePhase::NeighbourSearch)] = 1.0F;
+
+	for (int phase = static_cast<int>(ProfilePhase::Driving); phase < NUM_PROFILE_PHASES; phase++) {
+		maxBusy = sumBusy = 0.0;
+
+		for (const WorkerSlot &slot : slots) {
+			maxBusy = max(maxBusy, slot.busy[phase]);
+			sumBusy += slot.busy[phase];
+		}
+
+		last.imbalance[phase] = (sumBusy > 0.0) ? static_cast<float>(maxBusy * slots.size() / sumBusy) : 1.0F;
+	}
+
+	for (const WorkerSlot &slot : slots) {
+		for (int counter = 0; counter < NUM_PROFILE_COUNTERS; counter++)
+			last.counters[counter] += slot.counters[counter];
+	}
+
+	// Running Totals
+	totals.step = step;
+	totals.time = time;
+	totals.totalTime += last.totalTime;
+
+	for (int phase = 0; phase < NUM_PROFILE_PHASES; phase++) {
+		totals.phaseTime[phase] += last.phaseTime[phase];
+		totals.imbalance[phase] = max(totals.imbalance[phase], last.imbalance[phase]);
+	}
+
+	for (int counter = 0; counter < NUM_PROFILE_COUNTERS; counter++)
+		totals.counters[counter] += last.counters[counter];
+
+	totals.pairsConsidered += last.pairsConsidered;
+	totals.pairsWithinRange += last.pairsWithinRange;
+	totals.neighbourRebuilds += last.neighbourRebuilds;
+	totals.allocations += last.allocations;
+	totals.allocatedBytes += last.allocatedBytes;
+	numSteps++;
+
+	if (jsonFile)
+		writeJson(last);
+
+	// Step on the Calling Thread, Then Each Worker's Span of Each Phase
+	if (traceFile) {
+		writeTraceEvent("step", 0, stepStart, stepEnd);
+
+		for (size_t worker = 0; worker < slots.size(); worker++) {
+			for (int phase = 0; phase < NUM_PROFILE_PHASES; phase++) {
+				if (slots[worker].active[phase])
+					writeTraceEvent(PHASE_NAMES[phase], worker, slots[worker].spanStart[phase], slots[worker].spanEnd[phase]);
+			}
+		}
+	}
+}
+
+void Profiler::writeJson(const StepProfile &profile) {
+	fprintf(jsonFile, "{\"step\":%llu,\"time\":%.4f,\"step_ms\":%.4f,\"phase_ms\":{", profile.step, profile.time, 1000.0 * profile.totalTime);
+
+	for (int phase = 0; phase < NUM_PROFILE_PHASES; phase++)
+		fprintf(jsonFile, "%s\"%s\":%.4f", (phase > 0) ? "," : "", PHASE_NAMES[phase], 1000.0 * profile.phaseTime[phase]);
+
+	fprintf(jsonFile, "},\"imbalance\":{");
+
+	for (int phase = 0; phase < NUM_PROFILE_PHASES; phase++)
+		fprintf(jsonFile, "%s\"%s\":%.3f", (phase > 0) ? "," : "", PHASE_NAMES[phase], profile.imbalance[phase]);
+
+	fprintf(jsonFile, "},\"pairs_considered\":%llu,\"pairs_within_range\":%llu,\"wall_queries\":%llu,\"neighbour_rebuilds\":%llu,"
+			"\"allocations\":%llu,\"allocated_bytes\":%llu}\n", profile.pairsConsidered, profile.pairsWithinRange,
+			profile.counters[static_cast<int>(ProfileCounter::WallQueries)], profile.neighbourRebuilds, profile.allocations,
+			profile.allocatedBytes);
+}
+
+void Profiler::writeTraceEvent(const char *name, int thread, Clock::time_point start, Clock::time_point end) {
+	// Complete Event, Microseconds Since 'origin'
+	fprintf(traceFile, "%s{\"name\":\"%s\",\"ph\":\"X\",\"pid\":1,\"tid\":%d,\"ts\":%.3f,\"dur\":%.3f}", firstTraceEvent ? "" : ",\n", name, thread,
+			1e6 * elapsedSeconds(origin, start), 1e6 * elapsedSeconds(start, end));
+	firstTraceEvent = false;
+}
+
+const char *Profiler::getPhaseName(ProfilePhase phase) {
+	return PHASE_NAMES[static_cast<int>(phase)];
+}
+
+unsigned long long Profiler::getAllocations() {
+#ifdef SFM_PROFILING
+	return numAllocations.load(memory_order_relaxed);
+#else
+	return 0;
+#endif
+}
+
+unsigned long long Profiler::getAllocatedBytes() {
+#ifdef SFM_PROFILING
+	return numAllocatedBytes.load(memory_order_relaxed);
+#else
+	return 0;
+#endif
+}
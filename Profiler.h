@@ -0,0 +1,142 @@
+#ifndef PROFILER_H
+#define PROFILER_H
+
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <vector>
+
+struct StepStats;
+
+// Phases of 'SocialForce::moveCrowd()'  Every phase but the neighbour search is timed on each worker thread
+enum class ProfilePhase {
+	NeighbourSearch,	// Including wall index and flow fields, on the calling thread
+	Driving,
+	AgentInteract,
+	WallInteract,
+	Integration
+};
+
+const int NUM_PROFILE_PHASES = 5;
+
+enum class ProfileCounter {
+	WallQueries			// Nearest wall lookups
+};
+
+const int NUM_PROFILE_COUNTERS = 1;
+
+// Everything Recorded About One Step
+struct StepProfile {
+	unsigned long long step;
+	double time;							// Simulated seconds at the end of the step
+	double totalTime;						// Seconds
+	double phaseTime[NUM_PROFILE_PHASES];	// Seconds from start to end of each phase
+	float imbalance[NUM_PROFILE_PHASES];	// Busiest worker's time over the mean, 1 is perfect balance
+	unsigned long long pairsConsidered, pairsWithinRange;
+	unsigned long long counters[NUM_PROFILE_COUNTERS];
+	unsigned long long neighbourRebuilds;
+	unsigned long long allocations, allocatedBytes;	// Heap allocations of the whole process during the step
+
+	StepProfile() { reset(); }
+	void reset();
+};
+
+// Per-Step Phase Timers and Counters of 'SocialForce'  Attach with 'SocialForce::setProfiler()'
+// Steps can be streamed as JSON lines and as a Chrome trace (chrome://tracing, Perfetto)
+// Compiled out, hooks included, unless SFM_PROFILING is defined (CMake option of the same name)
+class Profiler {
+public:
+	typedef std::chrono::steady_clock Clock;
+
+private:
+	// Written by One Worker Only During a Step
+	struct WorkerSlot {
+		double busy[NUM_PROFILE_PHASES];
+		Clock::time_point spanStart[NUM_PROFILE_PHASES], spanEnd[NUM_PROFILE_PHASES];	// First and last chunk of each phase
+		bool active[NUM_PROFILE_PHASES];
+		unsigned long long counters[NUM_PROFILE_COUNTERS];
+		char padding[64];		// Keeps slots of different workers off one cache line
+	};
+
+	std::vector<WorkerSlot> slots;
+	Clock::time_point origin;				// Trace timestamps count from here
+	Clock::time_point stepStart;
+	unsigned long long allocationsAtStart, bytesAtStart;
+
+	StepProfile last, totals;				// 'totals' sums every step, its imbalance is the worst seen
+	unsigned long long numSteps;
+
+	FILE *jsonFile, *traceFile;
+	bool firstTraceEvent;
+
+	static std::atomic<unsigned long long> numAllocations, numAllocatedBytes;	// Relaxed, only totals are read
+
+	void writeJson(const StepProfile &profile);
+	void writeTraceEvent(const char *name, int thread, Clock::time_point start, Clock::time_point end);
+
+public:
+	Profiler();
+	~Profiler();
+
+	Profiler(const Profiler &) = delete;
+	Profiler &operator=(const Profiler &) = delete;
+
+	bool openJson(const char *path);		// One JSON object per step and line
+	bool openTrace(const char *path);		// Chrome trace event format
+	bool close();							// False if writing failed
+
+	void beginStep(int numThreads);
+	void endStep(unsigned long long step, double time, const StepStats &stats);
+
+	void addBusy(ProfilePhase phase, int worker, Clock::time_point start, Clock::time_point end);
+	void count(ProfileCounter counter, int worker, unsigned long long amount) { slots[worker].counters[static_cast<int>(counter)] += amount; }
+
+	const StepProfile &getLastStep() const { return last; }
+	const StepProfile &getTotals() const { return totals; }
+	unsigned long long getNumSteps() const { return numSteps; }
+
+	static const char *getPhaseName(ProfilePhase phase);
+	static unsigned long long getAllocations();		// Process-wide, 0 unless SFM_PROFILING is defined and the program links AllocationCounter.cpp
+	static unsigned long long getAllocatedBytes();
+	static void countAllocation(size_t size) {		// Called by the global 'operator new' of AllocationCounter.cpp
+		numAllocations.fetch_add(1, std::memory_order_relaxed);
+		numAllocatedBytes.fetch_add(size, std::memory_order_relaxed);
+	}
+};
+
+// Adds the Time Until It Goes Out of Scope to a Worker's Busy Time  Does nothing without a profiler
+class ProfileScope {
+private:
+	Profiler *profiler;
+	ProfilePhase phase;
+	int worker;
+	Profiler::Clock::time_point start;
+
+public:
+	ProfileScope(Profiler *profiler, ProfilePhase phase, int worker) : profiler(profiler), phase(phase), worker(worker) {
+		if (profiler)
+			start = Profiler::Clock::now();
+	}
+
+	~ProfileScope() {
+		if (profiler)
+			profiler->addBusy(phase, worker, start, Profiler::Clock::now());
+	}
+
+	ProfileScope(const ProfileScope &) = delete;
+	ProfileScope &operator=(const ProfileScope &) = delete;
+};
+
+#ifdef SFM_PROFILING
+#define SFM_PROFILE_CONCAT_(a, b) a##b
+#define SFM_PROFILE_CONCAT(a, b) SFM_PROFILE_CONCAT_(a, b)
+#define SFM_PROFILE_SCOPE(profiler, phase, worker) ProfileScope SFM_PROFILE_CONCAT(profileScope, __LINE__)(profiler, phase, worker)
+#define SFM_PROFILE_COUNT(profiler, counter, worker, amount) do { if (profiler) (profiler)->count(counter, worker, amount); } while (0)
+#define SFM_PROFILE(statement) statement
+#else
+#define SFM_PROFILE_SCOPE(profiler, phase, worker) ((void)0)
+#define SFM_PROFILE_COUNT(profiler, counter, worker, amount) ((void)0)
+#define SFM_PROFILE(statement)
+#endif
+
+#endif
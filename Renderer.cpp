@@ -0,0 +1,295 @@
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include "Renderer.h"
+
+#ifdef FREEGLUT
+#include <GL/freeglut_ext.h>
+#endif
+#include <GL/glext.h>
+
+using namespace std;
+
+const float PI = 3.14159265359F;
+
+// Lit Colour of a Disc Facing the Camera Under the Viewer's Lights
+// Global ambient 0.8 plus diffuse 0.7 * cos(54.7 deg) for light direction (4, -4, 4) and normal (0, 0, 1)
+const float DISC_SHADE = 1.204F;
+
+// Buffer and Shader Functions Beyond OpenGL 1.1, Resolved at Run Time
+static PFNGLGENBUFFERSPROC genBuffers;
+static PFNGLBINDBUFFERPROC bindBuffer;
+static PFNGLBUFFERDATAPROC bufferData;
+static PFNGLBUFFERSUBDATAPROC bufferSubData;
+static PFNGLDELETEBUFFERSPROC deleteBuffers;
+static PFNGLCREATESHADERPROC createShader;
+static PFNGLSHADERSOURCEPROC shaderSource;
+static PFNGLCOMPILESHADERPROC compileShader;
+static PFNGLGETSHADERIVPROC getShaderiv;
+static PFNGLDELETESHADERPROC deleteShader;
+static PFNGLCREATEPROGRAMPROC createProgram;
+static PFNGLATTACHSHADERPROC attachShader;
+static PFNGLLINKPROGRAMPROC linkProgram;
+static PFNGLGETPROGRAMIVPROC getProgramiv;
+static PFNGLDELETEPROGRAMPROC deleteProgram;
+static PFNGLUSEPROGRAMPROC useProgram;
+static PFNGLGETATTRIBLOCATIONPROC getAttribLocation;
+static PFNGLGETUNIFORMLOCATIONPROC getUniformLocation;
+static PFNGLUNIFORM1FPROC uniform1f;
+static PFNGLENABLEVERTEXATTRIBARRAYPROC enableVertexAttribArray;
+static PFNGLDISABLEVERTEXATTRIBARRAYPROC disableVertexAttribArray;
+static PFNGLVERTEXATTRIBPOINTERPROC vertexAttribPointer;
+static PFNGLVERTEXATTRIBDIVISORPROC vertexAttribDivisor;
+static PFNGLDRAWARRAYSINSTANCEDPROC drawArraysInstanced;
+
+// Disc Placed and Scaled per Instance, Shaded Like the Fixed-Function Path
+static const char *VERTEX_SHADER =
+	"#version 120\n"
+	"attribute vec2 vertex;\n"			// Unit disc
+	"attribute vec3 instance;\n"		// x, y, radius
+	"attribute vec3 colour;\n"
+	"varying vec3 shadedColour;\n"
+	"uniform float shade;\n"
+	"void main() {\n"
+	"	gl_Position = gl_ModelViewProjectionMatrix * vec4(instance.xy + vertex * instance.z, 0.0, 1.0);\n"
+	"	shadedColour = min(colour * shade, vec3(1.0));\n"
+	"}\n";
+
+static const char *FRAGMENT_SHADER =
+	"#version 120\n"
+	"varying vec3 shadedColour;\n"
+	"void main() {\n"
+	"	gl_FragColor = vec4(shadedColour, 1.0);\n"
+	"}\n";
+
+template <typename Function>
+static bool loadFunction(Function &function, const char *name) {
+#ifdef FREEGLUT
+	function = reinterpret_cast<Function>(glutGetProcAddress(name));
+#else
+	function = 0;
+	(void) name;
+#endif
+
+	return function != 0;
+}
+
+Renderer::Renderer() {
+	instanced = false;
+	program = 0;
+	discBuffer = instanceBuffer = wallBuffer = 0;
+	discList = 0;
+	vertexLocation = instanceLocation = colourLocation = -1;
+	numDiscVertices = 0;
+	numWallVertices = 0;
+	instanceCapacity = 0;
+}
+
+Renderer::~Renderer() {
+	if (instanced) {
+		deleteBuffers(1, &discBuffer);
+		deleteBuffers(1, &instanceBuffer);
+		deleteBuffers(1, &wallBuffer);
+		deleteProgram(program);
+	}
+
+	if (discList)
+		glDeleteLists(discList, 1);
+}
+
+void Renderer::init(int slices) {
+	vector<float> disc;
+	const char *version;
+	int major = 0, minor = 0;
+
+	// Unit Disc as Triangle Fan: Centre, Then Rim Closed by Repeating the First Rim Point
+	disc.push_back(0.0F);
+	disc.push_back(0.0F);
+
+	for (int slice = 0; slice <= slices; slice++) {
+		disc.push_back(cos(2.0F * PI * slice / slices));
+		disc.push_back(sin(2.0F * PI * slice / slices));
+	}
+
+	numDiscVertices = disc.size() / 2;
+
+	// Display List for the Fallback Path
+	discList = glGenLists(1);
+	glNewList(discList, GL_COMPILE);
+		glNormal3f(0.0, 0.0, 1.0);
+		glBegin(GL_TRIANGLE_FAN);
+			for (GLsizei idx = 0; idx < numDiscVertices; idx++)
+				glVertex2f(disc[2 * idx], disc[2 * idx + 1]);
+		glEnd();
+	glEndList();
+
+	// Instancing Needs OpenGL 3.3 (Vertex Attribute Divisors)
+	version = reinterpret_cast<const char *>(glGetString(GL_VERSION));
+
+	if (!version || sscanf(version, "%d.%d", &major, &minor) != 2 || major * 10 + minor < 33 || !loadFunctions())
+		return;
+
+	program = compileProgram();
+
+	if (!program)
+		return;
+
+	vertexLocation = getAttribLocation(program, "vertex");
+	instanceLocation = getAttribLocation(program, "instance");
+	colourLocation = getAttribLocation(program, "colour");
+
+	useProgram(program);
+	uniform1f(getUniformLocation(program, "shade"), DISC_SHADE);
+	useProgram(0);
+
+	genBuffers(1, &discBuffer);
+	bindBuffer(GL_ARRAY_BUFFER, discBuffer);
+	bufferData(GL_ARRAY_BUFFER, disc.size() * sizeof(float), &disc[0], GL_STATIC_DRAW);
+
+	genBuffers(1, &instanceBuffer);
+	genBuffers(1, &wallBuffer);
+	bindBuffer(GL_ARRAY_BUFFER, 0);
+
+	instanced = true;
+}
+
+void Renderer::setWalls(const vector<float> &segments) {
+	numWallVertices = segments.size() / 2;
+
+	if (!instanced) {
+		wallVertices = segments;
+		return;
+	}
+
+	bindBuffer(GL_ARRAY_BUFFER, wallBuffer);
+	bufferData(GL_ARRAY_BUFFER, segments.size() * sizeof(float), segments.empty() ? 0 : &segments[0], GL_STATIC_DRAW);
+	bindBuffer(GL_ARRAY_BUFFER, 0);
+}
+
+void Renderer::drawAgents(const vector<AgentInstance> &agents) {
+	if (agents.empty())
+		return;
+
+	if (!instanced) {
+		for (const AgentInstance &agent : agents) {
+			glColor3f(agent.red, agent.green, agent.blue);
+			glPushMatrix();
+				glTranslatef(agent.x, agent.y, 0.0);
+				glScalef(agent.radius, agent.radius, 1.0);
+				glCallList(discList);
+			glPopMatrix();
+		}
+
+		return;
+	}
+
+	// Upload Instances  Orphaning the old storage lets the driver keep drawing the previous frame from it
+	bindBuffer(GL_ARRAY_BUFFER, instanceBuffer);
+
+	if (agents.size() > instanceCapacity)
+		instanceCapacity = agents.size() + agents.size() / 2;
+
+	bufferData(GL_ARRAY_BUFFER, instanceCapacity * sizeof(AgentInstance), 0, GL_STREAM_DRAW);
+
+	bufferSubData(GL_ARRAY_BUFFER, 0, agents.size() * sizeof(AgentInstance), &agents[0]);
+
+	useProgram(program);
+
+	enableVertexAttribArray(instanceLocation);
+	vertexAttribPointer(instanceLocation, 3, GL_FLOAT, GL_FALSE, sizeof(AgentInstance), reinterpret_cast<void *>(0));
+	vertexAttribDivisor(instanceLocation, 1);
+
+	enableVertexAttribArray(colourLocation);
+	vertexAttribPointer(colourLocation, 3, GL_FLOAT, GL_FALSE, sizeof(AgentInstance), reinterpret_cast<void *>(3 * sizeof(float)));
+	vertexAttribDivisor(colourLocation, 1);
+
+	bindBuffer(GL_ARRAY_BUFFER, discBuffer);
+	enableVertexAttribArray(vertexLocation);
+	vertexAttribPointer(vertexLocation, 2, GL_FLOAT, GL_FALSE, 0, reinterpret_cast<void *>(0));
+
+	drawArraysInstanced(GL_TRIANGLE_FAN, 0, numDiscVertices, agents.size());
+
+	// Restore State for the Fixed-Function Drawing That Follows
+	vertexAttribDivisor(instanceLocation, 0);
+	vertexAttribDivisor(colourLocation, 0);
+	disableVertexAttribArray(vertexLocation);
+	disableVertexAttribArray(instanceLocation);
+	disableVertexAttribArray(colourLocation);
+	bindBuffer(GL_ARRAY_BUFFER, 0);
+	useProgram(0);
+}
+
+void Renderer::drawWalls() {
+	if (numWallVertices == 0)
+		return;
+
+	if (!instanced) {
+		glBegin(GL_LINES);
+			for (GLsizei idx = 0; idx < numWallVertices; idx++)
+				glVertex2f(wallVertices[2 * idx], wallVertices[2 * idx + 1]);
+		glEnd();
+
+		return;
+	}
+
+	bindBuffer(GL_ARRAY_BUFFER, wallBuffer);
+	glEnableClientState(GL_VERTEX_ARRAY);
+	glVertexPointer(2, GL_FLOAT, 0, reinterpret_cast<void *>(0));
+
+	glDrawArrays(GL_LINES, 0, numWallVertices);
+
+	glDisableClientState(GL_VERTEX_ARRAY);
+	bindBuffer(GL_ARRAY_BUFFER, 0);
+}
+
+bool Renderer::loadFunctions() {
+	return loadFunction(genBuffers, "glGenBuffers") && loadFunction(bindBuffer, "glBindBuffer") &&
+		   loadFunction(bufferData, "glBufferData") && loadFunction(bufferSubData, "glBufferSubData") &&
+		   loadFunction(deleteBuffers, "glDeleteBuffers") && loadFunction(createShader, "glCreateShader") &&
+		   loadFunction(shaderSource, "glShaderSource") && loadFunction(compileShader, "glCompileShader") &&
+		   loadFunction(getShaderiv, "glGetShaderiv") && loadFunction(deleteShader, "glDeleteShader") &&
+		   loadFunction(createProgram, "glCreateProgram") && loadFunction(attachShader, "glAttachShader") &&
+		   loadFunction(linkProgram, "glLinkProgram") && loadFunction(getProgramiv, "glGetProgramiv") &&
+		   loadFunction(deleteProgram, "glDeleteProgram") && loadFunction(useProgram, "glUseProgram") &&
+		   loadFunction(getAttribLocation, "glGetAttribLocation") && loadFunction(getUniformLocation, "glGetUniformLocation") &&
+		   loadFunction(uniform1f, "glUniform1f") && loadFunction(enableVertexAttribArray, "glEnableVertexAttribArray") &&
+		   loadFunction(disableVertexAttribArray, "glDisableVertexAttribArray") && loadFunction(vertexAttribPointer, "glVertexAttribPointer") &&
+		   loadFunction(vertexAttribDivisor, "glVertexAttribDivisor") && loadFunction(drawArraysInstanced, "glDrawArraysInstanced");
+}
+
+GLuint Renderer::compileProgram() {
+	const char *sources[2] = { VERTEX_SHADER, FRAGMENT_SHADER };
+	const GLenum types[2] = { GL_VERTEX_SHADER, GL_FRAGMENT_SHADER };
+	GLuint shaders[2], program;
+	GLint status;
+
+	program = createProgram();
+
+	for (int idx = 0; idx < 2; idx++) {
+		shaders[idx] = createShader(types[idx]);
+		shaderSource(shaders[idx], 1, &sources[idx], 0);
+		compileShader(shaders[idx]);
+		getShaderiv(shaders[idx], GL_COMPILE_STATUS, &status);
+
+		if (status != GL_TRUE) {
+			fprintf(stderr, "Agent shader failed to compile, drawing without instancing\n");
+			deleteShader(shaders[idx]);
+			deleteProgram(program);
+			return 0;
+		}
+
+		attachShader(program, shaders[idx]);
+		deleteShader(shaders[idx]);		// Freed with the program
+	}
+
+	linkProgram(program);
+	getProgramiv(program, GL_LINK_STATUS, &status);
+
+	if (status != GL_TRUE) {
+		fprintf(stderr, "Agent shader failed to link, drawing without instancing\n");
+		deleteProgram(program);
+		return 0;
+	}
+
+	return program;
+}
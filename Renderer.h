@@ -0,0 +1,50 @@
+#ifndef RENDERER_H
+#define RENDERER_H
+
+#include <cstddef>
+#include <vector>
+#include <GL/glut.h>
+
+// Per-Agent Data Uploaded to the Instance Buffer Each Frame
+struct AgentInstance {
+	float x, y;
+	float radius;
+	float red, green, blue;
+};
+
+// Retained-Mode Drawing of Agents and Walls for the Viewer
+// Agents are one shared disc mesh drawn with a single instanced call, walls are one vertex buffer of line segments
+// Without instancing support (OpenGL below 3.3 or a GLUT without 'glutGetProcAddress()') agents fall back to a display list per agent
+class Renderer {
+private:
+	bool instanced;					// Instanced path available
+	GLuint program;
+	GLuint discBuffer;				// Unit disc as triangle fan
+	GLuint instanceBuffer;
+	GLuint wallBuffer;
+	GLuint discList;				// Fallback path
+	std::vector<float> wallVertices;	// Fallback path
+	GLint vertexLocation, instanceLocation, colourLocation;
+	GLsizei numDiscVertices;
+	GLsizei numWallVertices;
+	size_t instanceCapacity;		// Agents the instance buffer can hold without reallocation
+
+	bool loadFunctions();
+	GLuint compileProgram();
+
+public:
+	Renderer();
+	~Renderer();
+
+	Renderer(const Renderer &) = delete;
+	Renderer &operator=(const Renderer &) = delete;
+
+	void init(int slices = 15);		// Needs a current OpenGL context
+	bool isInstanced() const { return instanced; }
+
+	void setWalls(const std::vector<float> &segments);		// x1, y1, x2, y2 per wall  Uploaded once, not every frame
+	void drawAgents(const std::vector<AgentInstance> &agents);
+	void drawWalls();
+};
+
+#endif
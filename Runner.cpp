@@ -0,0 +1,660 @@
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <vector>
+#include "CrowdAnalytics.h"
+#include "DomainDecomposition.h"
+#include "SocialForce.h"
+#include "Scene.h"
+#include "TrajectoryWriter.h"
+#ifdef SFM_WITH_MPI
+#include "MpiTransport.h"
+#endif
+#ifdef SFM_WITH_SOCKETS
+#include "SocketTransport.h"
+#endif
+using namespace std;
+
+// Command Line Options
+struct RunnerOptions {
+	const char *scene;			// See 'createScene()'
+	int numAgents;
+	int numWalls;				// Walls of the maze scene
+	int numSteps;
+	float stepTime;				// Fixed time step in seconds (0 keeps a restored checkpoint's)
+	int numSubsteps;
+	float skin;					// Negative keeps the engine default
+	SpaceCurve order;			// Curve agents are sorted along
+	int reorderInterval;		// Steps between sorts
+	const char *integrator;		// Null keeps the default (semi-implicit Euler)
+	int maxRateLevel;			// Multirate stepping, negative keeps the default (off) or the restored checkpoint's
+	float rateTolerance;
+	float sleepDelay;			// Sleeping, negative keeps the default (off) or the restored checkpoint's
+	float sleepSpeed;
+	float sleepAcceleration;
+	const char *restorePath;	// Checkpoint to resume from instead of building the scene
+	const char *checkpointPath;	// Checkpoint written after the last step
+	int numThreads;				// 0 uses every hardware thread
+	unsigned int seed;
+	const char *kernel;			// Null selects widest path this CPU supports
+	const char *model;			// See 'createForceModel()'
+	bool fastMath;
+	const char *outputPath;		// Null writes no results
+	int outputInterval;			// Steps between written frames (0 writes final frame only)
+	const char *trajectoryPath;	// Null writes no trajectory
+	int trajectoryInterval;		// Steps between trajectory frames
+	bool quantise;				// Trajectory stored as 16-bit integers
+	const char *profilePath;	// Null writes no per-step profile
+	const char *tracePath;		// Null writes no Chrome trace
+	const char *analyticsPath;	// Null writes no analytics time series
+	const char *fieldsPath;		// Null writes no density and speed fields
+	const char *diagramPath;	// Null writes no fundamental diagram
+	int analyticsInterval;		// Steps between analytics samples
+	float cellSize;				// Of the density and speed fields
+	vector<float> lines;		// Four coordinates per measurement line
+	int numRanks;				// Processes the scene is split across, 1 runs it whole
+	bool mpi;					// Ranks of an MPI job instead of forked processes
+	int rebalanceInterval;		// Steps between moving strip edges, 0 keeps them
+};
+
+// Function Prototypes
+bool parseOptions(int argc, char **argv, RunnerOptions &options);
+void printUsage(const char *program);
+void writeFrame(FILE *file, const SocialForce *socialForce, int step, float time);
+void getSceneBounds(const SocialForce *socialForce, float &minX, float &minY, float &maxX, float &maxY);
+void writeFrame(FILE *file, const vector<RemoteAgent> &agents, int step, float time);
+
+int main(int argc, char **argv) {
+	RunnerOptions options;
+	SocialForce *socialForce;
+	TrajectoryWriter trajectory;
+	Profiler profiler;
+	CrowdAnalytics analytics;
+	Transport *transport = 0;
+#ifdef SFM_WITH_SOCKETS
+	SocketTransport *sockets = 0;
+#endif
+	DomainDecomposition *decomposition = 0;
+	vector<RemoteAgent> gathered;
+	FILE *output = 0;
+	double seconds;
+	unsigned long long agentsEvaluated = 0, agentsStepped = 0, numSleeps = 0, numWakes = 0;	// On the last substep of each step
+	int totalAgents;
+	bool quiet, succeeded = true;
+
+	if (!parseOptions(argc, argv, options)) {
+		printUsage(argv[0]);
+		return 1;
+	}
+
+	// Ranks Start Before Any Thread, Each Builds the Whole Scene and Keeps Its Strip
+	if (options.numRanks > 1 || options.mpi) {
+		if (options.restorePath || options.checkpointPath || options.trajectoryPath || options.analyticsPath || options.fieldsPath ||
+			options.diagramPath) {
+			fprintf(stderr, "--restore, --checkpoint, --trajectory and analytics need a single process\n");
+			return 1;
+		}
+
+		if (options.mpi) {
+#ifdef SFM_WITH_MPI
+			transport = new MpiTransport(&argc, &argv);
+#else
+			fprintf(stderr, "Built without SFM_WITH_MPI, use --ranks for local processes\n");
+			return 1;
+#endif
+		}
+
+		else {
+#ifdef SFM_WITH_SOCKETS
+			transport = sockets = SocketTransport::fork(options.numRanks);
+#else
+			fprintf(stderr, "Built without Unix sockets, use --mpi for several ranks\n");
+			return 1;
+#endif
+		}
+
+		if (!transport) {
+			fprintf(stderr, "Cannot start %d ranks\n", options.numRanks);
+			return 1;
+		}
+	}
+
+	quiet = transport && transport->getRank() != 0;		// Only rank 0 reports and writes files
+
+	socialForce = new SocialForce;
+	socialForce->setSeed(options.seed);		// Scene layout and desired speeds
+
+	if (ForceModel *model = createForceModel(options.model))
+		socialForce->setForceModel(model);
+
+	else {
+		fprintf(stderr, "Unknown model '%s'\n", options.model);
+		delete socialForce;
+		return 1;
+	}
+
+	if (options.numThreads > 0)
+		socialForce->setNumThreads(options.numThreads);
+
+	if (options.kernel) {
+		if (strcmp(options.kernel, "scalar") == 0)
+			socialForce->setKernelPath(KernelPath::Scalar);
+		else if (strcmp(options.kernel, "avx2") == 0)
+			socialForce->setKernelPath(KernelPath::AVX2);
+		else if (strcmp(options.kernel, "avx512") == 0)
+			socialForce->setKernelPath(KernelPath::AVX512);
+	}
+
+	if (options.fastMath)
+		socialForce->setMathMode(MathMode::Fast);
+
+	if (options.restorePath) {
+		if (!socialForce->loadCheckpoint(options.restorePath)) {
+			fprintf(stderr, "Cannot restore '%s'\n", options.restorePath);
+			delete socialForce;
+			return 1;
+		}
+	}
+
+	else if (!createScene(socialForce, options.scene, options.numAgents, options.numWalls)) {
+		fprintf(stderr, "Unknown scene '%s'\n", options.scene);
+		delete socialForce;
+		return 1;
+	}
+
+	// Command Line Overrides Settings Restored from a Checkpoint
+	if (!options.restorePath || options.stepTime > 0.0F)
+		socialForce->setTimeStep((options.stepTime > 0.0F) ? options.stepTime : 0.02F, options.numSubsteps);
+
+	if (options.skin >= 0.0F)
+		socialForce->setNeighbourSkin(options.skin);
+
+	socialForce->setAgentOrder(options.order, options.reorderInterval);
+
+	if (options.integrator) {
+		if (strcmp(options.integrator, "euler") == 0)
+			socialForce->setIntegrator(Integrator::ExplicitEuler);
+		else if (strcmp(options.integrator, "verlet") == 0)
+			socialForce->setIntegrator(Integrator::VelocityVerlet);
+		else if (strcmp(options.integrator, "semi-implicit") == 0)
+			socialForce->setIntegrator(Integrator::SemiImplicitEuler);
+		else {
+			fprintf(stderr, "Unknown integrator '%s'\n", options.integrator);
+			delete socialForce;
+			return 1;
+		}
+	}
+
+	if (options.maxRateLevel >= 0)
+		socialForce->setMultirate(options.maxRateLevel, options.rateTolerance);
+
+	if (options.sleepDelay >= 0.0F)
+		socialForce->setSleep(options.sleepDelay, options.sleepSpeed, options.sleepAcceleration);
+
+	if (transport) {
+		decomposition = new DomainDecomposition(socialForce, transport);
+		decomposition->setRebalanceInterval(options.rebalanceInterval);
+
+		if (!quiet)
+			printf("ranks: %d (%s)  halo: %.2f m  rebalance every %d steps\n", transport->getNumRanks(), transport->getName(),
+				   decomposition->getHaloWidth(), decomposition->getRebalanceInterval());
+	}
+
+	if (options.outputPath && !quiet) {
+		output = fopen(options.outputPath, "w");
+
+		if (!output) {
+			fprintf(stderr, "Cannot open '%s' for writing\n", options.outputPath);
+			delete socialForce;
+			return 1;
+		}
+
+		fprintf(output, "step,time,id,x,y,vx,vy\n");
+	}
+
+	if (options.trajectoryPath) {
+		if (!trajectory.open(options.trajectoryPath, options.quantise ? TrajectoryEncoding::Quantised16 : TrajectoryEncoding::Float32,
+							 socialForce->getWalls())) {
+			fprintf(stderr, "Cannot open '%s' for writing\n", options.trajectoryPath);
+			delete socialForce;
+			return 1;
+		}
+
+		trajectory.write(socialForce->getState(), 0, socialForce->getTime());
+	}
+
+	// Fields Cover the Walls and the Crowd as Built, Lines Count From the First Step
+	if (options.analyticsPath || options.fieldsPath || options.diagramPath) {
+		float minX, minY, maxX, maxY;
+
+		getSceneBounds(socialForce, minX, minY, maxX, maxY);
+		analytics.setGrid(minX, minY, maxX, maxY, options.cellSize);
+		analytics.setSampleInterval(options.analyticsInterval);
+
+		for (size_t idx = 0; idx + 3 < options.lines.size(); idx += 4)
+			analytics.addLine(options.lines[idx], options.lines[idx + 1], options.lines[idx + 2], options.lines[idx + 3]);
+
+		if (!analytics.open(options.analyticsPath)) {
+			fprintf(stderr, "Cannot open '%s' for writing\n", options.analyticsPath);
+			delete socialForce;
+			return 1;
+		}
+
+		socialForce->setAnalytics(&analytics);
+	}
+
+	if ((options.profilePath || options.tracePath) && !quiet) {
+#ifdef SFM_PROFILING
+		if (options.profilePath && !profiler.openJson(options.profilePath)) {
+			fprintf(stderr, "Cannot open '%s' for writing\n", options.profilePath);
+			delete socialForce;
+			return 1;
+		}
+
+		if (options.tracePath && !profiler.openTrace(options.tracePath)) {
+			fprintf(stderr, "Cannot open '%s' for writing\n", options.tracePath);
+			delete socialForce;
+			return 1;
+		}
+
+		socialForce->setProfiler(&profiler);
+#else
+		fprintf(stderr, "Built without SFM_PROFILING, ignoring --profile and --trace\n");
+#endif
+	}
+
+	if (!quiet)
+		printf("scene: %s  agents: %d  walls: %d  steps: %d  dt: %g s  threads: %d  kernel: %s%s  model: %s\n", options.scene,
+			   socialForce->getCrowdSize(), socialForce->getNumWalls(), options.numSteps, socialForce->getTimeStep(), socialForce->getNumThreads(),
+			   getKernelPathName(socialForce->getKernelPath()), (socialForce->getMathMode() == MathMode::Fast) ? " (fast math)" : "",
+			   socialForce->getForceModel().getName());
+
+	if (decomposition && !decomposition->distribute()) {
+		if (!quiet)
+			fprintf(stderr, "Scene too narrow for %d ranks\n", transport->getNumRanks());
+
+		delete decomposition;
+		delete socialForce;
+		delete transport;
+		return 1;
+	}
+
+	// Run Fixed Steps as Fast as Possible  Output time is excluded from the measurement
+	seconds = 0.0;
+
+	for (int step = 1; succeeded && step <= options.numSteps; step++) {
+		chrono::steady_clock::time_point start = chrono::steady_clock::now();
+		bool frameDue = (options.outputInterval > 0 && step % options.outputInterval == 0) || step == options.numSteps;
+
+		if (decomposition)
+			succeeded = decomposition->step();
+		else
+			socialForce->advance(socialForce->getTimeStep());
+
+		agentsEvaluated += socialForce->getStepStats().agentsEvaluated;
+		agentsStepped += socialForce->getCrowdSize();
+		numSleeps += socialForce->getStepStats().agentsFellAsleep;
+		numWakes += socialForce->getStepStats().agentsWoken;
+		seconds += chrono::duration<double>(chrono::steady_clock::now() - start).count();
+
+		// Every Rank Takes Part in Gathering a Frame, Rank 0 Writes It
+		if (decomposition && options.outputPath && frameDue) {
+			succeeded = succeeded && decomposition->gather(gathered);
+
+			if (output)
+				writeFrame(output, gathered, step, socialForce->getTime());
+		}
+
+		else if (output && frameDue)
+			writeFrame(output, socialForce, step, socialForce->getTime());
+
+		if (trajectory.isOpen() && (step % options.trajectoryInterval == 0 || step == options.numSteps))
+			trajectory.write(socialForce->getState(), step, socialForce->getTime());
+	}
+
+	if (!succeeded)
+		fprintf(stderr, "Lost connection to a rank\n");
+
+	// Crowd of Every Rank Counted on Rank 0
+	totalAgents = socialForce->getCrowdSize();
+
+	if (decomposition && succeeded) {
+		succeeded = decomposition->gather(gathered);
+		totalAgents = gathered.size();
+
+		if (!quiet)
+			printf("agents on rank 0: %d of %d\n", socialForce->getCrowdSize(), totalAgents);
+	}
+
+	if (!quiet) {
+		printf("elapsed: %.3f s\n", seconds);
+		printf("steps/s: %.2f\n", options.numSteps / seconds);
+		printf("agent-steps/s: %.0f\n", static_cast<double>(options.numSteps) * totalAgents / seconds);
+		printf("neighbour list builds: %llu (skin %.2f m)\n", socialForce->getNeighbourListBuilds(), socialForce->getNeighbourSkin());
+
+		if (socialForce->getMaxRateLevel() > 0 || socialForce->getSleepDelay() > 0.0F)
+			printf("force evaluations: %.1f%% of agent-steps (up to %d levels, tolerance %g)\n", 100.0 * agentsEvaluated / max(agentsStepped, 1ULL),
+				   socialForce->getMaxRateLevel(), socialForce->getRateTolerance());
+
+		if (socialForce->getSleepDelay() > 0.0F)
+			printf("sleeps: %llu  wakes: %llu  asleep at the end: %d (after %g s below %g m/s and %g m/s^2)\n", numSleeps, numWakes,
+				   socialForce->getNumAsleep(), socialForce->getSleepDelay(), socialForce->getSleepSpeed(), socialForce->getSleepAcceleration());
+	}
+
+	if (!decomposition && (!socialForce->getSources().empty() || !socialForce->getSinks().empty()))
+		printf("agents spawned: %llu  retired: %llu  inside: %d\n", socialForce->getNumSpawned(), socialForce->getNumRetired(), socialForce->getCrowdSize());
+
+	if (profiler.getNumSteps() > 0) {
+		const StepProfile &totals = profiler.getTotals();
+
+		printf("worst imbalance:");
+
+		for (int phase = 0; phase < NUM_PROFILE_PHASES; phase++)
+			printf(" %s %.2f", Profiler::getPhaseName(static_cast<ProfilePhase>(phase)), totals.imbalance[phase]);
+
+		printf("\nallocations per step: %.1f (%.0f bytes)\n", static_cast<double>(totals.allocations) / profiler.getNumSteps(),
+			   static_cast<double>(totals.allocatedBytes) / profiler.getNumSteps());
+	}
+
+	socialForce->setProfiler(0);
+	socialForce->setAnalytics(0);
+
+	if (analytics.isOpen()) {
+		if (!analytics.close())
+			fprintf(stderr, "Failed writing '%s'\n", options.analyticsPath);
+
+		printf("analytics samples: %llu  measuring: %.3f s  submit stall: %.3f s\n", analytics.getNumSamples(), analytics.getProcessTime(),
+			   analytics.getStallTime());
+
+		for (size_t idx = 0; idx < analytics.getLines().size(); idx++)
+			printf("line %d crossings: %llu positive, %llu negative\n", static_cast<int>(idx), analytics.getLines()[idx].positiveCrossings,
+				   analytics.getLines()[idx].negativeCrossings);
+
+		if (options.fieldsPath && !analytics.writeFields(options.fieldsPath))
+			fprintf(stderr, "Cannot write '%s'\n", options.fieldsPath);
+
+		if (options.diagramPath && !analytics.writeDiagram(options.diagramPath))
+			fprintf(stderr, "Cannot write '%s'\n", options.diagramPath);
+	}
+
+	if (!profiler.close())
+		fprintf(stderr, "Failed writing profile\n");
+
+	if (output)
+		fclose(output);
+
+	if (options.checkpointPath && !socialForce->saveCheckpoint(options.checkpointPath))
+		fprintf(stderr, "Cannot write checkpoint '%s'\n", options.checkpointPath);
+
+	if (trajectory.isOpen()) {
+		printf("trajectory frames: %d  write stall: %.3f s\n", static_cast<int>(trajectory.getNumFrames()), trajectory.getStallTime());
+
+		if (!trajectory.close())
+			fprintf(stderr, "Failed writing '%s'\n", options.trajectoryPath);
+	}
+
+	delete decomposition;
+	delete socialForce;
+
+	// Rank 0 Outlives the Processes It Forked
+#ifdef SFM_WITH_SOCKETS
+	if (sockets && !quiet && !sockets->join()) {
+		fprintf(stderr, "A rank failed\n");
+		succeeded = false;
+	}
+#endif
+
+	delete transport;
+
+	return succeeded ? 0 : 1;
+}
+
+bool parseOptions(int argc, char **argv, RunnerOptions &options) {
+	options.scene = "corridor";
+	options.numAgents = 400;
+	options.numWalls = 2000;
+	options.numSteps = 1000;
+	options.stepTime = 0.0F;
+	options.numSubsteps = 1;
+	options.skin = -1.0F;
+	options.order = SpaceCurve::Morton;
+	options.reorderInterval = 100;
+	options.integrator = 0;
+	options.maxRateLevel = -1;
+	options.rateTolerance = 0.1F;
+	options.sleepDelay = -1.0F;
+	options.sleepSpeed = 0.05F;
+	options.sleepAcceleration = 0.2F;
+	options.restorePath = 0;
+	options.checkpointPath = 0;
+	options.numThreads = 0;
+	options.seed = 1604010629;
+	options.kernel = 0;
+	options.model = "moussaid";
+	options.outputPath = 0;
+	options.outputInterval = 0;
+	options.trajectoryPath = 0;
+	options.trajectoryInterval = 1;
+	options.quantise = false;
+	options.profilePath = 0;
+	options.tracePath = 0;
+	options.analyticsPath = 0;
+	options.fieldsPath = 0;
+	options.diagramPath = 0;
+	options.analyticsInterval = 10;
+	options.cellSize = 0.5F;
+	options.fastMath = false;
+	options.numRanks = 1;
+	options.mpi = false;
+	options.rebalanceInterval = 50;
+
+	for (int idx = 1; idx < argc; idx++) {
+		const char *option = argv[idx];
+		const char *value = (idx + 1 < argc) ? argv[idx + 1] : 0;
+
+		// Options Without Value
+		if (strcmp(option, "--quantise") == 0) {
+			options.quantise = true;
+			continue;
+		}
+
+		if (strcmp(option, "--fast-math") == 0) {
+			options.fastMath = true;
+			continue;
+		}
+
+		if (strcmp(option, "--mpi") == 0) {
+			options.mpi = true;
+			continue;
+		}
+
+		if (strcmp(option, "--help") == 0 || strcmp(option, "-h") == 0 || !value)
+			return false;
+
+		if (strcmp(option, "--scene") == 0)
+			options.scene = value;
+		else if (strcmp(option, "--agents") == 0)
+			options.numAgents = atoi(value);
+		else if (strcmp(option, "--walls") == 0)
+			options.numWalls = atoi(value);
+		else if (strcmp(option, "--steps") == 0)
+			options.numSteps = atoi(value);
+		else if (strcmp(option, "--dt") == 0)
+			options.stepTime = static_cast<float>(atof(value));
+		else if (strcmp(option, "--substeps") == 0)
+			options.numSubsteps = atoi(value);
+		else if (strcmp(option, "--skin") == 0)
+			options.skin = static_cast<float>(atof(value));
+		else if (strcmp(option, "--order") == 0) {
+			if (!parseSpaceCurve(value, options.order))
+				return false;
+		}
+
+		else if (strcmp(option, "--reorder-every") == 0)
+			options.reorderInterval = atoi(value);
+		else if (strcmp(option, "--integrator") == 0)
+			options.integrator = value;
+		else if (strcmp(option, "--multirate") == 0)
+			options.maxRateLevel = atoi(value);
+		else if (strcmp(option, "--rate-tolerance") == 0)
+			options.rateTolerance = static_cast<float>(atof(value));
+		else if (strcmp(option, "--sleep") == 0)
+			options.sleepDelay = static_cast<float>(atof(value));
+		else if (strcmp(option, "--sleep-speed") == 0)
+			options.sleepSpeed = static_cast<float>(atof(value));
+		else if (strcmp(option, "--sleep-acceleration") == 0)
+			options.sleepAcceleration = static_cast<float>(atof(value));
+		else if (strcmp(option, "--restore") == 0)
+			options.restorePath = value;
+		else if (strcmp(option, "--checkpoint") == 0)
+			options.checkpointPath = value;
+		else if (strcmp(option, "--threads") == 0)
+			options.numThreads = atoi(value);
+		else if (strcmp(option, "--seed") == 0)
+			options.seed = static_cast<unsigned int>(strtoul(value, 0, 10));
+		else if (strcmp(option, "--kernel") == 0)
+			options.kernel = value;
+		else if (strcmp(option, "--model") == 0)
+			options.model = value;
+		else if (strcmp(option, "--output") == 0)
+			options.outputPath = value;
+		else if (strcmp(option, "--output-every") == 0)
+			options.outputInterval = atoi(value);
+		else if (strcmp(option, "--trajectory") == 0)
+			options.trajectoryPath = value;
+		else if (strcmp(option, "--trajectory-every") == 0)
+			options.trajectoryInterval = atoi(value);
+		else if (strcmp(option, "--profile") == 0)
+			options.profilePath = value;
+		else if (strcmp(option, "--trace") == 0)
+			options.tracePath = value;
+		else if (strcmp(option, "--analytics") == 0)
+			options.analyticsPath = value;
+		else if (strcmp(option, "--analytics-every") == 0)
+			options.analyticsInterval = atoi(value);
+		else if (strcmp(option, "--cell") == 0)
+			options.cellSize = static_cast<float>(atof(value));
+		else if (strcmp(option, "--fields") == 0)
+			options.fieldsPath = value;
+		else if (strcmp(option, "--diagram") == 0)
+			options.diagramPath = value;
+		else if (strcmp(option, "--line") == 0) {
+			float line[4];
+
+			if (sscanf(value, "%f,%f,%f,%f", &line[0], &line[1], &line[2], &line[3]) != 4)
+				return false;
+
+			options.lines.insert(options.lines.end(), line, line + 4);
+		}
+
+		else if (strcmp(option, "--ranks") == 0)
+			options.numRanks = atoi(value);
+		else if (strcmp(option, "--rebalance-every") == 0)
+			options.rebalanceInterval = atoi(value);
+		else
+			return false;
+
+		idx++;		// Skip consumed value
+	}
+
+	return options.numAgents >= 0 && options.numSteps > 0 && options.stepTime >= 0.0F && options.numSubsteps > 0 && options.trajectoryInterval > 0 &&
+		   options.numRanks > 0 && options.rebalanceInterval >= 0 && options.analyticsInterval > 0 && options.cellSize > 0.0F;
+}
+
+void printUsage(const char *program) {
+	printf("Usage: %s [options]\n", program);
+	printf("  --scene NAME        corridor, bottleneck, evacuation, maze or stream (default corridor)\n");
+	printf("  --agents N          Agents in the scene (default 400)\n");
+	printf("  --walls N           Wall segments of the maze scene (default 2000)\n");
+	printf("  --steps N           Fixed steps to run (default 1000)\n");
+	printf("  --dt SECONDS        Fixed step time (default 0.02, or the restored checkpoint's)\n");
+	printf("  --substeps N        Force evaluations per step (default 1)\n");
+	printf("  --skin METRES       Neighbour list skin, 0 rebuilds every step (default 0.3)\n");
+	printf("  --order NAME        Curve agents are sorted along: none, morton or hilbert (default morton)\n");
+	printf("  --reorder-every N   Steps between sorts (default 100)\n");
+	printf("  --integrator NAME   semi-implicit, euler or verlet (default semi-implicit)\n");
+	printf("  --multirate LEVELS  Agents in free flow evaluate forces every 2^level substeps, up to 7 levels (default 0, off)\n");
+	printf("  --rate-tolerance X  Share of desired speed or neighbour gap one multirate kick may use up (default 0.1)\n");
+	printf("  --sleep SECONDS     Agents nearly still this long sleep until a moving neighbour wakes them (default 0, never)\n");
+	printf("  --sleep-speed M/S   Speed below which an agent rests, and above which a neighbour wakes it (default 0.05)\n");
+	printf("  --sleep-acceleration M/S2  Net force per unit mass below which an agent rests (default 0.2)\n");
+	printf("  --restore FILE      Resume from a checkpoint instead of building the scene\n");
+	printf("  --checkpoint FILE   Write a checkpoint after the last step\n");
+	printf("  --threads N         Worker threads, 0 for all hardware threads (default 0)\n");
+	printf("  --seed N            Seed of the scene layout (default 1604010629)\n");
+	printf("  --kernel NAME       scalar, avx2 or avx512 (default widest supported)\n");
+	printf("  --fast-math         Approximate exp, atan2 and square roots in the interaction kernel\n");
+	printf("  --model NAME        moussaid, moussaid-double, runtime or runtime-double (default moussaid)\n");
+	printf("  --output FILE       Write agent states as CSV\n");
+	printf("  --output-every N    Write every N steps instead of the final step only\n");
+	printf("  --trajectory FILE   Record a binary trajectory for replay in the viewer\n");
+	printf("  --trajectory-every N  Steps between trajectory frames (default 1)\n");
+	printf("  --quantise          Store the trajectory as 16-bit integers\n");
+	printf("  --profile FILE      Write phase times, load imbalance and counters of every step as JSON lines\n");
+	printf("  --trace FILE        Write a Chrome trace of every step (chrome://tracing or Perfetto)\n");
+	printf("  --analytics FILE    Write density, speed and line flow of every sample as JSON lines\n");
+	printf("  --analytics-every N Steps between analytics samples (default 10)\n");
+	printf("  --line X1,Y1,X2,Y2  Count agents crossing this segment (repeatable)\n");
+	printf("  --cell METRES       Cell size of the density and speed fields (default 0.5)\n");
+	printf("  --fields FILE       Write mean density and speed of every cell as CSV\n");
+	printf("  --diagram FILE      Write the fundamental diagram (speed and flow by local density) as CSV\n");
+	printf("  --ranks N           Split the scene into strips run by N processes over Unix sockets (default 1)\n");
+	printf("  --mpi               Split the scene across the ranks of an MPI job (needs SFM_WITH_MPI)\n");
+	printf("  --rebalance-every N Steps between moving strip edges to even out agents, 0 never (default 50)\n");
+}
+
+// Box Around Walls, Agents and Sources, With a Metre to Spare
+void getSceneBounds(const SocialForce *socialForce, float &minX, float &minY, float &maxX, float &maxY) {
+	const CrowdState &crowd = socialForce->getState();
+
+	minX = minY = INFINITY;
+	maxX = maxY = -INFINITY;
+
+	for (const Wall *wall : socialForce->getWalls()) {
+		minX = min(minX, min(wall->getStartPoint().x, wall->getEndPoint().x));
+		minY = min(minY, min(wall->getStartPoint().y, wall->getEndPoint().y));
+		maxX = max(maxX, max(wall->getStartPoint().x, wall->getEndPoint().x));
+		maxY = max(maxY, max(wall->getStartPoint().y, wall->getEndPoint().y));
+	}
+
+	for (size_t idx = 0; idx < crowd.size(); idx++) {
+		minX = min(minX, crowd.positionX[idx]);
+		minY = min(minY, crowd.positionY[idx]);
+		maxX = max(maxX, crowd.positionX[idx]);
+		maxY = max(maxY, crowd.positionY[idx]);
+	}
+
+	for (const Source &source : socialForce->getSources()) {
+		minX = min(minX, source.minX);
+		minY = min(minY, source.minY);
+		maxX = max(maxX, source.maxX);
+		maxY = max(maxY, source.maxY);
+	}
+
+	// Empty Scene
+	if (minX > maxX) {
+		minX = minY = -1.0F;
+		maxX = maxY = 1.0F;
+	}
+
+	minX -= 1.0F;
+	minY -= 1.0F;
+	maxX += 1.0F;
+	maxY += 1.0F;
+}
+
+void writeFrame(FILE *file, const vector<RemoteAgent> &agents, int step, float time) {
+	for (const RemoteAgent &agent : agents)
+		fprintf(file, "%d,%.4f,%d,%.4f,%.4f,%.4f,%.4f\n", step, time, agent.id, agent.x, agent.y, agent.velocityX, agent.velocityY);
+}
+
+void writeFrame(FILE *file, const SocialForce *socialForce, int step, float time) {
+	const CrowdState &crowd = socialForce->getState();
+
+	for (size_t idx = 0; idx < crowd.size(); idx++)
+		fprintf(file, "%d,%.4f,%d,%.4f,%.4f,%.4f,%.4f\n", step, time, crowd.id[idx],
+				crowd.positionX[idx], crowd.positionY[idx], crowd.velocityX[idx], crowd.velocityY[idx]);
+}
@@ -0,0 +1,244 @@
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include "Scene.h"
+using namespace std;
+
+void createWalls(SocialForce *socialForce) {
+	Wall *wall;
+
+	// Upper Wall
+	wall = new Wall(-25.0, 6.0, 25.0, 6.0);		// Step 1: Create wall and define its coordinates (param: x1, y1, x2, y2)
+	socialForce->addWall(wall);					// Step 2: Add wall to SFM
+
+	// Lower Wall
+	wall = new Wall(-25.0, -6.0, 25.0, -6.0);
+	socialForce->addWall(wall);
+}
+
+void createAgents(SocialForce *socialForce, int numAgents) {
+	Agent *agent;
+	bool opposite = false;
+
+	for (int idx = 0; idx < numAgents; idx++) {
+		agent = new Agent;															// Step 1: Create agent
+
+		if (!opposite) {
+			agent->setPosition(randomFloat(socialForce, -20.3F, -5.0), randomFloat(socialForce, -5.0, 5.0));	// Step 2: Set initial position (param: x, y)
+			agent->setPath(randomFloat(socialForce, 25.0, 30.0), randomFloat(socialForce, -5.0, 5.0), 5.0);	// Step 3: Set target position(s) (param: x, y, waypt_radius)  Can set multiple targets by repeating step 3
+			opposite = true;
+		}
+
+		else {
+			agent->setPosition(randomFloat(socialForce, 5.0, 20.3F), randomFloat(socialForce, -5.0, 5.0));
+			agent->setPath(randomFloat(socialForce, -30.0, -25.0), randomFloat(socialForce, -5.0, 5.0), 5.0);
+			opposite = false;
+		}
+
+		socialForce->addAgent(agent);												// Step 4: Add agent to SFM
+	}
+}
+
+float randomFloat(SocialForce *socialForce, float lowerBound, float upperBound) {
+	return socialForce->drawUniform(lowerBound, upperBound);
+}
+
+void createCorridor(SocialForce *socialForce, int numAgents) {
+	Agent *agent;
+	float offset;	// Extra length of each half so density matches the 400 agent corridor
+	bool opposite = false;
+
+	offset = 15.3F * (max(numAgents, 400) / 400.0F - 1.0F);
+
+	socialForce->addWall(new Wall(-25.0F - offset, 6.0, 25.0F + offset, 6.0));
+	socialForce->addWall(new Wall(-25.0F - offset, -6.0, 25.0F + offset, -6.0));
+
+	for (int idx = 0; idx < numAgents; idx++) {
+		agent = new Agent;
+
+		if (!opposite) {
+			agent->setPosition(randomFloat(socialForce, -20.3F - offset, -5.0), randomFloat(socialForce, -5.0, 5.0));
+			agent->setPath(randomFloat(socialForce, 25.0F + offset, 30.0F + offset), randomFloat(socialForce, -5.0, 5.0), 5.0);
+			opposite = true;
+		}
+
+		else {
+			agent->setPosition(randomFloat(socialForce, 5.0, 20.3F + offset), randomFloat(socialForce, -5.0, 5.0));
+			agent->setPath(randomFloat(socialForce, -30.0F - offset, -25.0F - offset), randomFloat(socialForce, -5.0, 5.0), 5.0);
+			opposite = false;
+		}
+
+		socialForce->addAgent(agent);
+	}
+}
+
+void createBottleneck(SocialForce *socialForce, int numAgents) {
+	const float doorWidth = 1.2F;
+	float side;		// Room side length for about 2 agents per square metre
+	Agent *agent;
+
+	side = max(5.0F, sqrt(numAgents / 2.0F));
+
+	// Room Spanning x in [-side, 0] With Door in Right Wall
+	socialForce->addWall(new Wall(-side, side / 2, 0.0, side / 2));
+	socialForce->addWall(new Wall(-side, -side / 2, 0.0, -side / 2));
+	socialForce->addWall(new Wall(-side, -side / 2, -side, side / 2));
+	socialForce->addWall(new Wall(0.0, side / 2, 0.0, doorWidth / 2));
+	socialForce->addWall(new Wall(0.0, -doorWidth / 2, 0.0, -side / 2));
+
+	for (int idx = 0; idx < numAgents; idx++) {
+		agent = new Agent;
+		agent->setPosition(randomFloat(socialForce, -side + 0.3F, -0.3F), randomFloat(socialForce, -side / 2 + 0.3F, side / 2 - 0.3F));
+		agent->setPath(0.5F, 0.0, 0.5F);						// Door
+		agent->setPath(10.0F * side + 100.0F, 0.0, 1.0F);	// Far beyond door, not reached during a run
+		socialForce->addAgent(agent);
+	}
+}
+
+void createEvacuation(SocialForce *socialForce, int numAgents) {
+	const float exitWidth = 1.5F;
+	const float exitX[4] = { 1.0F, -1.0F, 0.0, 0.0 }, exitY[4] = { 0.0, 0.0, 1.0F, -1.0F };
+	float half, x, y, distanceSquared, minDistanceSquared;
+	int nearest;
+	Agent *agent;
+
+	half = max(5.0F, sqrt(numAgents / 2.0F)) / 2;
+
+	// Square Room With an Exit in the Middle of Each Wall
+	for (int side = 0; side < 4; side++) {
+		float normalX = exitX[side], normalY = exitY[side], tangentX = -normalY, tangentY = normalX;
+
+		socialForce->addWall(new Wall(normalX * half + tangentX * half, normalY * half + tangentY * half,
+									  normalX * half + tangentX * exitWidth / 2, normalY * half + tangentY * exitWidth / 2));
+		socialForce->addWall(new Wall(normalX * half - tangentX * exitWidth / 2, normalY * half - tangentY * exitWidth / 2,
+									  normalX * half - tangentX * half, normalY * half - tangentY * half));
+	}
+
+	for (int idx = 0; idx < numAgents; idx++) {
+		x = randomFloat(socialForce, -half + 0.3F, half - 0.3F);
+		y = randomFloat(socialForce, -half + 0.3F, half - 0.3F);
+
+		// Head for Nearest Exit, Then Away From the Room
+		nearest = 0;
+		minDistanceSquared = INFINITY;
+
+		for (int side = 0; side < 4; side++) {
+			distanceSquared = (exitX[side] * half - x) * (exitX[side] * half - x) + (exitY[side] * half - y) * (exitY[side] * half - y);
+
+			if (distanceSquared < minDistanceSquared) {
+				minDistanceSquared = distanceSquared;
+				nearest = side;
+			}
+		}
+
+		agent = new Agent;
+		agent->setPosition(x, y);
+		agent->setPath(exitX[nearest] * (half + 0.5F), exitY[nearest] * (half + 0.5F), 0.5F);
+		agent->setPath(exitX[nearest] * (20.0F * half + 100.0F), exitY[nearest] * (20.0F * half + 100.0F), 1.0F);
+		socialForce->addAgent(agent);
+	}
+}
+
+void createMaze(SocialForce *socialForce, int numAgents, int numWalls) {
+	const float cellSize = 4.0F, wallLength = 3.0F;		// 1 m gap in every cell edge
+	int cells;
+	float extent;
+	Agent *agent;
+
+	// Two Walls per Cell (Bottom and Left Edge)
+	cells = max(1, static_cast<int>(sqrt(numWalls / 2.0F)));
+	extent = cells * cellSize;
+
+	for (int row = 0; row < cells; row++) {
+		for (int col = 0; col < cells; col++) {
+			float x = col * cellSize - extent / 2, y = row * cellSize - extent / 2;
+
+			socialForce->addWall(new Wall(x, y, x + wallLength, y));
+			socialForce->addWall(new Wall(x, y + cellSize - wallLength, x, y + cellSize));
+		}
+	}
+
+	for (int idx = 0; idx < numAgents; idx++) {
+		agent = new Agent;
+		agent->setPosition(randomFloat(socialForce, -extent / 2, extent / 2), randomFloat(socialForce, -extent / 2, extent / 2));
+		agent->setPath(randomFloat(socialForce, -extent / 2, extent / 2), randomFloat(socialForce, -extent / 2, extent / 2), 1.0F);
+		agent->setPath(randomFloat(socialForce, -extent / 2, extent / 2), randomFloat(socialForce, -extent / 2, extent / 2), 1.0F);
+		socialForce->addAgent(agent);
+	}
+}
+
+void createStream(SocialForce *socialForce, int numAgents) {
+	const float halfLength = 25.0F, halfWidth = 6.0F, transitTime = 2.0F * halfLength / 1.29F;	// At mean desired speed
+	int towardsRight, towardsLeft;
+	Agent *agent;
+
+	socialForce->addWall(new Wall(-halfLength, halfWidth, halfLength, halfWidth));
+	socialForce->addWall(new Wall(-halfLength, -halfWidth, halfLength, -halfWidth));
+
+	// Exits Just Beyond Each End, Reached Through Flow Fields
+	towardsRight = socialForce->addTarget(halfLength + 7.0F, 0.0, 7.0F);
+	towardsLeft = socialForce->addTarget(-halfLength - 7.0F, 0.0, 7.0F);
+
+	socialForce->addSink(Sink(halfLength, -halfWidth, halfLength + 5.0F, halfWidth));
+	socialForce->addSink(Sink(-halfLength - 5.0F, -halfWidth, -halfLength, halfWidth));
+
+	// Each End Replaces the Agents Leaving the Other, Half the Crowd per Direction
+	for (int side = 0; side < 2; side++) {
+		float entryX = (side == 0) ? -halfLength : halfLength - 4.0F;
+		Source source(entryX, -halfWidth + 0.5F, entryX + 4.0F, halfWidth - 0.5F, 0.5F * numAgents / transitTime);
+
+		source.target = (side == 0) ? towardsRight : towardsLeft;
+		source.colour.set((side == 0) ? 1.0F : 0.0F, 0.0, (side == 0) ? 0.0F : 1.0F);
+		socialForce->addSource(source);
+	}
+
+	// Corridor Starts Full
+	for (int idx = 0; idx < numAgents; idx++) {
+		agent = new Agent;
+		agent->setPosition(randomFloat(socialForce, -halfLength + 2.0F, halfLength - 2.0F), randomFloat(socialForce, -halfWidth + 0.5F, halfWidth - 0.5F));
+		agent->setTarget((idx % 2 == 0) ? towardsRight : towardsLeft);
+		agent->setColour((idx % 2 == 0) ? 1.0F : 0.0F, 0.0, (idx % 2 == 0) ? 0.0F : 1.0F);
+		socialForce->addAgent(agent);
+	}
+}
+
+bool createSceneExits(SocialForce *socialForce, const char *name, int numAgents) {
+	float side, half;
+
+	// Same Room Sizes as 'createBottleneck()' and 'createEvacuation()'  Agents leave a metre past the door
+	if (strcmp(name, "bottleneck") == 0) {
+		side = max(5.0F, sqrt(numAgents / 2.0F));
+		socialForce->addSink(Sink(1.0F, -side / 2, 3.0F, side / 2));
+	}
+
+	else if (strcmp(name, "evacuation") == 0) {
+		half = max(5.0F, sqrt(numAgents / 2.0F)) / 2;
+
+		socialForce->addSink(Sink(half + 1.0F, -half, half + 3.0F, half));
+		socialForce->addSink(Sink(-half - 3.0F, -half, -half - 1.0F, half));
+		socialForce->addSink(Sink(-half, half + 1.0F, half, half + 3.0F));
+		socialForce->addSink(Sink(-half, -half - 3.0F, half, -half - 1.0F));
+	}
+
+	else
+		return false;
+
+	return true;
+}
+
+bool createScene(SocialForce *socialForce, const char *name, int numAgents, int numWalls) {
+	if (strcmp(name, "corridor") == 0)
+		createCorridor(socialForce, numAgents);
+	else if (strcmp(name, "bottleneck") == 0)
+		createBottleneck(socialForce, numAgents);
+	else if (strcmp(name, "evacuation") == 0)
+		createEvacuation(socialForce, numAgents);
+	else if (strcmp(name, "maze") == 0)
+		createMaze(socialForce, numAgents, numWalls);
+	else if (strcmp(name, "stream") == 0)
+		createStream(socialForce, numAgents);
+	else
+		return false;
+
+	return true;
+}
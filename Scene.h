@@ -0,0 +1,20 @@
+#ifndef SCENE_H
+#define SCENE_H
+
+#include "SocialForce.h"
+
+// Bidirectional Corridor Shared by the Viewer and the Headless Runner
+void createWalls(SocialForce *socialForce);
+void createAgents(SocialForce *socialForce, int numAgents = 400);
+float randomFloat(SocialForce *socialForce, float lowerBound, float upperBound);	// From the random stream of 'socialForce' (see 'SocialForce::setSeed()')
+
+// Parameterised Scenarios for Runs and Benchmarks
+void createCorridor(SocialForce *socialForce, int numAgents);		// Corridor above, lengthened to keep its density
+void createBottleneck(SocialForce *socialForce, int numAgents);		// Room draining through a 1.2 m door
+void createEvacuation(SocialForce *socialForce, int numAgents);		// Room emptying through four exits
+void createMaze(SocialForce *socialForce, int numAgents, int numWalls);	// Lattice of short walls with gaps
+void createStream(SocialForce *socialForce, int numAgents);		// Open-ended corridor, arrivals at each end sized to keep about 'numAgents' inside
+bool createScene(SocialForce *socialForce, const char *name, int numAgents, int numWalls = 2000);	// False if 'name' is unknown
+bool createSceneExits(SocialForce *socialForce, const char *name, int numAgents);	// Sinks just past the exits of a room scene  False if it has none
+
+#endif
@@ -1,28 +1,376 @@
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <functional>
+#include <limits>
+#include <random>
+#include <sstream>
+#include <string>
+#include "DomainDecomposition.h"
 #include "SocialForce.h"
 using namespace std;
 
+const size_t AGENTS_PER_CHUNK = 256;	// Agents claimed at once by a worker thread
+const int MAX_RATE_LEVEL = 7;			// Longest kick is 128 substeps, 'idleSteps' counts down from at most 127
+const float MIN_GAP = 0.01F;			// Metres, gaps to neighbours and walls are taken as at least this wide
+
+const char CHECKPOINT_MAGIC[8] = { 'S', 'F', 'M', 'C', 'K', 'P', 'T', '1' };
+const unsigned int CHECKPOINT_VERSION = 6;
+const int SPAWN_ATTEMPTS = 8;			// Random positions tried per arrival before it waits for the next step
+
+typedef chrono::steady_clock Clock;
+
+static double elapsedSeconds(Clock::time_point &start) {
+	Clock::time_point now = Clock::now();
+	double seconds = chrono::duration<double>(now - start).count();
+
+	start = now;	// Next phase starts here
+	return seconds;
+}
+
+void StepStats::reset() {
+	boundaryTime = neighbourSearchTime = drivingTime = agentInteractTime = wallInteractTime = integrationTime = totalTime = 0.0;
+	pairsConsidered = pairsWithinRange = 0;
+	neighbourListRebuilt = agentsReordered = false;
+	agentsSpawned = agentsRetired = agentsEvaluated = agentsAsleep = agentsFellAsleep = agentsWoken = 0;
+}
+
+// Checkpoint Fields are Written Raw in Host Byte Order
+template <typename T>
+static bool writeValue(FILE *file, const T &value) {
+	return fwrite(&value, sizeof(T), 1, file) == 1;
+}
+
+template <typename T>
+static bool readValue(FILE *file, T &value) {
+	return fread(&value, sizeof(T), 1, file) == 1;
+}
+
+template <typename T>
+static bool writeArray(FILE *file, const vector<T> &values) {
+	return values.empty() || fwrite(&values[0], sizeof(T), values.size(), file) == values.size();
+}
+
+template <typename T>
+static bool readArray(FILE *file, vector<T> &values, size_t count) {
+	values.resize(count);
+	return count == 0 || fread(&values[0], sizeof(T), count, file) == count;
+}
+
+// Sources Keep Their Arrival Schedule, So a Restored Run Spawns the Same Agents
+static bool writeSource(FILE *file, const Source &source) {
+	unsigned int arrivals = static_cast<unsigned int>(source.arrivals), pathSize = source.path.size();
+
+	return writeValue(file, source.minX) && writeValue(file, source.minY) && writeValue(file, source.maxX) && writeValue(file, source.maxY) &&
+		   writeValue(file, source.rate) && writeValue(file, arrivals) && writeValue(file, source.maxAgents) &&
+		   writeValue(file, source.radius) && writeValue(file, source.speedMean) && writeValue(file, source.speedDeviation) &&
+		   writeValue(file, source.colour) && writeValue(file, source.target) && writeValue(file, source.nextArrival) &&
+		   writeValue(file, source.numSpawned) && writeValue(file, pathSize) && writeArray(file, source.path);
+}
+
+static bool readSource(FILE *file, Source &source) {
+	unsigned int arrivals, pathSize;
+
+	if (!(readValue(file, source.minX) && readValue(file, source.minY) && readValue(file, source.maxX) && readValue(file, source.maxY) &&
+		  readValue(file, source.rate) && readValue(file, arrivals) && arrivals <= static_cast<unsigned int>(ArrivalProcess::Poisson) &&
+		  readValue(file, source.maxAgents) && readValue(file, source.radius) && readValue(file, source.speedMean) &&
+		  readValue(file, source.speedDeviation) && readValue(file, source.colour) && readValue(file, source.target) &&
+		  readValue(file, source.nextArrival) && readValue(file, source.numSpawned) && readValue(file, pathSize) &&
+		  pathSize < (1U << 20) && readArray(file, source.path, pathSize)))
+		return false;
+
+	source.arrivals = static_cast<ArrivalProcess>(arrivals);
+	return true;
+}
+
+SocialForce::SocialForce(int numThreads) {
+	model = new MoussaidForceModel;
+	pool = 0;
+	profiler = 0;
+	analytics = 0;
+	decomposition = 0;
+	nextId = 0;
+	idStride = 1;
+	wallsChanged = false;
+	wakePending = false;
+	agentOrder = SpaceCurve::Morton;
+	reorderInterval = 100;
+
+	stepTime = 0.02F;
+	numSubsteps = 1;
+	maxStepsPerAdvance = 8;
+	maxRateLevel = 0;
+	rateTolerance = 0.1F;
+	sleepDelay = 0.0F;
+	sleepSpeed = 0.05F;
+	sleepAcceleration = 0.2F;
+	numAsleep = 0;
+	accumulator = 0.0F;
+	time = 0.0;
+	stepCount = 0;
+	setNumThreads((numThreads > 0) ? numThreads : thread::hardware_concurrency());
+}
+
 SocialForce::~SocialForce() {
 	removeCrowd();
 	removeWalls();
+	removeBoundaries();
+
+	delete pool;
+	delete model;
 }
 
-void SocialForce::addAgent(Agent *agent) {
+AgentHandle SocialForce::insertAgent(Agent *agent) {
+	// Ids Only Grow, So Removing Agents in Any Order Never Duplicates One
+	if (agent->id < 0) {
+		agent->id = nextId;
+		nextId += idStride;
+	}
+
+	else if (agent->id >= nextId)
+		nextId += (agent->id - nextId) / idStride * idStride + idStride;
+
+	if (agent->target >= static_cast<int>(state.targets.size()))
+		agent->target = -1;
+
+	agent->bind(&state);
+	agent->handle = handles.insert(agent->idx);
 	crowd.push_back(agent);
+
+	return agent->handle;
+}
+
+void SocialForce::eraseAgent(size_t idx) {
+	size_t lastIdx = crowd.size() - 1;
+
+	delete crowd[idx];
+	handles.release(idx);
+
+	// Move Last Agent Into the Gap
+	if (idx != lastIdx) {
+		crowd[idx] = crowd[lastIdx];
+		crowd[idx]->idx = idx;
+		handles.move(lastIdx, idx);
+	}
+
+	crowd.pop_back();
+	handles.pop();
+	numAsleep -= (state.idleSteps[idx] == ASLEEP);
+	state.removeAgent(idx);
+}
+
+AgentHandle SocialForce::addAgent(Agent *agent) {
+	// Desired Speed Based on (Moussaid et al., 2009)
+	if (agent->desiredSpeed < 0.0F) {
+		normal_distribution<float> distribution(1.29F, 0.19F);	// Generate random value of mean 1.29 and standard deviation 0.19
+		agent->desiredSpeed = distribution(generator);
+	}
+
+	neighbourList.invalidate();
+	return insertAgent(agent);
+}
+
+AgentHandle SocialForce::adoptAgent(Agent *agent, const AgentDynamics &dynamics) {
+	AgentHandle handle = insertAgent(agent);
+	size_t idx = agent->idx;
+
+	state.velocityX[idx] = dynamics.velocityX;
+	state.velocityY[idx] = dynamics.velocityY;
+	state.accelerationX[idx] = dynamics.accelerationX;
+	state.accelerationY[idx] = dynamics.accelerationY;
+	state.driftX[idx] = dynamics.driftX;
+	state.driftY[idx] = dynamics.driftY;
+	state.pathIdx[idx] = state.routes[state.route[idx]].empty() ? 0 : dynamics.pathIdx;
+
+	// Rate Level and Sleep Carry On Under the Same Settings, Otherwise the Agent Starts Again at Level 0
+	if ((dynamics.idleSteps == ASLEEP) ? sleepDelay > 0.0F : dynamics.rateLevel <= maxRateLevel && dynamics.idleSteps < (1 << dynamics.rateLevel)) {
+		state.rateLevel[idx] = dynamics.rateLevel;
+		state.idleSteps[idx] = dynamics.idleSteps;
+		state.restTime[idx] = dynamics.restTime;
+		numAsleep += (dynamics.idleSteps == ASLEEP);
+	}
+
+	neighbourList.invalidate();
+	return handle;
+}
+
+void SocialForce::getDynamics(size_t idx, AgentDynamics &dynamics) const {
+	dynamics.velocityX = state.velocityX[idx];
+	dynamics.velocityY = state.velocityY[idx];
+	dynamics.accelerationX = state.accelerationX[idx];
+	dynamics.accelerationY = state.accelerationY[idx];
+	dynamics.driftX = state.driftX[idx];
+	dynamics.driftY = state.driftY[idx];
+	dynamics.restTime = state.restTime[idx];
+	dynamics.pathIdx = state.pathIdx[idx];
+	dynamics.rateLevel = state.rateLevel[idx];
+	dynamics.idleSteps = state.idleSteps[idx];
+}
+
+void SocialForce::addAgents(const vector<Agent *> &agents) {
+	growAgents(agents.size());
+
+	for (Agent *agent : agents)
+		addAgent(agent);
+}
+
+void SocialForce::reserveAgents(size_t capacity) {
+	crowd.reserve(capacity);
+	handles.reserve(capacity);
+	state.reserve(capacity);
+}
+
+void SocialForce::growAgents(size_t count) {
+	if (crowd.size() + count > crowd.capacity())
+		reserveAgents(max(crowd.size() + count, 2 * crowd.capacity()));
 }
 
 void SocialForce::addWall(Wall *wall) {
 	walls.push_back(wall);
+	wallsChanged = true;
+	wakePending = true;
 }
 
-void SocialForce::removeAgent() {
-	int lastIdx;
+int SocialForce::addTarget(float x, float y, float radius) {
+	Waypoint target = { Point3f(x, y, 0.0), radius };
+
+	state.targets.push_back(target);
+	return state.targets.size() - 1;
+}
+
+int SocialForce::addSource(const Source &source) {
+	sources.push_back(source);
+	return sources.size() - 1;
+}
+
+int SocialForce::addSink(const Sink &sink) {
+	sinks.push_back(sink);
+	return sinks.size() - 1;
+}
+
+unsigned long long SocialForce::getNumSpawned() const {
+	unsigned long long numSpawned = 0;
+
+	for (const Source &source : sources)
+		numSpawned += source.numSpawned;
+
+	return numSpawned;
+}
+
+unsigned long long SocialForce::getNumRetired() const {
+	unsigned long long numRetired = 0;
+
+	for (const Sink &sink : sinks)
+		numRetired += sink.numRetired;
+
+	return numRetired;
+}
+
+void SocialForce::setForceModel(ForceModel *model) {
+	model->setKernelPath(this->model->getKernelPath());
+	model->setMathMode(this->model->getMathMode());
+	model->setIntegrator(this->model->getIntegrator());
+
+	delete this->model;
+	this->model = model;
+
+	// Ranges and Forces May Differ
+	wallsChanged = true;
+	neighbourList.invalidate();
+	wakeAgents();
+}
 
+void SocialForce::setNumThreads(int numThreads) {
+	numThreads = max(numThreads, 1);
+
+	delete pool;
+	pool = new ThreadPool(numThreads);
+
+	scratch.resize(numThreads);
+}
+
+void SocialForce::setAgentOrder(SpaceCurve curve, int interval) {
+	agentOrder = curve;
+	reorderInterval = max(interval, 0);
+}
+
+void SocialForce::setMultirate(int maxLevel, float tolerance) {
+	maxRateLevel = min(max(maxLevel, 0), MAX_RATE_LEVEL);
+	rateTolerance = (tolerance > 0.0F) ? tolerance : rateTolerance;
+
+	// Every Agent is Evaluated Next Substep and Climbs From There, So No Kick Outlasts the New Limit
+	wakeAgents();
+}
+
+void SocialForce::setSleep(float delay, float speed, float acceleration) {
+	sleepDelay = max(delay, 0.0F);
+	sleepSpeed = max(speed, 0.0F);
+	sleepAcceleration = max(acceleration, 0.0F);
+	wakeAgents();
+}
+
+void SocialForce::setIdSequence(int nextId, int stride) {
+	this->nextId = nextId;
+	idStride = max(stride, 1);
+}
+
+void SocialForce::setTimeStep(float stepTime, int numSubsteps) {
+	this->stepTime = stepTime;
+	this->numSubsteps = max(numSubsteps, 1);
+	accumulator = 0.0F;
+}
+
+Agent *SocialForce::getAgent(AgentHandle handle) const {
+	size_t idx;
+
+	return handles.find(handle, idx) ? crowd[idx] : 0;
+}
+
+void SocialForce::removeAgent() {
 	if (!crowd.empty()) {
-		lastIdx = crowd.size() - 1;		// Assign index of last element
+		eraseAgent(crowd.size() - 1);	// Remove last element
+		neighbourList.invalidate();
+	}
+}
+
+bool SocialForce::removeAgent(AgentHandle handle) {
+	size_t idx;
+
+	if (!handles.find(handle, idx))
+		return false;
+
+	eraseAgent(idx);
+	neighbourList.invalidate();
+
+	return true;
+}
+
+void SocialForce::eraseAgents(vector<size_t> &indices) {
+	// Highest Index First, So the Agent Moved Into a Gap is Never One Still to Be Removed
+	sort(indices.begin(), indices.end(), greater<size_t>());
+	indices.erase(unique(indices.begin(), indices.end()), indices.end());
+
+	for (size_t idx : indices)
+		eraseAgent(idx);
+
+	if (!indices.empty())
+		neighbourList.invalidate();
+}
 
-		delete crowd[lastIdx];
-		crowd.pop_back();
+void SocialForce::removeAgents(const vector<AgentHandle> &handles) {
+	vector<size_t> indices;
+	size_t idx;
+
+	indices.reserve(handles.size());
+
+	for (AgentHandle handle : handles) {
+		if (this->handles.find(handle, idx))
+			indices.push_back(idx);
 	}
+
+	eraseAgents(indices);
 }
 
 void SocialForce::removeCrowd() {
@@ -30,6 +378,35 @@ void SocialForce::removeCrowd() {
 		delete crowd[idx];
 
 	crowd.clear();
+	handles.clear();
+	state.clear();
+	nextId %= idStride;		// Keeps the offset of a rank's ids
+	neighbourList.invalidate();
+	numAsleep = 0;
+}
+
+void SocialForce::removeTargets() {
+	state.targets.clear();
+
+	for (size_t idx = 0; idx < state.size(); idx++)
+		state.target[idx] = -1;
+
+	for (Source &source : sources)
+		source.target = -1;
+
+	wakePending = true;
+}
+
+void SocialForce::removeSourcesOutside(float minX, float maxX) {
+	sources.erase(remove_if(sources.begin(), sources.end(), [&](const Source &source) {
+		float centre = 0.5F * (source.minX + source.maxX);
+		return !(centre >= minX && centre < maxX);
+	}), sources.end());
+}
+
+void SocialForce::removeBoundaries() {
+	sources.clear();
+	sinks.clear();
 }
 
 void SocialForce::removeWalls() {
@@ -37,9 +414,710 @@ void SocialForce::removeWalls() {
 		delete walls[idx];
 
 	walls.clear();
+	wallsChanged = true;
+	wakePending = true;
 }
 
 void SocialForce::moveCrowd(float stepTime) {
-	for (unsigned int idx = 0; idx < crowd.size(); idx++)
-		crowd[idx]->move(crowd, walls, stepTime);
-}
\ No newline at end of file
+	Clock::time_point stepStart = Clock::now(), phaseStart = stepStart;
+	StepContext context;
+	size_t numOwned, numEvaluated;
+	bool selective = maxRateLevel > 0 || sleepDelay > 0.0F;		// Evaluates some agents only
+
+	SFM_PROFILE(if (profiler) profiler->beginStep(pool->getNumThreads()));
+
+	// Agents Leave and Enter Before the Neighbour Search Sees the Crowd
+	stats.agentsSpawned = stats.agentsRetired = stats.agentsFellAsleep = stats.agentsWoken = 0;
+	ghostWakeups.clear();
+
+	if (!sources.empty() || !sinks.empty())
+		updateBoundaries(stepTime);
+
+	stats.boundaryTime = elapsedSeconds(phaseStart);
+
+	// Walls are Static Between Changes, Index Them Once
+	if (wallsChanged) {
+		wallIndex.build(walls, model->getWallRange());
+		navigation.invalidateWalls();
+		wallsChanged = false;
+	}
+
+	// Paths and Wall Forces Changed, Sleeping Agents Find Out
+	if (wakePending) {
+		stats.agentsWoken += numAsleep;
+		wakeAgents();
+		wakePending = false;
+	}
+
+	navigation.update(state.targets, walls, wallIndex, *pool);
+
+	// Sort Agents Along the Curve Before Ghosts Join  Counted from the step count, so a restored run sorts in the same steps
+	stats.agentsReordered = agentOrder != SpaceCurve::None && reorderInterval > 0 && stepCount % reorderInterval == 0 && reorderAgents();
+
+	// Ghosts Join the Crowd for This Step Only  They are neighbours of the agents before them, their own rank moves them
+	// The same ghosts in the same order take the same indices as last step, so the neighbour list holds until they move too far
+	numOwned = state.size();
+
+	for (const RemoteAgent &ghost : ghosts)
+		state.addGhost(ghost.id, ghost.radius, ghost.x, ghost.y, ghost.velocityX, ghost.velocityY, ghost.rateLevel, ghost.idleSteps);
+
+	if (ghostIds.size() != ghosts.size() || !equal(ghostIds.begin(), ghostIds.end(), state.id.begin() + numOwned)) {
+		ghostIds.assign(state.id.begin() + numOwned, state.id.end());
+		neighbourList.invalidate();
+	}
+
+	// Rebuild Neighbour List Only Once Agents Have Used Up the Skin  Every agent reads the current state only
+	stats.neighbourListRebuilt = neighbourList.needsRebuild(state);
+
+	if (stats.neighbourListRebuilt) {
+		grid.build(state, model->getInteractionRange() + neighbourList.getSkin());
+		neighbourList.build(state, grid, model->getInteractionRange(), *pool);
+
+		// Room for the Longest Row and Its Padding on the Widest Kernel, so No Worker Grows Its Batch Until the Next Build
+		for (StepScratch &workerScratch : scratch)
+			workerScratch.batch.reserve(neighbourList.getMaxNeighbours() + getKernelWidth(KernelPath::AVX512));
+	}
+
+	SFM_PROFILE(if (profiler) profiler->addBusy(ProfilePhase::NeighbourSearch, 0, phaseStart, Clock::now()));
+	stats.neighbourSearchTime = elapsedSeconds(phaseStart);
+
+	// Agents Due for Evaluation  With multirate stepping and sleeping off every agent is, in index order
+	numEvaluated = numOwned;
+	context.agents = 0;
+
+	if (selective) {
+		selectActiveAgents(numOwned);
+		numEvaluated = activeAgents.size();
+		context.agents = activeAgents.data();
+	}
+
+	stats.agentsEvaluated = numEvaluated;
+	stats.agentsAsleep = numAsleep;		// Less those woken below
+
+	context.crowd = &state;
+	context.walls = &wallIndex;
+	context.navigation = &navigation;
+	context.stepTime = stepTime;
+
+	for (StepScratch &workerScratch : scratch)
+		workerScratch.pairsConsidered = workerScratch.pairsWithinRange = 0;
+
+	// Driving Force f_i
+	auto driveAgents = [&](size_t begin, size_t end, int worker) {
+		SFM_PROFILE_SCOPE(profiler, ProfilePhase::Driving, worker);
+		model->drivingForce(context, begin, end);
+	};
+
+	pool->parallelFor(numEvaluated, AGENTS_PER_CHUNK, driveAgents);
+	stats.drivingTime = elapsedSeconds(phaseStart);
+
+	// Agent Interaction Force f_ij
+	auto interactAgents = [&](size_t begin, size_t end, int worker) {
+		SFM_PROFILE_SCOPE(profiler, ProfilePhase::AgentInteract, worker);
+		model->agentInteractForce(context, begin, end, neighbourList, scratch[worker]);
+	};
+
+	pool->parallelFor(numEvaluated, AGENTS_PER_CHUNK, interactAgents);
+	stats.agentInteractTime = elapsedSeconds(phaseStart);
+
+	// Wall Interaction Force f_iw
+	auto interactWalls = [&](size_t begin, size_t end, int worker) {
+		SFM_PROFILE_SCOPE(profiler, ProfilePhase::WallInteract, worker);
+		SFM_PROFILE_COUNT(profiler, ProfileCounter::WallQueries, worker, end - begin);
+		model->wallInteractForce(context, begin, end);
+	};
+
+	pool->parallelFor(numEvaluated, AGENTS_PER_CHUNK, interactWalls);
+	stats.wallInteractTime = elapsedSeconds(phaseStart);
+
+	// New Velocity and Position  Every agent drifts, then agents evaluated this substep are kicked for as long as their new level allows
+	auto driftAgents = [&](size_t begin, size_t end, int worker) {
+		SFM_PROFILE_SCOPE(profiler, ProfilePhase::Integration, worker);
+		model->drift(context, begin, end);
+	};
+
+	auto integrateAgents = [&](size_t begin, size_t end, int worker) {
+		SFM_PROFILE_SCOPE(profiler, ProfilePhase::Integration, worker);
+		model->integrate(context, begin, end);
+	};
+
+	if (selective) {
+		chooseRateLevels(numOwned, stepTime);
+		pool->parallelFor(numOwned, AGENTS_PER_CHUNK, driftAgents);
+	}
+
+	pool->parallelFor(numEvaluated, AGENTS_PER_CHUNK, integrateAgents);
+	state.swapBuffers();	// Next state becomes current state
+
+	if (!ghosts.empty()) {
+		state.truncate(numOwned);
+		ghosts.clear();
+	}
+
+	stats.agentsAsleep = numAsleep;
+	stats.integrationTime = elapsedSeconds(phaseStart);
+
+	stats.pairsConsidered = stats.pairsWithinRange = 0;
+
+	for (const StepScratch &workerScratch : scratch) {
+		stats.pairsConsidered += workerScratch.pairsConsidered;
+		stats.pairsWithinRange += workerScratch.pairsWithinRange;
+	}
+
+	time += stepTime;
+	stepCount++;
+
+	// Copied on Sampled Steps Only, Measured on the Analytics Thread
+	if (analytics)
+		analytics->submit(state, stepCount, time);
+
+	stats.totalTime = elapsedSeconds(stepStart);
+
+	SFM_PROFILE(if (profiler) profiler->endStep(stepCount, time, stats));
+}
+
+bool SocialForce::reorderAgents() {
+	const vector<uint32_t> &order = curveSorter.getOrder();
+
+	if (!curveSorter.sort(state, state.size(), agentOrder, *pool))
+		return false;
+
+	// Agents Keep Their Handles and Pointers, Only Indices Change
+	state.permute(order);
+	handles.permute(order);
+	reorderedCrowd.resize(crowd.size());
+
+	for (size_t idx = 0; idx < order.size(); idx++) {
+		reorderedCrowd[idx] = crowd[order[idx]];
+		reorderedCrowd[idx]->idx = idx;
+	}
+
+	crowd.swap(reorderedCrowd);
+	neighbourList.invalidate();
+
+	return true;
+}
+
+void SocialForce::selectActiveAgents(size_t numOwned) {
+	unsigned int wereAsleep = numAsleep, fellAsleep = 0;	// Sleepers missing below were woken through 'Agent' setters
+
+	activeAgents.clear();
+	numAsleep = 0;
+
+	for (size_t idx = 0; idx < numOwned; idx++) {
+		// Agents at Rest Long Enough Fall Asleep When Next Due, Still and Without Drift
+		if (state.idleSteps[idx] == 0 && sleepDelay > 0.0F && state.restTime[idx] >= sleepDelay) {
+			state.idleSteps[idx] = ASLEEP;
+			state.velocityX[idx] = state.velocityY[idx] = 0.0F;
+			state.driftX[idx] = state.driftY[idx] = 0.0F;
+			fellAsleep++;
+		}
+
+		if (state.idleSteps[idx] == ASLEEP)
+			numAsleep++;
+		else if (state.idleSteps[idx] == 0)
+			activeAgents.push_back(idx);
+		else
+			state.idleSteps[idx]--;
+	}
+
+	stats.agentsFellAsleep += fellAsleep;
+
+	if (wereAsleep + fellAsleep > numAsleep)
+		stats.agentsWoken += wereAsleep + fellAsleep - numAsleep;
+}
+
+void SocialForce::chooseRateLevels(size_t numOwned, float substepTime) {
+	chosenLevels.resize(activeAgents.size());
+
+	for (StepScratch &workerScratch : scratch)
+		workerScratch.wakeups.clear();
+
+	// Levels are Written Aside, So Every Agent Reads Its Neighbours' Levels as They Were Before This Substep
+	auto chooseLevels = [&](size_t begin, size_t end, int worker) {
+		SFM_PROFILE_SCOPE(profiler, ProfilePhase::Integration, worker);
+
+		for (size_t entry = begin; entry < end; entry++)
+			chosenLevels[entry] = chooseRateLevel(activeAgents[entry], substepTime, scratch[worker]);
+	};
+
+	pool->parallelFor(activeAgents.size(), AGENTS_PER_CHUNK, chooseLevels);
+
+	for (size_t entry = 0; entry < activeAgents.size(); entry++) {
+		state.rateLevel[activeAgents[entry]] = chosenLevels[entry];
+		state.idleSteps[activeAgents[entry]] = (1 << chosenLevels[entry]) - 1;
+	}
+
+	// Ghosts are Woken by Their Own Rank, Which Wakes Ours in Return Before Anyone Kicks
+	for (const StepScratch &workerScratch : scratch) {
+		for (const pair<uint32_t, uint8_t> &wakeup : workerScratch.wakeups) {
+			if (wakeup.first >= numOwned)
+				ghostWakeups.push_back(make_pair(state.id[wakeup.first], wakeup.second));
+		}
+	}
+
+	if (decomposition)
+		decomposition->exchangeWakeups();
+
+	// Sleeping Neighbours Wake for the Next Substep, Neighbours Stepped More Coarsely are Evaluated Sooner  Cutting a kick short is
+	// bounded by its tolerance
+	for (const StepScratch &workerScratch : scratch) {
+		for (const pair<uint32_t, uint8_t> &wakeup : workerScratch.wakeups) {
+			if (wakeup.first < numOwned)
+				wakeAgent(wakeup.first, wakeup.second);
+		}
+	}
+}
+
+void SocialForce::wakeAgent(size_t idx, int level) {
+	if (state.idleSteps[idx] == ASLEEP) {
+		state.wake(idx);
+		stats.agentsWoken++;
+		stats.agentsAsleep = --numAsleep;
+	}
+
+	else if (state.rateLevel[idx] > level) {
+		state.rateLevel[idx] = level;
+		state.idleSteps[idx] = min<int>(state.idleSteps[idx], (1 << level) - 1);
+	}
+}
+
+// Longest Kick Within Tolerance  Neither its velocity change nor the closing of the gap to any neighbour or wall in the neighbour
+// list may exceed 'rateTolerance' of desired speed and gap  Levels climb one at a time and drop at once
+int SocialForce::chooseRateLevel(size_t idx, float substepTime, StepScratch &scratch) {
+	const float rangeSquared = model->getInteractionRange() * model->getInteractionRange();
+	const int *neighbours = neighbourList.getNeighbours(idx);
+	size_t numNeighbours = neighbourList.getNumNeighbours(idx);
+	float accelerationSquared, speedSquared, limit = numeric_limits<float>::max(), distanceX, distanceY, distance, closing;
+	int level = 0;
+
+	accelerationSquared = state.forceX[idx] * state.forceX[idx] + state.forceY[idx] * state.forceY[idx];
+	speedSquared = state.velocityX[idx] * state.velocityX[idx] + state.velocityY[idx] * state.velocityY[idx];
+
+	if (maxRateLevel > 0) {
+		// Velocity Change of the Kick
+		if (accelerationSquared > 0.0F)
+			limit = rateTolerance * state.desiredSpeed[idx] / sqrt(accelerationSquared);
+
+		// Neighbours Approaching Within Interaction Range, Closing Speed Along the Line Between Centres  Entries of the list beyond the
+		// range depend on when it was built, and ghosts do not reach that far
+		for (size_t k = 0; k < numNeighbours; k++) {
+			int j = neighbours[k];
+
+			distanceX = state.positionX[j] - state.positionX[idx];
+			distanceY = state.positionY[j] - state.positionY[idx];
+
+			if (distanceX * distanceX + distanceY * distanceY > rangeSquared)
+				continue;
+
+			distance = sqrt(distanceX * distanceX + distanceY * distanceY);
+			closing = ((state.velocityX[idx] - state.velocityX[j]) * distanceX + (state.velocityY[idx] - state.velocityY[j]) * distanceY) / max(distance, MIN_GAP);
+
+			if (closing > 0.0F)
+				limit = min(limit, rateTolerance * max(distance - state.radius[idx] - state.radius[j], MIN_GAP) / closing);
+		}
+
+		// Nearest Wall, Vector Points From Wall to Agent
+		if (wallIndex.nearest(state.positionX[idx], state.positionY[idx], distanceX, distanceY, distance)) {
+			distance = sqrt(distance);
+			closing = -(state.velocityX[idx] * distanceX + state.velocityY[idx] * distanceY) / max(distance, MIN_GAP);
+
+			if (closing > 0.0F)
+				limit = min(limit, rateTolerance * max(distance - state.radius[idx], MIN_GAP) / closing);
+		}
+
+		while (level < maxRateLevel && level <= state.rateLevel[idx] && substepTime * (2 << level) <= limit)
+			level++;
+	}
+
+	// Neighbours in Range More Than One Level Coarser Wake Early, So Each Feels This Agent Within Twice Its Kick
+	for (size_t k = 0; level + 1 < maxRateLevel && k < numNeighbours; k++) {
+		int j = neighbours[k];
+
+		distanceX = state.positionX[j] - state.positionX[idx];
+		distanceY = state.positionY[j] - state.positionY[idx];
+
+		if (state.rateLevel[j] > level + 1 && distanceX * distanceX + distanceY * distanceY <= rangeSquared)
+			scratch.wakeups.push_back(make_pair(static_cast<uint32_t>(j), static_cast<uint8_t>(level + 1)));
+	}
+
+	// Rest Adds Up Over Evaluations Below Both Thresholds, Any Other Evaluation Starts It Again
+	if (sleepDelay > 0.0F) {
+		if (speedSquared < sleepSpeed * sleepSpeed && accelerationSquared < sleepAcceleration * sleepAcceleration)
+			state.restTime[idx] += substepTime * (1 << level);
+		else
+			state.restTime[idx] = 0.0F;
+
+		wakeSleepers(idx, scratch);
+	}
+
+	return level;
+}
+
+void SocialForce::wakeSleepers(size_t idx, StepScratch &scratch) const {
+	const float rangeSquared = model->getInteractionRange() * model->getInteractionRange();
+	const int *neighbours = neighbourList.getNeighbours(idx);
+	size_t numNeighbours = neighbourList.getNumNeighbours(idx);
+	float distanceX, distanceY;
+
+	// Agents Slow Enough to Sleep Themselves Leave Their Neighbours Asleep
+	if (state.velocityX[idx] * state.velocityX[idx] + state.velocityY[idx] * state.velocityY[idx] <= sleepSpeed * sleepSpeed)
+		return;
+
+	for (size_t k = 0; k < numNeighbours; k++) {
+		int j = neighbours[k];
+
+		distanceX = state.positionX[j] - state.positionX[idx];
+		distanceY = state.positionY[j] - state.positionY[idx];
+
+		if (state.idleSteps[j] == ASLEEP && distanceX * distanceX + distanceY * distanceY <= rangeSquared)
+			scratch.wakeups.push_back(make_pair(static_cast<uint32_t>(j), static_cast<uint8_t>(0)));
+	}
+}
+
+void SocialForce::wakeAgents() {
+	for (size_t idx = 0; idx < state.size(); idx++)
+		state.wake(idx);
+
+	numAsleep = 0;
+}
+
+void SocialForce::updateBoundaries(float stepTime) {
+	const double endTime = time + stepTime;
+
+	// Retire Agents in Sinks, Removed Together in One Pass
+	retiring.clear();
+
+	if (!sinks.empty()) {
+		for (size_t idx = 0; idx < state.size(); idx++) {
+			for (Sink &sink : sinks) {
+				if (sink.contains(state.positionX[idx], state.positionY[idx])) {
+					retiring.push_back(idx);
+					sink.numRetired++;
+					break;
+				}
+			}
+		}
+
+		eraseAgents(retiring);
+	}
+
+	stats.agentsRetired = retiring.size();
+
+	// Spawn Every Arrival Due Before the End of the Step
+	arriving.clear();
+
+	for (Source &source : sources) {
+		float x, y;
+		bool collected = false;
+
+		if (isnan(source.nextArrival))
+			source.nextArrival = time;		// First arrival at the start of the first step
+
+		while (source.rate > 0.0F && source.nextArrival < endTime && !source.isExhausted()) {
+			// Agents Already Near the Source, Gathered Once per Source and Step
+			if (!collected) {
+				const float reach = source.radius + 1.0F;
+
+				occupiedX.clear();
+				occupiedY.clear();
+				occupiedRadius.clear();
+
+				for (size_t idx = 0; idx < state.size(); idx++) {
+					if (state.positionX[idx] >= source.minX - reach && state.positionX[idx] <= source.maxX + reach &&
+						state.positionY[idx] >= source.minY - reach && state.positionY[idx] <= source.maxY + reach) {
+						occupiedX.push_back(state.positionX[idx]);
+						occupiedY.push_back(state.positionY[idx]);
+						occupiedRadius.push_back(state.radius[idx]);
+					}
+				}
+
+				collected = true;
+			}
+
+			// Crowded Source Keeps the Arrival Waiting, Like a Queue at the Entrance
+			if (!placeArrival(source, x, y))
+				break;
+
+			Agent *agent = new Agent;
+			normal_distribution<float> speedDistribution(source.speedMean, source.speedDeviation);
+
+			agent->radius = source.radius;
+			agent->desiredSpeed = max(speedDistribution(generator), 0.1F);
+			agent->colour = source.colour;
+			agent->position.set(x, y, 0.0);
+			agent->path = source.path;
+			agent->target = source.target;
+			arriving.push_back(agent);
+
+			occupiedX.push_back(x);
+			occupiedY.push_back(y);
+			occupiedRadius.push_back(source.radius);
+			source.numSpawned++;
+
+			if (source.arrivals == ArrivalProcess::Poisson) {
+				exponential_distribution<double> gapDistribution(source.rate);
+				source.nextArrival += gapDistribution(generator);
+			}
+
+			else
+				source.nextArrival += 1.0 / source.rate;
+		}
+	}
+
+	// Insert Arrivals Together, Storage Grows Once
+	if (!arriving.empty()) {
+		growAgents(arriving.size());
+
+		for (Agent *agent : arriving)
+			insertAgent(agent);
+
+		neighbourList.invalidate();
+	}
+
+	stats.agentsSpawned = arriving.size();
+}
+
+bool SocialForce::placeArrival(const Source &source, float &x, float &y) {
+	uniform_real_distribution<float> distributionX(source.minX, source.maxX), distributionY(source.minY, source.maxY);
+	float distanceX, distanceY, minDistance;
+	bool free;
+
+	for (int attempt = 0; attempt < SPAWN_ATTEMPTS; attempt++) {
+		x = distributionX(generator);
+		y = distributionY(generator);
+		free = true;
+
+		for (size_t idx = 0; free && idx < occupiedX.size(); idx++) {
+			distanceX = occupiedX[idx] - x;
+			distanceY = occupiedY[idx] - y;
+			minDistance = occupiedRadius[idx] + source.radius;
+			free = (distanceX * distanceX + distanceY * distanceY) >= minDistance * minDistance;
+		}
+
+		if (free)
+			return true;
+	}
+
+	return false;
+}
+
+float SocialForce::drawUniform(float lowerBound, float upperBound) {
+	uniform_real_distribution<float> distribution(lowerBound, upperBound);
+
+	return distribution(generator);
+}
+
+int SocialForce::advance(float elapsedTime) {
+	int numSteps = 0;
+
+	accumulator += max(elapsedTime, 0.0F);
+
+	// Same Step Length Whatever the Frame Time, So a Stall Cannot Make Agents Tunnel
+	while (accumulator >= stepTime && numSteps < maxStepsPerAdvance) {
+		for (int substep = 0; substep < numSubsteps; substep++)
+			moveCrowd(stepTime / numSubsteps);
+
+		accumulator -= stepTime;
+		numSteps++;
+	}
+
+	// Drop Time That Could Not Be Simulated, Otherwise Each Call Falls Further Behind
+	if (accumulator >= stepTime)
+		accumulator = fmod(accumulator, stepTime);
+
+	return numSteps;
+}
+
+bool SocialForce::saveCheckpoint(const char *path) const {
+	FILE *file = fopen(path, "wb");
+	stringstream generatorState;
+	string generatorText;
+	unsigned int numAgents = state.size(), numWalls = walls.size(), numTargets = state.targets.size(), numSources = sources.size(), numSinks = sinks.size(), integrator = static_cast<unsigned int>(model->getIntegrator());
+	bool succeeded;
+
+	if (!file)
+		return false;
+
+	generatorState << generator;
+	generatorText = generatorState.str();
+
+	// Header, Clock and Settings
+	succeeded = fwrite(CHECKPOINT_MAGIC, 1, sizeof(CHECKPOINT_MAGIC), file) == sizeof(CHECKPOINT_MAGIC) &&
+				writeValue(file, CHECKPOINT_VERSION) && writeValue(file, time) && writeValue(file, stepCount) &&
+				writeValue(file, accumulator) && writeValue(file, stepTime) && writeValue(file, numSubsteps) &&
+				writeValue(file, integrator) && writeValue(file, maxRateLevel) && writeValue(file, rateTolerance) &&
+				writeValue(file, sleepDelay) && writeValue(file, sleepSpeed) && writeValue(file, sleepAcceleration) &&
+				writeValue(file, static_cast<unsigned int>(generatorText.size())) &&
+				fwrite(generatorText.data(), 1, generatorText.size(), file) == generatorText.size();
+
+	// Walls
+	succeeded = succeeded && writeValue(file, numWalls);
+
+	for (size_t idx = 0; succeeded && idx < walls.size(); idx++) {
+		float segment[4] = { walls[idx]->getStartPoint().x, walls[idx]->getStartPoint().y, walls[idx]->getEndPoint().x, walls[idx]->getEndPoint().y };
+		succeeded = fwrite(segment, sizeof(float), 4, file) == 4;
+	}
+
+	// Shared Targets, Sources and Sinks
+	succeeded = succeeded && writeValue(file, numTargets) && writeArray(file, state.targets) && writeValue(file, numSources);
+
+	for (size_t idx = 0; succeeded && idx < sources.size(); idx++)
+		succeeded = writeSource(file, sources[idx]);
+
+	succeeded = succeeded && writeValue(file, numSinks);
+
+	for (size_t idx = 0; succeeded && idx < sinks.size(); idx++)
+		succeeded = writeValue(file, sinks[idx].minX) && writeValue(file, sinks[idx].minY) && writeValue(file, sinks[idx].maxX) &&
+					writeValue(file, sinks[idx].maxY) && writeValue(file, sinks[idx].numRetired);
+
+	// Agents, One Array at a Time
+	succeeded = succeeded && writeValue(file, numAgents) && writeArray(file, state.id) && writeArray(file, state.radius) &&
+				writeArray(file, state.desiredSpeed) && writeArray(file, state.colour) && writeArray(file, state.positionX) &&
+				writeArray(file, state.positionY) && writeArray(file, state.velocityX) && writeArray(file, state.velocityY) &&
+				writeArray(file, state.accelerationX) && writeArray(file, state.accelerationY) && writeArray(file, state.pathIdx) &&
+				writeArray(file, state.target) && writeArray(file, state.driftX) && writeArray(file, state.driftY) &&
+				writeArray(file, state.rateLevel) && writeArray(file, state.idleSteps) && writeArray(file, state.restTime);
+
+	// Routes, Including the Waypoint Cursor Above
+	for (size_t idx = 0; succeeded && idx < state.size(); idx++) {
+		const vector<Waypoint> &route = state.routes[state.route[idx]];
+		succeeded = writeValue(file, static_cast<unsigned int>(route.size())) && writeArray(file, route);
+	}
+
+	return (fclose(file) == 0) && succeeded;
+}
+
+bool SocialForce::loadCheckpoint(const char *path) {
+	FILE *file = fopen(path, "rb");
+	char magic[sizeof(CHECKPOINT_MAGIC)];
+	unsigned int version, integrator, generatorSize, numWalls, numTargets, numSources, numSinks, numAgents, routeSize;
+	double savedTime;
+	unsigned long long savedStepCount;
+	float savedAccumulator, savedStepTime, savedTolerance, savedSleep[3];
+	int savedSubsteps, savedRateLevel;
+	string generatorText;
+	CounterRandom savedGenerator;
+	vector<float> segments;
+	vector<Waypoint> targets;
+	vector<Source> savedSources;
+	vector<Sink> savedSinks;
+	CrowdState saved;
+	vector<vector<Waypoint> > routes;
+	bool succeeded;
+
+	if (!file)
+		return false;
+
+	// Read Everything First, So a Damaged File Leaves the Scene as It Was
+	succeeded = fread(magic, 1, sizeof(magic), file) == sizeof(magic) && memcmp(magic, CHECKPOINT_MAGIC, sizeof(magic)) == 0 &&
+				readValue(file, version) && version == CHECKPOINT_VERSION && readValue(file, savedTime) &&
+				readValue(file, savedStepCount) && readValue(file, savedAccumulator) && readValue(file, savedStepTime) &&
+				readValue(file, savedSubsteps) && readValue(file, integrator) && integrator <= static_cast<unsigned int>(Integrator::VelocityVerlet) &&
+				readValue(file, savedRateLevel) && savedRateLevel >= 0 && savedRateLevel <= MAX_RATE_LEVEL && readValue(file, savedTolerance) &&
+				readValue(file, savedSleep[0]) && readValue(file, savedSleep[1]) && readValue(file, savedSleep[2]) &&
+				readValue(file, generatorSize) && generatorSize < (1U << 16);
+
+	if (succeeded) {
+		generatorText.resize(generatorSize);
+		succeeded = generatorSize == 0 || fread(&generatorText[0], 1, generatorSize, file) == generatorSize;
+	}
+
+	if (succeeded) {
+		stringstream generatorState(generatorText);
+		succeeded = static_cast<bool>(generatorState >> savedGenerator);
+	}
+
+	succeeded = succeeded && readValue(file, numWalls) && readArray(file, segments, 4 * static_cast<size_t>(numWalls)) &&
+				readValue(file, numTargets) && readArray(file, targets, numTargets) && readValue(file, numSources);
+
+	for (unsigned int idx = 0; succeeded && idx < numSources; idx++) {
+		savedSources.push_back(Source(0.0F, 0.0F, 0.0F, 0.0F, 0.0F));
+		succeeded = readSource(file, savedSources.back()) && savedSources.back().target < static_cast<int>(numTargets);
+	}
+
+	succeeded = succeeded && readValue(file, numSinks);
+
+	for (unsigned int idx = 0; succeeded && idx < numSinks; idx++) {
+		savedSinks.push_back(Sink(0.0F, 0.0F, 0.0F, 0.0F));
+		succeeded = readValue(file, savedSinks.back().minX) && readValue(file, savedSinks.back().minY) &&
+					readValue(file, savedSinks.back().maxX) && readValue(file, savedSinks.back().maxY) &&
+					readValue(file, savedSinks.back().numRetired);
+	}
+
+	succeeded = succeeded && readValue(file, numAgents) && readArray(file, saved.id, numAgents) && readArray(file, saved.radius, numAgents) &&
+				readArray(file, saved.desiredSpeed, numAgents) && readArray(file, saved.colour, numAgents) &&
+				readArray(file, saved.positionX, numAgents) && readArray(file, saved.positionY, numAgents) &&
+				readArray(file, saved.velocityX, numAgents) && readArray(file, saved.velocityY, numAgents) &&
+				readArray(file, saved.accelerationX, numAgents) && readArray(file, saved.accelerationY, numAgents) &&
+				readArray(file, saved.pathIdx, numAgents) && readArray(file, saved.target, numAgents) &&
+				readArray(file, saved.driftX, numAgents) && readArray(file, saved.driftY, numAgents) &&
+				readArray(file, saved.rateLevel, numAgents) && readArray(file, saved.idleSteps, numAgents) &&
+				readArray(file, saved.restTime, numAgents);
+
+	for (unsigned int idx = 0; succeeded && idx < numAgents; idx++) {
+		routes.push_back(vector<Waypoint>());
+		succeeded = saved.target[idx] >= -1 && saved.target[idx] < static_cast<int>(numTargets) && saved.rateLevel[idx] <= savedRateLevel &&
+					(saved.idleSteps[idx] < (1 << saved.rateLevel[idx]) || saved.idleSteps[idx] == ASLEEP) &&
+					readValue(file, routeSize) && readArray(file, routes.back(), routeSize) &&
+					(routeSize == 0 || (saved.pathIdx[idx] >= 0 && static_cast<unsigned int>(saved.pathIdx[idx]) < routeSize));
+	}
+
+	fclose(file);
+
+	if (!succeeded)
+		return false;
+
+	// Rebuild Scene
+	removeCrowd();
+	removeWalls();
+	sources = savedSources;
+	sinks = savedSinks;
+
+	for (size_t idx = 0; idx < numWalls; idx++)
+		addWall(new Wall(segments[4 * idx], segments[4 * idx + 1], segments[4 * idx + 2], segments[4 * idx + 3]));
+
+	state.targets = targets;
+
+	for (size_t idx = 0; idx < numAgents; idx++) {
+		Agent *agent = new Agent;
+
+		agent->id = saved.id[idx];
+		agent->radius = saved.radius[idx];
+		agent->desiredSpeed = saved.desiredSpeed[idx];
+		agent->colour = saved.colour[idx];
+		agent->position.set(saved.positionX[idx], saved.positionY[idx], 0.0);
+		agent->path = routes[idx];
+		agent->target = saved.target[idx];
+		insertAgent(agent);
+
+		state.velocityX[idx] = saved.velocityX[idx];
+		state.velocityY[idx] = saved.velocityY[idx];
+		state.accelerationX[idx] = saved.accelerationX[idx];
+		state.accelerationY[idx] = saved.accelerationY[idx];
+		state.pathIdx[idx] = saved.pathIdx[idx];
+		state.driftX[idx] = saved.driftX[idx];
+		state.driftY[idx] = saved.driftY[idx];
+		state.rateLevel[idx] = saved.rateLevel[idx];
+		state.idleSteps[idx] = saved.idleSteps[idx];
+		state.restTime[idx] = saved.restTime[idx];
+		numAsleep += (saved.idleSteps[idx] == ASLEEP);
+	}
+
+	// Clock, Settings and Random Generator
+	time = savedTime;
+	stepCount = savedStepCount;
+	stepTime = savedStepTime;
+	numSubsteps = savedSubsteps;
+	maxRateLevel = savedRateLevel;
+	rateTolerance = savedTolerance;
+	sleepDelay = savedSleep[0];
+	sleepSpeed = savedSleep[1];
+	sleepAcceleration = savedSleep[2];
+	accumulator = savedAccumulator;
+	model->setIntegrator(static_cast<Integrator>(integrator));
+	generator = savedGenerator;
+	wakePending = false;		// Same walls as when saved, agents keep sleeping
+
+	return true;
+}
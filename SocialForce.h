@@ -3,29 +3,230 @@
 
 #include <vector>
 #include "Agent.h"
+#include "Boundary.h"
 #include "Wall.h"
+#include "CounterRandom.h"
+#include "CrowdAnalytics.h"
+#include "CrowdState.h"
+#include "ForceModel.h"
+#include "Navigation.h"
+#include "NeighbourList.h"
+#include "Profiler.h"
+#include "SpaceFillingCurve.h"
+#include "SpatialGrid.h"
+#include "WallIndex.h"
+#include "ThreadPool.h"
+
+// Timings (Seconds) and Counters of the Last Call to 'SocialForce::moveCrowd()'
+struct StepStats {
+	double boundaryTime;			// Retiring agents in sinks and spawning arrivals of sources
+	double neighbourSearchTime;		// Checking and rebuilding 'NeighbourList' (and 'WallIndex' and flow fields when walls or targets changed,
+									// and sorting agents along the space-filling curve when due)
+	double drivingTime;
+	double agentInteractTime;
+	double wallInteractTime;
+	double integrationTime;
+	double totalTime;
+
+	unsigned long long pairsConsidered;		// Neighbour list entries
+	unsigned long long pairsWithinRange;	// Pairs passed to the interaction kernel
+	bool neighbourListRebuilt;
+	bool agentsReordered;
+	unsigned int agentsSpawned, agentsRetired;
+	unsigned int agentsEvaluated;			// Agents whose forces were computed, all of them unless multirate stepping or sleeping is on
+	unsigned int agentsAsleep;				// At the end of the step
+	unsigned int agentsFellAsleep, agentsWoken;
+
+	StepStats() { reset(); }
+	void reset();
+};
+
+class DomainDecomposition;
+
+// Agent Held by Another Rank of a 'DomainDecomposition'  Also the record gathered for output
+struct RemoteAgent {
+	int id;
+	float radius;
+	float x, y;
+	float velocityX, velocityY;
+	uint8_t rateLevel, idleSteps;	// Multirate and sleep state, so ranks wake each other's agents as one engine would
+};
+
+// Motion of an Agent Beyond What 'Agent' Carries, So It Can Move to Another Engine and Carry On Exactly Where It Left
+struct AgentDynamics {
+	float velocityX, velocityY;
+	float accelerationX, accelerationY;
+	float driftX, driftY;
+	float restTime;
+	int pathIdx;
+	uint8_t rateLevel, idleSteps;
+};
 
 class SocialForce {
 private:
-	std::vector<Agent *> crowd;
+	CrowdState state;					// Primary storage of all agents
+	std::vector<Agent *> crowd;			// Handles to agents in 'state' (same order)
+	HandleMap handles;					// Generational handles to indices of 'state'
+	int nextId;							// Id of the next agent added
+	int idStride;						// Added to 'nextId' per agent, so ranks of a decomposition draw disjoint ids
 	std::vector<Wall *> walls;
+	WallIndex wallIndex;				// Rebuilt only when walls change
+	bool wallsChanged;
+	Navigation navigation;				// Flow fields to the shared targets in 'state'
+	std::vector<Source> sources;
+	std::vector<Sink> sinks;
+	std::vector<size_t> retiring;		// Scratch of 'updateBoundaries()', capacity reused across steps
+	std::vector<Agent *> arriving;
+	std::vector<float> occupiedX, occupiedY, occupiedRadius;
+	std::vector<RemoteAgent> ghosts;	// Neighbours owned by other ranks, appended to 'state' for the next step only
+	std::vector<int> ghostIds;			// Ghosts of the previous step, the neighbour list still holds while the same ones follow
+	std::vector<std::pair<int, uint8_t> > ghostWakeups;	// Ghosts woken during this step by id, with the level they wake to
+	DomainDecomposition *decomposition;	// Not owned, null unless split across ranks
+
+	ForceModel *model;					// Owned
+	SpatialGrid grid;					// Rebuilt with the neighbour list
+	NeighbourList neighbourList;
+	SpaceCurve agentOrder;				// Curve 'state' is sorted along, so agents near in space are near in memory
+	int reorderInterval;				// Steps between sorts, 0 never sorts
+	CurveSorter curveSorter;
+	std::vector<Agent *> reorderedCrowd;	// Scratch of 'reorderAgents()'
+	ThreadPool *pool;
+	std::vector<StepScratch> scratch;	// One per worker thread
+	StepStats stats;
+	Profiler *profiler;					// Not owned, null when not profiling
+	CrowdAnalytics *analytics;			// Not owned, null when not measuring
+
+	// Fixed Time Stepping
+	float stepTime;						// Simulated seconds per 'advance()' step
+	int numSubsteps;					// 'moveCrowd()' calls per step
+	int maxStepsPerAdvance;				// Steps beyond this are dropped instead of caught up
+	float accumulator;					// Elapsed time not yet simulated
+	double time;						// Simulated seconds
+	unsigned long long stepCount;		// Calls to 'moveCrowd()'
+
+	// Multirate Stepping  Agents in free flow evaluate forces every 2^level substeps and drift in between, so every agent
+	// moves every substep and forces always see neighbours at the current time
+	int maxRateLevel;					// Agents step up to 2^maxRateLevel substeps at once, 0 steps every agent every substep
+	float rateTolerance;				// Share of an agent's desired speed, or of the gap to a neighbour or wall, one kick may use up
+	std::vector<uint32_t> activeAgents;	// Agents whose forces are evaluated this substep
+	std::vector<uint8_t> chosenLevels;	// Scratch of 'chooseRateLevels()', one per entry of 'activeAgents'
+
+	// Sleeping  Agents nearly still under nearly balanced forces are skipped until a moving neighbour, or a change to them, wakes them
+	float sleepDelay;					// Seconds below both thresholds before an agent sleeps, 0 never sleeps
+	float sleepSpeed;					// Metres per second, also the speed of a neighbour that wakes a sleeping agent
+	float sleepAcceleration;			// Net force per unit mass
+	unsigned int numAsleep;
+	bool wakePending;					// Walls were added or removed, every agent wakes before the next step
+
+	CounterRandom generator;			// Draws agent properties not set by the caller, and scene layouts through 'drawUniform()'
+
+	AgentHandle insertAgent(Agent *agent);	// Binds 'agent' and appends it to 'crowd'
+	void growAgents(size_t count);			// Room for 'count' more agents  Capacity at least doubles, so a growing crowd reallocates rarely
+	void eraseAgent(size_t idx);			// Deletes agent at 'idx'  Last agent takes its place
+	void eraseAgents(std::vector<size_t> &indices);	// Sorts 'indices', duplicates are removed once
+	void updateBoundaries(float stepTime);	// Retires agents in sinks, then spawns arrivals due before the end of the step
+	bool placeArrival(const Source &source, float &x, float &y);	// Free position in 'source' for one agent
+	bool reorderAgents();					// Sorts 'state', 'crowd' and 'handles' along 'agentOrder'  False if already in order
+	void selectActiveAgents(size_t numOwned);	// Fills 'activeAgents' with agents due for evaluation, counts down the others
+	void chooseRateLevels(size_t numOwned, float substepTime);	// Rate levels and rest of active agents, then wakes neighbours
+	int chooseRateLevel(size_t idx, float substepTime, StepScratch &scratch);
+	void wakeSleepers(size_t idx, StepScratch &scratch) const;	// Queues sleeping neighbours of a moving agent, ghosts included
+	void wakeAgents();						// Every agent is evaluated next substep at rate level 0
 
 public:
-	//SocialForce();
+	explicit SocialForce(int numThreads = 0);	// 0 uses every hardware thread
 	~SocialForce();
 
-	void addAgent(Agent *agent);
+	SocialForce(const SocialForce &) = delete;
+	SocialForce &operator=(const SocialForce &) = delete;
+
+	AgentHandle addAgent(Agent *agent);			// Takes ownership
+	AgentHandle adoptAgent(Agent *agent, const AgentDynamics &dynamics);	// Agent moved from another engine, keeps its id, speed and motion
+	void addAgents(const std::vector<Agent *> &agents);	// Takes ownership, grows storage once
+	void reserveAgents(size_t capacity);	// Avoids reallocation while spawning up to 'capacity' agents
 	void addWall(Wall *wall);
+	int addTarget(float x, float y, float radius);	// Shared target for 'Agent::setTarget()'  Returns its index
+	int addSource(const Source &source);	// Returns its index
+	int addSink(const Sink &sink);
+	void setNumThreads(int numThreads);	// 1 runs every step on the calling thread
+	void setForceModel(ForceModel *model);	// Takes ownership, keeps kernel path, math mode and integrator  Default 'MoussaidForceModel'
+	void setKernelPath(KernelPath path) { model->setKernelPath(path); }	// Defaults to widest path this CPU supports
+	void setMathMode(MathMode mode) { model->setMathMode(mode); }		// Fast trades accuracy for speed within the budget in FastMath.h
+	void setIntegrator(Integrator integrator) { model->setIntegrator(integrator); }
+	void setTimeStep(float stepTime, int numSubsteps = 1);
+	void setMaxStepsPerAdvance(int maxSteps) { maxStepsPerAdvance = maxSteps > 1 ? maxSteps : 1; }
+	void setMultirate(int maxLevel, float tolerance = 0.1F);	// Default 0 evaluates every agent every substep, up to 7  Agents start again at level 0
+	void setSleep(float delay, float speed = 0.05F, float acceleration = 0.2F);	// Default 0 never sleeps  Wakes every agent
+	void setSeed(unsigned long long seed, unsigned long long stream = 0) { generator.seed(seed, stream); }	// Runs with different streams draw independently
+	void setIdSequence(int nextId, int stride);	// Ids of added agents are 'nextId', 'nextId + stride', ...  Restored ids keep the sequence
+	void setGhosts(const std::vector<RemoteAgent> &ghosts) { this->ghosts = ghosts; }	// Interact with the crowd during the next step, then dropped
+																					// Keep them in the same order while the same agents are sent
+																					// Ghosts the crowd wakes are left in 'getGhostWakeups()'
+	void setDecomposition(DomainDecomposition *decomposition) { this->decomposition = decomposition; }	// Exchanges wakeups mid-step until reset to null
+	void setNeighbourSkin(float skin) { neighbourList.setSkin(skin); }	// Default 0.3 m, 0 rebuilds the list every step
+	void setAgentOrder(SpaceCurve curve, int interval = 100);	// Default Morton every 100 steps  Handles and agent pointers stay valid, indices do not
+	void setProfiler(Profiler *profiler) { this->profiler = profiler; }	// Records every step until reset to null  No effect unless SFM_PROFILING is defined
+	void setAnalytics(CrowdAnalytics *analytics) { this->analytics = analytics; }	// Offered the crowd after every step until reset to null
+	void setNavigationCellSize(float cellSize) { navigation.setCellSize(cellSize); }	// Default 0.25 m
+	void setNavigationClearance(float clearance) { navigation.setClearance(clearance); }	// Default 0.3 m kept between paths and walls
 
-	const std::vector<Agent *> getCrowd() const { return crowd; }
+	const CrowdState &getState() const { return state; }
+	const std::vector<Agent *> &getCrowd() const { return crowd; }
 	int getCrowdSize() const { return crowd.size(); }
-	const std::vector<Wall *> getWalls() const { return walls; }
+	size_t getNumGhosts() const { return ghosts.size(); }
+	Agent *getAgent(AgentHandle handle) const;		// Null once the agent is removed
+	bool isAlive(AgentHandle handle) const { size_t idx; return handles.find(handle, idx); }
+	const std::vector<Wall *> &getWalls() const { return walls; }
 	int getNumWalls() const { return walls.size(); }
+	int getNumTargets() const { return state.targets.size(); }
+	const std::vector<Source> &getSources() const { return sources; }
+	const std::vector<Sink> &getSinks() const { return sinks; }
+	unsigned long long getNumSpawned() const;
+	unsigned long long getNumRetired() const;
+	const Navigation &getNavigation() const { return navigation; }
+	int getNumThreads() const { return pool->getNumThreads(); }
+	const ForceModel &getForceModel() const { return *model; }
+	KernelPath getKernelPath() const { return model->getKernelPath(); }
+	MathMode getMathMode() const { return model->getMathMode(); }
+	const StepStats &getStepStats() const { return stats; }
+	Integrator getIntegrator() const { return model->getIntegrator(); }
+	float getNeighbourSkin() const { return neighbourList.getSkin(); }
+	unsigned long long getNeighbourListBuilds() const { return neighbourList.getNumBuilds(); }
+	SpaceCurve getAgentOrder() const { return agentOrder; }
+	int getReorderInterval() const { return reorderInterval; }
+	float getTimeStep() const { return stepTime; }
+	int getNumSubsteps() const { return numSubsteps; }
+	int getMaxRateLevel() const { return maxRateLevel; }
+	float getRateTolerance() const { return rateTolerance; }
+	float getSleepDelay() const { return sleepDelay; }
+	float getSleepSpeed() const { return sleepSpeed; }
+	float getSleepAcceleration() const { return sleepAcceleration; }
+	int getNumAsleep() const { return numAsleep; }
+	int getNextId() const { return nextId; }
+	void getDynamics(size_t idx, AgentDynamics &dynamics) const;	// Of agent 'idx' of 'getState()'
+	const std::vector<std::pair<int, uint8_t> > &getGhostWakeups() const { return ghostWakeups; }	// For their own rank's 'wakeAgent()'
+	size_t getNumOwned() const { return crowd.size(); }		// Agents of 'getState()' before the ghosts, also during a step
+	double getTime() const { return time; }
+	unsigned long long getStepCount() const { return stepCount; }
+	float getInterpolation() const { return accumulator / stepTime; }	// Fraction of a step left in the accumulator
 
 	void removeAgent();		// Removes individual or single group
-	void removeCrowd();		// Remove all individuals and groups
+	bool removeAgent(AgentHandle handle);	// O(1), last agent takes the removed agent's index  False if already removed
+	void removeAgents(const std::vector<AgentHandle> &handles);	// Skips stale handles
+	void removeAgentsAt(std::vector<size_t> &indices) { eraseAgents(indices); }	// Indices of 'getState()'  Sorts 'indices'
+	void wakeAgent(size_t idx, int level);	// Evaluated within 2^level substeps, or on the next one if asleep, as an evaluated neighbour wakes it
+	void removeSourcesOutside(float minX, float maxX);	// Keeps the sources whose centre lies in [minX, maxX)
+	void removeCrowd();		// Remove all individuals and groups  Shared targets stay, sources may still send agents to them
+	void removeTargets();	// Agents and sources heading for a shared target follow their paths instead
 	void removeWalls();
-	void moveCrowd(float stepTime);
+	void removeBoundaries();	// Remove all sources and sinks
+	void moveCrowd(float stepTime);		// One step of 'stepTime', regardless of the fixed time step
+	float drawUniform(float lowerBound, float upperBound);	// From this engine's random stream, for laying out scenes
+	int advance(float elapsedTime);		// Fixed steps covering 'elapsedTime' plus carried remainder  Returns steps taken
+
+	// Binary Snapshot of Agents, Walls, Time, Stepping Settings and Random Generator  Not portable across architectures
+	bool saveCheckpoint(const char *path) const;
+	bool loadCheckpoint(const char *path);		// Replaces the scene  Leaves it unchanged if the file is unreadable
 };
 
-#endif
\ No newline at end of file
+#endif
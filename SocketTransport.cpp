@@ -0,0 +1,165 @@
+#include <cerrno>
+#include <cstdio>
+#include <sys/socket.h>
+#include <sys/types.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#include "SocketTransport.h"
+using namespace std;
+
+// Whole Buffers Over a Stream Socket  Retries after signals and partial transfers
+static bool sendAll(int socket, const void *data, size_t size) {
+	const char *bytes = static_cast<const char *>(data);
+
+	while (size > 0) {
+		ssize_t sent = send(socket, bytes, size, MSG_NOSIGNAL);
+
+		if (sent < 0 && errno == EINTR)
+			continue;
+
+		if (sent <= 0)
+			return false;
+
+		bytes += sent;
+		size -= sent;
+	}
+
+	return true;
+}
+
+static bool receiveAll(int socket, void *data, size_t size) {
+	char *bytes = static_cast<char *>(data);
+
+	while (size > 0) {
+		ssize_t received = recv(socket, bytes, size, 0);
+
+		if (received < 0 && errno == EINTR)
+			continue;
+
+		if (received <= 0)
+			return false;
+
+		bytes += received;
+		size -= received;
+	}
+
+	return true;
+}
+
+// Length in Host Byte Order, Then the Bytes  Both ends run on the same machine
+static bool sendMessage(int socket, const vector<char> &message) {
+	unsigned long long size = message.size();
+
+	return sendAll(socket, &size, sizeof(size)) && (size == 0 || sendAll(socket, message.data(), size));
+}
+
+static bool receiveMessage(int socket, vector<char> &message) {
+	unsigned long long size;
+
+	if (!receiveAll(socket, &size, sizeof(size)))
+		return false;
+
+	message.resize(size);
+	return size == 0 || receiveAll(socket, message.data(), size);
+}
+
+SocketTransport::SocketTransport(int rank, const vector<int> &sockets) {
+	this->rank = rank;
+	this->sockets = sockets;
+}
+
+SocketTransport::~SocketTransport() {
+	join();
+}
+
+SocketTransport *SocketTransport::fork(int numRanks) {
+	vector<vector<int> > pairs(numRanks, vector<int>(numRanks, -1));	// 'pairs[a][b]' is the end rank a holds towards rank b
+	vector<int> children;
+	bool succeeded = true;
+
+	for (int first = 0; succeeded && first < numRanks; first++) {
+		for (int second = first + 1; succeeded && second < numRanks; second++) {
+			int ends[2];
+
+			succeeded = socketpair(AF_UNIX, SOCK_STREAM, 0, ends) == 0;
+
+			if (succeeded) {
+				pairs[first][second] = ends[0];
+				pairs[second][first] = ends[1];
+			}
+		}
+	}
+
+	// Each Process Keeps the Ends of Its Own Rank
+	auto keepRank = [&](int rank) {
+		for (int holder = 0; holder < numRanks; holder++) {
+			for (int other = 0; holder != rank && other < numRanks; other++) {
+				if (pairs[holder][other] >= 0)
+					close(pairs[holder][other]);
+			}
+		}
+	};
+
+	fflush(0);		// Buffered output would otherwise be written once per process
+
+	for (int rank = 1; succeeded && rank < numRanks; rank++) {
+		pid_t child = ::fork();
+
+		if (child == 0) {
+			keepRank(rank);
+			return new SocketTransport(rank, pairs[rank]);
+		}
+
+		succeeded = child > 0;
+
+		if (succeeded)
+			children.push_back(child);
+	}
+
+	if (!succeeded) {
+		keepRank(-1);		// Forked ranks see their connections close and stop
+
+		for (int child : children)
+			waitpid(child, 0, 0);
+
+		return 0;
+	}
+
+	keepRank(0);
+
+	SocketTransport *transport = new SocketTransport(0, pairs[0]);
+	transport->children = children;
+	return transport;
+}
+
+bool SocketTransport::exchange(int rank, const vector<char> &outgoing, vector<char> &incoming) {
+	if (rank < 0 || rank >= getNumRanks() || sockets[rank] < 0)
+		return false;
+
+	// Lower Rank Talks First  Sending both ways at once could fill both socket buffers
+	if (this->rank < rank)
+		return sendMessage(sockets[rank], outgoing) && receiveMessage(sockets[rank], incoming);
+	else
+		return receiveMessage(sockets[rank], incoming) && sendMessage(sockets[rank], outgoing);
+}
+
+bool SocketTransport::join() {
+	bool succeeded = true;
+
+	for (int &socket : sockets) {
+		if (socket >= 0)
+			close(socket);
+
+		socket = -1;
+	}
+
+	for (int child : children) {
+		int status;
+
+		succeeded = waitpid(child, &status, 0) == child && WIFEXITED(status) && WEXITSTATUS(status) == 0 && succeeded;
+	}
+
+	children.clear();
+
+	return succeeded;
+}
@@ -0,0 +1,34 @@
+#ifndef SOCKET_TRANSPORT_H
+#define SOCKET_TRANSPORT_H
+
+#include <vector>
+#include "Transport.h"
+
+// Ranks as Processes of One Machine, Connected by Unix Domain Socket Pairs  Built on Unix only (SFM_WITH_SOCKETS)
+class SocketTransport : public Transport {
+private:
+	int rank;
+	std::vector<int> sockets;		// Connection to each rank, -1 for its own
+	std::vector<int> children;		// Process ids forked by rank 0
+
+	SocketTransport(int rank, const std::vector<int> &sockets);
+
+public:
+	~SocketTransport();
+
+	SocketTransport(const SocketTransport &) = delete;
+	SocketTransport &operator=(const SocketTransport &) = delete;
+
+	// Forks 'numRanks - 1' Processes Connected to Each Other  Every process continues with its own transport, the caller as rank 0
+	// Fork before starting threads (before creating 'SocialForce')  Null on failure
+	static SocketTransport *fork(int numRanks);
+
+	int getRank() const { return rank; }
+	int getNumRanks() const { return sockets.size(); }
+	bool exchange(int rank, const std::vector<char> &outgoing, std::vector<char> &incoming);
+	const char *getName() const { return "socket"; }
+
+	bool join();		// Rank 0 closes its connections and waits for the other processes  False if any failed
+};
+
+#endif
@@ -0,0 +1,175 @@
+#include <algorithm>
+#include <cstring>
+#include "SpaceFillingCurve.h"
+using namespace std;
+
+const size_t KEYS_PER_CHUNK = 8192;		// Agents keyed and scattered at once by a worker thread
+const int RADIX_BITS = 8;
+const size_t RADIX = 1 << RADIX_BITS;
+const float GRID_CELLS = 65535.0F;		// Cells along each side of the quantised bounding box, minus one
+
+const char *getSpaceCurveName(SpaceCurve curve) {
+	switch (curve) {
+		case SpaceCurve::Morton:
+			return "morton";
+		case SpaceCurve::Hilbert:
+			return "hilbert";
+		default:
+			return "none";
+	}
+}
+
+bool parseSpaceCurve(const char *name, SpaceCurve &curve) {
+	if (strcmp(name, "none") == 0)
+		curve = SpaceCurve::None;
+	else if (strcmp(name, "morton") == 0)
+		curve = SpaceCurve::Morton;
+	else if (strcmp(name, "hilbert") == 0)
+		curve = SpaceCurve::Hilbert;
+	else
+		return false;
+
+	return true;
+}
+
+// Spreads the Low 16 Bits of 'value' to the Even Bits
+static uint32_t spreadBits(uint32_t value) {
+	value &= 0x0000FFFF;
+	value = (value | (value << 8)) & 0x00FF00FF;
+	value = (value | (value << 4)) & 0x0F0F0F0F;
+	value = (value | (value << 2)) & 0x33333333;
+	value = (value | (value << 1)) & 0x55555555;
+
+	return value;
+}
+
+uint32_t getMortonKey(uint32_t col, uint32_t row) {
+	return spreadBits(col) | (spreadBits(row) << 1);
+}
+
+// Quadrant by Quadrant From the Largest, Rotating the Remaining Bits Into the Orientation of Each Sub-Curve
+uint32_t getHilbertKey(uint32_t col, uint32_t row) {
+	uint32_t key = 0, inRight, inTop, swapped;
+
+	for (uint32_t side = 1U << 15; side > 0; side >>= 1) {
+		inRight = (col & side) ? 1 : 0;
+		inTop = (row & side) ? 1 : 0;
+		key += side * side * ((3 * inRight) ^ inTop);
+
+		// Lower Quadrants Turn, the Right One Also Mirrors
+		if (!inTop) {
+			if (inRight) {
+				col = side - 1 - (col & (side - 1));
+				row = side - 1 - (row & (side - 1));
+			}
+
+			swapped = col;
+			col = row;
+			row = swapped;
+		}
+	}
+
+	return key;
+}
+
+bool CurveSorter::sort(const CrowdState &crowd, size_t count, SpaceCurve curve, ThreadPool &pool) {
+	const size_t numChunks = (count + KEYS_PER_CHUNK - 1) / KEYS_PER_CHUNK;
+	float minX, minY, maxX, maxY, scale;
+	bool reordered = false;
+
+	keys.resize(count);
+	sortedKeys.resize(count);
+	order.resize(count);
+	sortedOrder.resize(count);
+	offsets.resize(numChunks * RADIX);
+
+	for (size_t idx = 0; idx < count; idx++)
+		order[idx] = idx;
+
+	if (count < 2 || curve == SpaceCurve::None)
+		return false;
+
+	// Bounding Box of the Crowd, One Scale for Both Axes So Cells are Square
+	minX = maxX = crowd.positionX[0];
+	minY = maxY = crowd.positionY[0];
+
+	for (size_t idx = 1; idx < count; idx++) {
+		minX = min(minX, crowd.positionX[idx]);
+		maxX = max(maxX, crowd.positionX[idx]);
+		minY = min(minY, crowd.positionY[idx]);
+		maxY = max(maxY, crowd.positionY[idx]);
+	}
+
+	scale = (max(maxX - minX, maxY - minY) > 0.0F) ? GRID_CELLS / max(maxX - minX, maxY - minY) : 0.0F;
+
+	auto computeKeys = [&](size_t begin, size_t end, int) {
+		for (size_t idx = begin; idx < end; idx++) {
+			uint32_t col = static_cast<uint32_t>(min(max((crowd.positionX[idx] - minX) * scale, 0.0F), GRID_CELLS));
+			uint32_t row = static_cast<uint32_t>(min(max((crowd.positionY[idx] - minY) * scale, 0.0F), GRID_CELLS));
+
+			keys[idx] = (curve == SpaceCurve::Hilbert) ? getHilbertKey(col, row) : getMortonKey(col, row);
+		}
+	};
+
+	pool.parallelFor(count, KEYS_PER_CHUNK, computeKeys);
+
+	for (int shift = 0; shift < 32; shift += RADIX_BITS) {
+		size_t offset = 0;
+		bool uniform = false;
+
+		// Count Digits of Each Chunk  A worker may be handed several chunks at once
+		auto countDigits = [&](size_t begin, size_t end, int) {
+			for (size_t chunk = begin; chunk < end; chunk++) {
+				size_t *counts = &offsets[chunk * RADIX];
+
+				fill(counts, counts + RADIX, 0);
+
+				for (size_t idx = chunk * KEYS_PER_CHUNK; idx < min((chunk + 1) * KEYS_PER_CHUNK, count); idx++)
+					counts[(keys[idx] >> shift) & (RADIX - 1)]++;
+			}
+		};
+
+		pool.parallelFor(numChunks, 1, countDigits);
+
+		// Digit Major, Chunk Minor Prefix Sum Keeps the Sort Stable
+		for (size_t digit = 0; digit < RADIX && !uniform; digit++) {
+			size_t digitCount = 0;
+
+			for (size_t chunk = 0; chunk < numChunks; chunk++) {
+				size_t chunkCount = offsets[chunk * RADIX + digit];
+
+				offsets[chunk * RADIX + digit] = offset;
+				offset += chunkCount;
+				digitCount += chunkCount;
+			}
+
+			uniform = digitCount == count;
+		}
+
+		if (uniform)
+			continue;
+
+		auto scatter = [&](size_t begin, size_t end, int) {
+			for (size_t chunk = begin; chunk < end; chunk++) {
+				size_t *chunkOffsets = &offsets[chunk * RADIX];
+
+				for (size_t idx = chunk * KEYS_PER_CHUNK; idx < min((chunk + 1) * KEYS_PER_CHUNK, count); idx++) {
+					size_t target = chunkOffsets[(keys[idx] >> shift) & (RADIX - 1)]++;
+
+					sortedKeys[target] = keys[idx];
+					sortedOrder[target] = order[idx];
+				}
+			}
+		};
+
+		pool.parallelFor(numChunks, 1, scatter);
+
+		keys.swap(sortedKeys);
+		order.swap(sortedOrder);
+	}
+
+	for (size_t idx = 0; idx < count && !reordered; idx++)
+		reordered = order[idx] != idx;
+
+	return reordered;
+}
@@ -0,0 +1,40 @@
+#ifndef SPACE_FILLING_CURVE_H
+#define SPACE_FILLING_CURVE_H
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include "CrowdState.h"
+#include "ThreadPool.h"
+
+// Curve Agents are Sorted Along, So Neighbours in Space Sit Near Each Other in 'CrowdState'
+enum class SpaceCurve {
+	None,		// Insertion order, agents removed leave the last agent in their place
+	Morton,		// Z-order, interleaved bits of the cell coordinates (default of 'SocialForce')
+	Hilbert		// No jumps between distant cells, more work per key
+};
+
+const char *getSpaceCurveName(SpaceCurve curve);
+bool parseSpaceCurve(const char *name, SpaceCurve &curve);	// False if 'name' is not none, morton or hilbert
+
+// Position on the Curve of a Cell of the 65536 x 65536 Grid
+uint32_t getMortonKey(uint32_t col, uint32_t row);
+uint32_t getHilbertKey(uint32_t col, uint32_t row);
+
+// Order of Agents Along a Curve Through the Bounding Box of the Crowd
+// Keys are sorted with a parallel, stable LSD radix sort, 8 bits per pass  Passes whose digit is the same for every agent are skipped
+class CurveSorter {
+private:
+	std::vector<uint32_t> keys, sortedKeys;
+	std::vector<uint32_t> order, sortedOrder;
+	std::vector<size_t> offsets;	// 256 per chunk, counts and then scatter offsets of each digit
+
+public:
+	// Agents 0 to 'count - 1' of 'crowd'  Entry i of the result is the current index of the agent that belongs at i
+	// Returns false if the crowd is already in curve order, the result is then the identity
+	bool sort(const CrowdState &crowd, size_t count, SpaceCurve curve, ThreadPool &pool);
+
+	const std::vector<uint32_t> &getOrder() const { return order; }
+};
+
+#endif
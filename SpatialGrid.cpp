@@ -0,0 +1,112 @@
+#include <algorithm>
+#include "SpatialGrid.h"
+using namespace std;
+
+SpatialGrid::SpatialGrid() {
+	cellSize = 1.0F;
+	originX = originY = 0.0F;
+	numCols = numRows = 0;
+
+	cellStart.assign(1, 0);
+}
+
+int SpatialGrid::getCol(float x) const {
+	int col = static_cast<int>((x - originX) / cellSize);
+
+	return min(max(col, 0), numCols - 1);
+}
+
+int SpatialGrid::getRow(float y) const {
+	int row = static_cast<int>((y - originY) / cellSize);
+
+	return min(max(row, 0), numRows - 1);
+}
+
+void SpatialGrid::build(const CrowdState &crowd, float minCellSize) {
+	float minX, minY, maxX, maxY;
+	size_t numCells, maxCells;
+	int cell;
+
+	cellAgents.resize(crowd.size());
+	agentCell.resize(crowd.size());
+
+	if (crowd.size() == 0) {
+		numCols = numRows = 0;
+		cellStart.assign(1, 0);
+		return;
+	}
+
+	// Compute Bounding Box of Crowd
+	minX = maxX = crowd.positionX[0];
+	minY = maxY = crowd.positionY[0];
+
+	for (size_t idx = 1; idx < crowd.size(); idx++) {
+		minX = min(minX, crowd.positionX[idx]);
+		maxX = max(maxX, crowd.positionX[idx]);
+		minY = min(minY, crowd.positionY[idx]);
+		maxY = max(maxY, crowd.positionY[idx]);
+	}
+
+	// Grow Cells Until Grid Size is Proportional to Crowd Size (Guards Against Sparse Outliers)
+	cellSize = minCellSize;
+	maxCells = max(static_cast<size_t>(64), 4 * crowd.size());
+
+	for (;;) {
+		numCols = static_cast<int>((maxX - minX) / cellSize) + 1;
+		numRows = static_cast<int>((maxY - minY) / cellSize) + 1;
+		numCells = static_cast<size_t>(numCols) * numRows;
+
+		if (numCells <= maxCells)
+			break;
+
+		cellSize *= 2.0F;
+	}
+
+	originX = minX;
+	originY = minY;
+
+	// Reserve Upper Bound so Cell Count Changes Between Steps Never Reallocate  Doubled, as it follows a growing crowd
+	if (cellStart.capacity() < maxCells + 1)
+		cellStart.reserve(max(maxCells + 1, 2 * cellStart.capacity()));
+
+	// Count Agents per Cell
+	cellStart.assign(numCells + 1, 0);
+
+	for (size_t idx = 0; idx < crowd.size(); idx++) {
+		cell = getRow(crowd.positionY[idx]) * numCols + getCol(crowd.positionX[idx]);
+		agentCell[idx] = cell;
+		cellStart[cell + 1]++;
+	}
+
+	// Convert Counts into Start Offsets
+	for (size_t idx = 1; idx <= numCells; idx++)
+		cellStart[idx] += cellStart[idx - 1];
+
+	// Scatter Agents into Cells (Keeps Insertion Order Within Each Cell)
+	for (size_t idx = 0; idx < crowd.size(); idx++)
+		cellAgents[cellStart[agentCell[idx]]++] = idx;
+
+	// Scattering Advanced Each Start Offset to the Next Cell, Shift Them Back
+	for (size_t idx = numCells; idx > 0; idx--)
+		cellStart[idx] = cellStart[idx - 1];
+
+	cellStart[0] = 0;
+}
+
+void SpatialGrid::query(float x, float y, vector<int> &neighbours) const {
+	int col, row;
+
+	if (numCols == 0)
+		return;
+
+	col = getCol(x);
+	row = getRow(y);
+
+	for (int r = max(row - 1, 0); r <= min(row + 1, numRows - 1); r++) {
+		for (int c = max(col - 1, 0); c <= min(col + 1, numCols - 1); c++) {
+			int cell = r * numCols + c;
+
+			neighbours.insert(neighbours.end(), cellAgents.begin() + cellStart[cell], cellAgents.begin() + cellStart[cell + 1]);
+		}
+	}
+}
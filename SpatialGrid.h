@@ -0,0 +1,29 @@
+#ifndef SPATIAL_GRID_H
+#define SPATIAL_GRID_H
+
+#include <vector>
+#include "CrowdState.h"
+
+class SpatialGrid {
+private:
+	float cellSize;
+	float originX, originY;			// Lower-left corner of the grid
+	int numCols, numRows;
+
+	std::vector<int> cellStart;		// Index of first agent of each cell in 'cellAgents' (last entry marks the end)
+	std::vector<int> agentCell;		// Cell index of each agent
+	std::vector<int> cellAgents;	// Agent indices sorted by cell
+
+	int getCol(float x) const;
+	int getRow(float y) const;
+
+public:
+	SpatialGrid();
+
+	float getCellSize() const { return cellSize; }
+
+	void build(const CrowdState &crowd, float minCellSize);				// Counting sort of 'crowd' into cells of at least 'minCellSize'
+	void query(float x, float y, std::vector<int> &neighbours) const;	// Appends agents of the 3 x 3 cells around (x, y)
+};
+
+#endif
@@ -0,0 +1,229 @@
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <vector>
+#include "Ensemble.h"
+using namespace std;
+
+const char *PARAMETERS[] = { "lambda", "gamma", "n_prime", "n", "A", "T", "wallA", "wallB" };
+const int NUM_PARAMETERS = 8;
+
+// Command Line Options
+struct SweepOptions {
+	EnsembleRun run;			// Template of every run
+	int numReplicas;			// Runs per parameter value, each on its own random stream
+	const char *parameter;		// Null runs replicas of the default parameters only
+	float from, to;
+	int numValues;
+	int numThreads;				// 0 uses every hardware thread
+	const char *outputPath;		// Null writes to standard output
+};
+
+// Function Prototypes
+bool parseOptions(int argc, char **argv, SweepOptions &options);
+void printUsage(const char *program);
+float *findParameter(RuntimeParams<float> &params, const char *name);
+void writeNumber(FILE *output, double value);
+
+int main(int argc, char **argv) {
+	SweepOptions options;
+	FILE *output = stdout;
+	vector<float> values;
+	vector<RunningStatistic> evacuationTimes, meanSpeeds;
+	bool succeeded;
+
+	if (!parseOptions(argc, argv, options)) {
+		printUsage(argv[0]);
+		return 1;
+	}
+
+	if (options.outputPath) {
+		output = fopen(options.outputPath, "w");
+
+		if (!output) {
+			fprintf(stderr, "Cannot open '%s' for writing\n", options.outputPath);
+			return 1;
+		}
+	}
+
+	Ensemble ensemble(options.numThreads);
+
+	// Evenly Spaced Values, Each Repeated on Consecutive Streams
+	for (int value = 0; value < options.numValues; value++) {
+		EnsembleRun run = options.run;
+
+		if (options.parameter) {
+			float fraction = (options.numValues > 1) ? static_cast<float>(value) / (options.numValues - 1) : 0.0F;
+
+			values.push_back(options.from + (options.to - options.from) * fraction);
+			*findParameter(run.params, options.parameter) = values.back();
+		}
+
+		for (int replica = 0; replica < options.numReplicas; replica++)
+			ensemble.addRun(run);
+	}
+
+	evacuationTimes.resize(options.numValues);
+	meanSpeeds.resize(options.numValues);
+
+	fprintf(stderr, "%zu runs of '%s' with %d agents on %d threads\n", ensemble.getNumRuns(), options.run.scene.c_str(),
+			options.run.numAgents, ensemble.getNumThreads());
+
+	// One Record per Run as It Finishes, Calls Never Overlap
+	auto onFinish = [&](const RunSummary &result, const EnsembleSummary &summary) {
+		int value = static_cast<int>(result.run / options.numReplicas);
+
+		evacuationTimes[value].add(result.evacuationTime);
+		meanSpeeds[value].add(result.meanSpeed);
+
+		fprintf(output, "{\"run\":%zu,\"scene\":\"%s\",\"agents\":%d", result.run, options.run.scene.c_str(), result.numAgents);
+
+		if (options.parameter)
+			fprintf(output, ",\"parameter\":\"%s\",\"value\":%g", options.parameter, values[value]);
+
+		fprintf(output, ",\"stream\":%zu,\"valid\":%s,\"steps\":%llu,\"simulated_time\":%.3f,\"evacuation_time\":", result.run,
+				result.valid ? "true" : "false", result.numSteps, result.simulatedTime);
+		writeNumber(output, result.evacuationTime);
+		fprintf(output, ",\"mean_speed\":%.4f,\"retired\":%llu,\"wall_time\":%.4f}\n", result.meanSpeed, result.agentsRetired,
+				result.wallTime);
+		fflush(output);
+
+		if (summary.numFinished % 100 == 0 || summary.numFinished == ensemble.getNumRuns())
+			fprintf(stderr, "%llu/%zu runs, %llu evacuated, %.1f s\n", summary.numFinished, ensemble.getNumRuns(),
+					summary.numEvacuated, summary.wallTime);
+	};
+
+	succeeded = ensemble.run(onFinish);
+
+	// Statistics per Value
+	for (int value = 0; value < options.numValues; value++) {
+		const RunningStatistic &time = evacuationTimes[value];
+		const RunningStatistic &speed = meanSpeeds[value];
+
+		if (options.parameter)
+			fprintf(stderr, "%s = %-8g ", options.parameter, values[value]);
+
+		fprintf(stderr, "evacuated %llu/%d", time.count, options.numReplicas);
+
+		if (time.count > 0)
+			fprintf(stderr, " in %.2f +- %.2f s [%.2f, %.2f]", time.mean, time.getDeviation(), time.minimum, time.maximum);
+
+		fprintf(stderr, ", mean speed %.3f +- %.3f m/s\n", speed.mean, speed.getDeviation());
+	}
+
+	if (output != stdout)
+		fclose(output);
+
+	return succeeded ? 0 : 1;
+}
+
+bool parseOptions(int argc, char **argv, SweepOptions &options) {
+	options.numReplicas = 100;
+	options.parameter = 0;
+	options.from = options.to = 0.0F;
+	options.numValues = 1;
+	options.numThreads = 0;
+	options.outputPath = 0;
+
+	for (int idx = 1; idx < argc; idx++) {
+		const char *option = argv[idx];
+		const char *value = (idx + 1 < argc) ? argv[idx + 1] : 0;
+
+		// Options Without Value
+		if (strcmp(option, "--no-exits") == 0) {
+			options.run.exits = false;
+			continue;
+		}
+
+		if (strcmp(option, "--help") == 0 || strcmp(option, "-h") == 0 || !value)
+			return false;
+
+		if (strcmp(option, "--scene") == 0)
+			options.run.scene = value;
+		else if (strcmp(option, "--agents") == 0)
+			options.run.numAgents = atoi(value);
+		else if (strcmp(option, "--walls") == 0)
+			options.run.numWalls = atoi(value);
+		else if (strcmp(option, "--replicas") == 0)
+			options.numReplicas = atoi(value);
+		else if (strcmp(option, "--param") == 0)
+			options.parameter = value;
+		else if (strcmp(option, "--from") == 0)
+			options.from = static_cast<float>(atof(value));
+		else if (strcmp(option, "--to") == 0)
+			options.to = static_cast<float>(atof(value));
+		else if (strcmp(option, "--values") == 0)
+			options.numValues = atoi(value);
+		else if (strcmp(option, "--threads") == 0)
+			options.numThreads = atoi(value);
+		else if (strcmp(option, "--seed") == 0)
+			options.run.seed = strtoull(value, 0, 10);
+		else if (strcmp(option, "--dt") == 0)
+			options.run.stepTime = static_cast<float>(atof(value));
+		else if (strcmp(option, "--max-time") == 0)
+			options.run.maxTime = atof(value);
+		else if (strcmp(option, "--output") == 0)
+			options.outputPath = value;
+		else
+			return false;
+
+		idx++;		// Skip consumed value
+	}
+
+	if (options.parameter) {
+		RuntimeParams<float> params;
+
+		if (!findParameter(params, options.parameter)) {
+			fprintf(stderr, "Unknown parameter '%s'\n", options.parameter);
+			return false;
+		}
+	}
+
+	else
+		options.numValues = 1;
+
+	return options.numReplicas > 0 && options.numValues > 0 && options.run.stepTime > 0.0F && options.run.maxTime > 0.0;
+}
+
+void printUsage(const char *program) {
+	printf("Usage: %s [options]\n", program);
+	printf("  --scene NAME        corridor, bottleneck, evacuation or maze (default bottleneck)\n");
+	printf("  --agents N          Crowd size (default 100)\n");
+	printf("  --walls N           Wall segments of the maze scene (default 2000)\n");
+	printf("  --replicas N        Runs per parameter value, each on its own random stream (default 100)\n");
+	printf("  --param NAME        Swept parameter:");
+
+	for (int idx = 0; idx < NUM_PARAMETERS; idx++)
+		printf(" %s", PARAMETERS[idx]);
+
+	printf("\n");
+	printf("  --from X --to Y     Range of the swept parameter, inclusive\n");
+	printf("  --values N          Evenly spaced values in the range (default 1)\n");
+	printf("  --threads N         Worker threads, 0 for all hardware threads (default 0)\n");
+	printf("  --seed N            Seed shared by every run, streams tell runs apart (default 1604010629)\n");
+	printf("  --dt SECONDS        Step time (default 0.02)\n");
+	printf("  --max-time SECONDS  Simulated time after which a run stops (default 300)\n");
+	printf("  --no-exits          Keep agents in room scenes instead of retiring them past the exits\n");
+	printf("  --output FILE       Write JSON lines to FILE instead of standard output\n");
+}
+
+float *findParameter(RuntimeParams<float> &params, const char *name) {
+	float *fields[] = { &params.lambda, &params.gamma, &params.n_prime, &params.n, &params.A, &params.T, &params.wallA, &params.wallB };
+
+	for (int idx = 0; idx < NUM_PARAMETERS; idx++) {
+		if (strcmp(name, PARAMETERS[idx]) == 0)
+			return fields[idx];
+	}
+
+	return 0;
+}
+
+// JSON Has No NaN, Written as Null
+void writeNumber(FILE *output, double value) {
+	if (std::isnan(value))
+		fprintf(output, "null");
+	else
+		fprintf(output, "%.3f", value);
+}
@@ -0,0 +1,92 @@
+#include <algorithm>
+#include "ThreadPool.h"
+using namespace std;
+
+ThreadPool::ThreadPool(int numThreads) : nextIdx(0) {
+	generation = 0;
+	activeWorkers = 0;
+	stopping = false;
+
+	invoker = 0;
+	task = 0;
+	count = chunkSize = 0;
+
+	for (int worker = 1; worker < numThreads; worker++)
+		workers.push_back(thread(&ThreadPool::workerLoop, this, worker));
+}
+
+ThreadPool::~ThreadPool() {
+	{
+		lock_guard<std::mutex> lock(mutex);
+		stopping = true;
+	}
+
+	startCondition.notify_all();
+
+	for (thread &worker : workers)
+		worker.join();
+}
+
+void ThreadPool::run(size_t count, size_t chunkSize, Invoker invoker, void *task) {
+	chunkSize = max(chunkSize, static_cast<size_t>(1));
+
+	// Run Small Loops on the Calling Thread
+	if (workers.empty() || count <= chunkSize) {
+		if (count > 0)
+			invoker(task, 0, count, 0);
+
+		return;
+	}
+
+	{
+		lock_guard<std::mutex> lock(mutex);
+
+		this->invoker = invoker;
+		this->task = task;
+		this->count = count;
+		this->chunkSize = chunkSize;
+		nextIdx.store(0);
+
+		activeWorkers = workers.size();
+		generation++;
+	}
+
+	startCondition.notify_all();
+	runChunks(0);
+
+	// Wait for Workers Still Finishing Their Last Chunk
+	unique_lock<std::mutex> lock(mutex);
+	doneCondition.wait(lock, [this] { return activeWorkers == 0; });
+}
+
+void ThreadPool::runChunks(int worker) {
+	size_t begin;
+
+	while ((begin = nextIdx.fetch_add(chunkSize)) < count)
+		invoker(task, begin, min(begin + chunkSize, count), worker);
+}
+
+void ThreadPool::workerLoop(int worker) {
+	unsigned long long lastGeneration = 0;
+
+	for (;;) {
+		{
+			unique_lock<std::mutex> lock(mutex);
+			startCondition.wait(lock, [&] { return stopping || generation != lastGeneration; });
+
+			if (stopping)
+				return;
+
+			lastGeneration = generation;
+		}
+
+		runChunks(worker);
+
+		{
+			lock_guard<std::mutex> lock(mutex);
+
+			if (--activeWorkers == 0)
+				doneCondition.notify_one();
+		}
+	}
+}
@@ -0,0 +1,54 @@
+#ifndef THREAD_POOL_H
+#define THREAD_POOL_H
+
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Fixed Set of Worker Threads Running Chunked Parallel Loops
+// The calling thread takes part as worker 0, idle workers claim the next chunk from a shared counter
+class ThreadPool {
+private:
+	typedef void (*Invoker)(void *task, size_t begin, size_t end, int worker);
+
+	std::vector<std::thread> workers;
+	std::mutex mutex;
+	std::condition_variable startCondition, doneCondition;
+	unsigned long long generation;	// Incremented for every loop handed to the workers
+	int activeWorkers;				// Workers still running the current loop
+	bool stopping;
+
+	// Current Loop
+	Invoker invoker;
+	void *task;
+	size_t count, chunkSize;
+	std::atomic<size_t> nextIdx;	// First index of the next unclaimed chunk
+
+	template <typename Task>
+	static void invokeTask(void *task, size_t begin, size_t end, int worker) {
+		(*static_cast<Task *>(task))(begin, end, worker);
+	}
+
+	void run(size_t count, size_t chunkSize, Invoker invoker, void *task);
+	void runChunks(int worker);
+	void workerLoop(int worker);
+
+public:
+	explicit ThreadPool(int numThreads);
+	~ThreadPool();
+
+	ThreadPool(const ThreadPool &) = delete;
+	ThreadPool &operator=(const ThreadPool &) = delete;
+
+	int getNumThreads() const { return workers.size() + 1; }
+
+	// Calls 'task(begin, end, worker)' over [0, count) in chunks of 'chunkSize'  Returns once every chunk is done
+	template <typename Task>
+	void parallelFor(size_t count, size_t chunkSize, Task &task) {
+		run(count, chunkSize, &invokeTask<Task>, &task);
+	}
+};
+
+#endif
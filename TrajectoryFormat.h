@@ -0,0 +1,72 @@
+#ifndef TRAJECTORY_FORMAT_H
+#define TRAJECTORY_FORMAT_H
+
+#include <cstdint>
+
+// Binary Trajectory File in the Byte Order of the Writing Host  Structures and arrays are written as they lie in memory,
+// 'byteOrder' in the file header records that order, and readers reject files from a host of the other order
+//
+//	TrajectoryFileHeader
+//	TrajectoryWall[numWalls]
+//	Frame 0 .. Frame n-1		TrajectoryFrameHeader followed by its payload
+//	TrajectoryIndexEntry[n]
+//	TrajectoryTrailer			Last 16 bytes of the file
+//
+// Frame payload, one array per field in agent order:
+//	int32 id, float32 radius, uint32 colour (0xRRGGBB)
+//	Float32 encoding:     float32 positionX, positionY, velocityX, velocityY, orientation (degrees)
+//	Quantised16 encoding: uint16 positionX, positionY  (value = origin + q * positionScale)
+//	                      int16  velocityX, velocityY  (value = q * velocityScale)
+//	                      int16  orientation           (value = q * 180 / 32767)
+//	                      padded to a multiple of 4 bytes
+//
+// A file without trailer (writer did not close) is still readable, the reader scans the frame headers instead.
+
+const char TRAJECTORY_MAGIC[8] = { 'S', 'F', 'M', 'T', 'R', 'A', 'J', '1' };
+const uint32_t TRAJECTORY_VERSION = 2;						// 2 added 'byteOrder'
+const uint32_t TRAJECTORY_BYTE_ORDER = 0x01020304;		// Reads as 0x04030201 on a host of the other order
+const uint32_t TRAJECTORY_FRAME_MAGIC = 0x4D415246;		// "FRAM"
+const uint32_t TRAJECTORY_INDEX_MAGIC = 0x58444E49;		// "INDX"
+
+enum class TrajectoryEncoding : uint32_t {
+	Float32 = 0,		// 32 bytes per agent and frame
+	Quantised16 = 1		// 22 bytes per agent and frame, position error below 1 / 131070 of the crowd's extent
+};
+
+struct TrajectoryFileHeader {
+	char magic[8];
+	uint32_t version;
+	uint32_t encoding;
+	uint32_t numWalls;
+	uint32_t byteOrder;				// TRAJECTORY_BYTE_ORDER as the writer stored it
+};
+
+struct TrajectoryWall {
+	float startX, startY;
+	float endX, endY;
+};
+
+struct TrajectoryFrameHeader {
+	uint32_t magic;
+	int32_t step;
+	float time;
+	uint32_t numAgents;
+	uint32_t payloadSize;			// Bytes following this header
+	float originX, originY;			// Quantised16 only
+	float positionScale;			// Quantised16 only
+	float velocityScale;			// Quantised16 only
+};
+
+struct TrajectoryIndexEntry {
+	uint64_t offset;				// File offset of the frame header
+	int32_t step;
+	float time;
+};
+
+struct TrajectoryTrailer {
+	uint64_t indexOffset;
+	uint32_t numFrames;
+	uint32_t magic;
+};
+
+#endif
@@ -0,0 +1,248 @@
+#include <cstdio>
+#include <cstring>
+#include "TrajectoryReader.h"
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#define TRAJECTORY_MMAP
+#endif
+
+using namespace std;
+
+// Copies 'count' Values of Type T Starting at 'source' into 'values'  The file gives no alignment guarantee
+template <typename T>
+static const char *readArray(const char *source, vector<T> &values, size_t count) {
+	values.resize(count);
+
+	if (count > 0)
+		memcpy(&values[0], source, count * sizeof(T));
+
+	return source + count * sizeof(T);
+}
+
+// Reads 'count' Quantised Values of Type T as 'origin + value * scale'
+template <typename T>
+static const char *dequantise(const char *source, vector<float> &values, size_t count, float origin, float scale) {
+	T value;
+
+	values.resize(count);
+
+	for (size_t idx = 0; idx < count; idx++, source += sizeof(T)) {
+		memcpy(&value, source, sizeof(T));
+		values[idx] = origin + value * scale;
+	}
+
+	return source;
+}
+
+// Payload Size Implied by Header, Used to Reject Corrupt Frames
+static size_t expectedPayloadSize(TrajectoryEncoding encoding, size_t numAgents) {
+	if (encoding == TrajectoryEncoding::Float32)
+		return numAgents * 32;
+
+	return (numAgents * 22 + 3) & ~static_cast<size_t>(3);
+}
+
+TrajectoryReader::TrajectoryReader() {
+	data = 0;
+	dataSize = 0;
+	mapped = false;
+	encoding = TrajectoryEncoding::Float32;
+}
+
+TrajectoryReader::~TrajectoryReader() {
+	close();
+}
+
+bool TrajectoryReader::open(const char *path) {
+	TrajectoryFileHeader header;
+	size_t offset;
+
+	close();
+
+#ifdef TRAJECTORY_MMAP
+	int descriptor = ::open(path, O_RDONLY);
+	struct stat status;
+
+	if (descriptor >= 0 && fstat(descriptor, &status) == 0 && status.st_size > 0) {
+		void *address = mmap(0, status.st_size, PROT_READ, MAP_PRIVATE, descriptor, 0);
+
+		if (address != MAP_FAILED) {
+			data = static_cast<const char *>(address);
+			dataSize = status.st_size;
+			mapped = true;
+		}
+	}
+
+	if (descriptor >= 0)
+		::close(descriptor);	// Mapping stays valid
+#endif
+
+	// Read Whole File if It Could Not Be Mapped
+	if (!data) {
+		FILE *file = fopen(path, "rb");
+		long size;
+
+		if (!file)
+			return false;
+
+		fseek(file, 0, SEEK_END);
+		size = ftell(file);
+		fseek(file, 0, SEEK_SET);
+
+		if (size > 0) {
+			fallback.resize(size);
+
+			if (fread(&fallback[0], 1, size, file) == static_cast<size_t>(size)) {
+				data = &fallback[0];
+				dataSize = size;
+			}
+		}
+
+		fclose(file);
+
+		if (!data) {
+			fallback.clear();
+			return false;
+		}
+	}
+
+	// Header and Walls
+	if (dataSize < sizeof(header)) {
+		close();
+		return false;
+	}
+
+	memcpy(&header, data, sizeof(header));
+
+	// Files of a Host With the Other Byte Order Would Be Read Scrambled
+	if (memcmp(header.magic, TRAJECTORY_MAGIC, sizeof(header.magic)) != 0 || header.version != TRAJECTORY_VERSION ||
+		header.byteOrder != TRAJECTORY_BYTE_ORDER ||
+		header.encoding > static_cast<uint32_t>(TrajectoryEncoding::Quantised16) ||
+		header.numWalls > (dataSize - sizeof(header)) / sizeof(TrajectoryWall)) {
+		close();
+		return false;
+	}
+
+	encoding = static_cast<TrajectoryEncoding>(header.encoding);
+	offset = sizeof(header);
+	readArray(data + offset, walls, header.numWalls);
+	offset += header.numWalls * sizeof(TrajectoryWall);
+
+	if (!readIndex())
+		scanFrames(offset);
+
+	return true;
+}
+
+void TrajectoryReader::close() {
+#ifdef TRAJECTORY_MMAP
+	if (mapped)
+		munmap(const_cast<char *>(data), dataSize);
+#endif
+
+	data = 0;
+	dataSize = 0;
+	mapped = false;
+	fallback.clear();
+	walls.clear();
+	index.clear();
+}
+
+bool TrajectoryReader::readIndex() {
+	TrajectoryTrailer trailer;
+
+	if (dataSize < sizeof(TrajectoryFileHeader) + sizeof(trailer))
+		return false;
+
+	memcpy(&trailer, data + dataSize - sizeof(trailer), sizeof(trailer));
+
+	if (trailer.magic != TRAJECTORY_INDEX_MAGIC || trailer.indexOffset > dataSize - sizeof(trailer) ||
+		(dataSize - sizeof(trailer) - trailer.indexOffset) != trailer.numFrames * sizeof(TrajectoryIndexEntry))
+		return false;
+
+	readArray(data + trailer.indexOffset, index, trailer.numFrames);
+
+	return true;
+}
+
+void TrajectoryReader::scanFrames(size_t offset) {
+	TrajectoryFrameHeader header;
+
+	index.clear();
+
+	// Stop at the First Frame that is Truncated or Damaged
+	while (dataSize - offset >= sizeof(header)) {
+		memcpy(&header, data + offset, sizeof(header));
+
+		if (header.magic != TRAJECTORY_FRAME_MAGIC || header.payloadSize != expectedPayloadSize(encoding, header.numAgents) ||
+			header.payloadSize > dataSize - offset - sizeof(header))
+			break;
+
+		TrajectoryIndexEntry entry = { offset, header.step, header.time };
+		index.push_back(entry);
+
+		offset += sizeof(header) + header.payloadSize;
+	}
+}
+
+size_t TrajectoryReader::findFrame(float time) const {
+	size_t lower = 0, upper = index.size();
+
+	// Binary Search for First Frame After 'time'
+	while (lower < upper) {
+		size_t middle = (lower + upper) / 2;
+
+		if (index[middle].time <= time)
+			lower = middle + 1;
+		else
+			upper = middle;
+	}
+
+	return (lower > 0) ? lower - 1 : 0;
+}
+
+bool TrajectoryReader::readFrame(size_t frameIdx, TrajectoryFrame &frame) const {
+	TrajectoryFrameHeader header;
+	const char *cursor;
+	size_t numAgents;
+
+	if (frameIdx >= index.size() || index[frameIdx].offset > dataSize - sizeof(header))
+		return false;
+
+	memcpy(&header, data + index[frameIdx].offset, sizeof(header));
+	numAgents = header.numAgents;
+
+	if (header.magic != TRAJECTORY_FRAME_MAGIC || header.payloadSize != expectedPayloadSize(encoding, numAgents) ||
+		header.payloadSize > dataSize - index[frameIdx].offset - sizeof(header))
+		return false;
+
+	frame.step = header.step;
+	frame.time = header.time;
+
+	cursor = data + index[frameIdx].offset + sizeof(header);
+	cursor = readArray(cursor, frame.id, numAgents);
+	cursor = readArray(cursor, frame.radius, numAgents);
+	cursor = readArray(cursor, frame.colour, numAgents);
+
+	if (encoding == TrajectoryEncoding::Float32) {
+		cursor = readArray(cursor, frame.positionX, numAgents);
+		cursor = readArray(cursor, frame.positionY, numAgents);
+		cursor = readArray(cursor, frame.velocityX, numAgents);
+		cursor = readArray(cursor, frame.velocityY, numAgents);
+		readArray(cursor, frame.orientation, numAgents);
+	}
+
+	else {
+		cursor = dequantise<uint16_t>(cursor, frame.positionX, numAgents, header.originX, header.positionScale);
+		cursor = dequantise<uint16_t>(cursor, frame.positionY, numAgents, header.originY, header.positionScale);
+		cursor = dequantise<int16_t>(cursor, frame.velocityX, numAgents, 0.0F, header.velocityScale);
+		cursor = dequantise<int16_t>(cursor, frame.velocityY, numAgents, 0.0F, header.velocityScale);
+		dequantise<int16_t>(cursor, frame.orientation, numAgents, 0.0F, 180.0F / 32767.0F);
+	}
+
+	return true;
+}
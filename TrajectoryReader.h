@@ -0,0 +1,58 @@
+#ifndef TRAJECTORY_READER_H
+#define TRAJECTORY_READER_H
+
+#include <cstddef>
+#include <vector>
+#include "TrajectoryFormat.h"
+
+// One Decoded Frame  Vectors are reused across 'readFrame()' calls
+struct TrajectoryFrame {
+	int step;
+	float time;
+	std::vector<int> id;
+	std::vector<float> radius;
+	std::vector<uint32_t> colour;		// 0xRRGGBB
+	std::vector<float> positionX, positionY;
+	std::vector<float> velocityX, velocityY;
+	std::vector<float> orientation;		// Degrees, as 'Agent::getOrientation()'
+
+	size_t size() const { return id.size(); }
+};
+
+// Random Access to the Frames of a Trajectory File  The file is memory-mapped where the platform allows
+class TrajectoryReader {
+private:
+	const char *data;
+	size_t dataSize;
+	bool mapped;						// False if 'data' points into 'fallback'
+	std::vector<char> fallback;			// Whole file, when memory mapping is unavailable
+
+	TrajectoryEncoding encoding;
+	std::vector<TrajectoryWall> walls;
+	std::vector<TrajectoryIndexEntry> index;
+
+	bool readIndex();
+	void scanFrames(size_t offset);		// Rebuilds the index of a file without trailer
+
+public:
+	TrajectoryReader();
+	~TrajectoryReader();
+
+	TrajectoryReader(const TrajectoryReader &) = delete;
+	TrajectoryReader &operator=(const TrajectoryReader &) = delete;
+
+	bool open(const char *path);		// False if unreadable, or written by a host of the other byte order
+	void close();
+
+	bool isOpen() const { return data != 0; }
+	TrajectoryEncoding getEncoding() const { return encoding; }
+	const std::vector<TrajectoryWall> &getWalls() const { return walls; }
+	size_t getNumFrames() const { return index.size(); }
+	int getFrameStep(size_t frameIdx) const { return index[frameIdx].step; }
+	float getFrameTime(size_t frameIdx) const { return index[frameIdx].time; }
+
+	size_t findFrame(float time) const;		// Last frame recorded at or before 'time'
+	bool readFrame(size_t frameIdx, TrajectoryFrame &frame) const;
+};
+
+#endif
@@ -0,0 +1,283 @@
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstring>
+#include "TrajectoryWriter.h"
+using namespace std;
+
+const float PI = 3.14159265359F;
+
+// Appends 'count' Values of Type T to 'buffer'
+template <typename T>
+static void appendArray(vector<char> &buffer, const T *values, size_t count) {
+	size_t begin = buffer.size();
+
+	buffer.resize(begin + count * sizeof(T));
+
+	if (count > 0)
+		memcpy(&buffer[begin], values, count * sizeof(T));
+}
+
+// Round to Nearest and Clamp into [lowerBound, upperBound]
+static int quantise(float value, float lowerBound, float upperBound) {
+	return static_cast<int>(floor(min(max(value, lowerBound), upperBound) + 0.5F));
+}
+
+TrajectoryWriter::TrajectoryWriter() {
+	file = 0;
+	encoding = TrajectoryEncoding::Float32;
+	closing = false;
+	failed = false;
+	offset = 0;
+	stallTime = 0.0;
+	numFrames = 0;
+}
+
+TrajectoryWriter::~TrajectoryWriter() {
+	close();
+}
+
+bool TrajectoryWriter::open(const char *path, TrajectoryEncoding encoding, const vector<Wall *> &walls) {
+	TrajectoryFileHeader header;
+
+	close();
+
+	file = fopen(path, "wb");
+
+	if (!file)
+		return false;
+
+	this->encoding = encoding;
+	closing = false;
+	failed = false;
+	offset = 0;
+	stallTime = 0.0;
+	numFrames = 0;
+	index.clear();
+	queued.clear();
+	freed.clear();
+
+	for (int idx = 0; idx < NUM_SNAPSHOTS; idx++)
+		freed.push_back(idx);
+
+	// Header and Walls, Written Before the Writer Thread Starts
+	memcpy(header.magic, TRAJECTORY_MAGIC, sizeof(header.magic));
+	header.version = TRAJECTORY_VERSION;
+	header.encoding = static_cast<uint32_t>(encoding);
+	header.numWalls = walls.size();
+	header.byteOrder = TRAJECTORY_BYTE_ORDER;
+	writeBytes(&header, sizeof(header));
+
+	for (const Wall *wall : walls) {
+		TrajectoryWall segment = { wall->getStartPoint().x, wall->getStartPoint().y, wall->getEndPoint().x, wall->getEndPoint().y };
+		writeBytes(&segment, sizeof(segment));
+	}
+
+	thread = std::thread(&TrajectoryWriter::writerLoop, this);
+
+	return !failed;
+}
+
+void TrajectoryWriter::write(const CrowdState &crowd, int step, float time) {
+	int snapshotIdx;
+
+	if (!file)
+		return;
+
+	// Wait Only if the Writer Thread Fell Behind by 'NUM_SNAPSHOTS' Frames
+	{
+		unique_lock<std::mutex> lock(mutex);
+
+		if (freed.empty()) {
+			chrono::steady_clock::time_point start = chrono::steady_clock::now();
+
+			freedCondition.wait(lock, [this] { return !freed.empty(); });
+			stallTime += chrono::duration<double>(chrono::steady_clock::now() - start).count();
+		}
+
+		snapshotIdx = freed.front();
+		freed.pop_front();
+	}
+
+	// Copy Without Holding the Lock  Buffers keep their capacity, so steady runs do not allocate
+	Snapshot &snapshot = snapshots[snapshotIdx];
+
+	snapshot.step = step;
+	snapshot.time = time;
+	snapshot.id.assign(crowd.id.begin(), crowd.id.end());
+	snapshot.radius.assign(crowd.radius.begin(), crowd.radius.end());
+	snapshot.colour.assign(crowd.colour.begin(), crowd.colour.end());
+	snapshot.positionX.assign(crowd.positionX.begin(), crowd.positionX.end());
+	snapshot.positionY.assign(crowd.positionY.begin(), crowd.positionY.end());
+	snapshot.velocityX.assign(crowd.velocityX.begin(), crowd.velocityX.end());
+	snapshot.velocityY.assign(crowd.velocityY.begin(), crowd.velocityY.end());
+
+	{
+		lock_guard<std::mutex> lock(mutex);
+		queued.push_back(snapshotIdx);
+		numFrames++;
+	}
+
+	queuedCondition.notify_one();
+}
+
+bool TrajectoryWriter::close() {
+	TrajectoryTrailer trailer;
+	bool succeeded;
+
+	if (!file)
+		return true;
+
+	{
+		lock_guard<std::mutex> lock(mutex);
+		closing = true;
+	}
+
+	queuedCondition.notify_one();
+	thread.join();
+
+	// Frame Index and Trailer Make Every Frame Reachable Without Scanning
+	trailer.indexOffset = offset;
+	trailer.numFrames = index.size();
+	trailer.magic = TRAJECTORY_INDEX_MAGIC;
+
+	if (!index.empty())
+		writeBytes(&index[0], index.size() * sizeof(TrajectoryIndexEntry));
+
+	writeBytes(&trailer, sizeof(trailer));
+
+	succeeded = !failed && fclose(file) == 0;
+	file = 0;
+
+	return succeeded;
+}
+
+void TrajectoryWriter::writerLoop() {
+	TrajectoryFrameHeader header;
+	int snapshotIdx;
+
+	for (;;) {
+		{
+			unique_lock<std::mutex> lock(mutex);
+			queuedCondition.wait(lock, [this] { return closing || !queued.empty(); });
+
+			if (queued.empty())
+				return;		// Closing and nothing left to write
+
+			snapshotIdx = queued.front();
+			queued.pop_front();
+		}
+
+		const Snapshot &snapshot = snapshots[snapshotIdx];
+		TrajectoryIndexEntry entry = { offset, snapshot.step, snapshot.time };
+
+		encodeFrame(snapshot, header);
+
+		{
+			lock_guard<std::mutex> lock(mutex);
+			freed.push_back(snapshotIdx);	// Encoded, 'write()' may refill it while the bytes go out
+		}
+
+		freedCondition.notify_one();
+
+		writeBytes(&header, sizeof(header));
+
+		if (!payload.empty())
+			writeBytes(&payload[0], payload.size());
+
+		index.push_back(entry);
+	}
+}
+
+void TrajectoryWriter::encodeFrame(const Snapshot &snapshot, TrajectoryFrameHeader &header) {
+	size_t numAgents = snapshot.id.size();
+
+	header.magic = TRAJECTORY_FRAME_MAGIC;
+	header.step = snapshot.step;
+	header.time = snapshot.time;
+	header.numAgents = numAgents;
+	header.originX = header.originY = 0.0F;
+	header.positionScale = header.velocityScale = 0.0F;
+
+	colours.resize(numAgents);
+
+	for (size_t idx = 0; idx < numAgents; idx++) {
+		const Color3f &colour = snapshot.colour[idx];
+
+		colours[idx] = (quantise(colour.x * 255.0F, 0.0F, 255.0F) << 16) | (quantise(colour.y * 255.0F, 0.0F, 255.0F) << 8) |
+					   quantise(colour.z * 255.0F, 0.0F, 255.0F);
+	}
+
+	payload.clear();
+	appendArray(payload, snapshot.id.data(), numAgents);
+	appendArray(payload, snapshot.radius.data(), numAgents);
+	appendArray(payload, colours.data(), numAgents);
+
+	if (encoding == TrajectoryEncoding::Float32) {
+		orientation.resize(numAgents);
+
+		for (size_t idx = 0; idx < numAgents; idx++)
+			orientation[idx] = atan2(snapshot.velocityY[idx], snapshot.velocityX[idx]) * (180 / PI);
+
+		appendArray(payload, snapshot.positionX.data(), numAgents);
+		appendArray(payload, snapshot.positionY.data(), numAgents);
+		appendArray(payload, snapshot.velocityX.data(), numAgents);
+		appendArray(payload, snapshot.velocityY.data(), numAgents);
+		appendArray(payload, orientation.data(), numAgents);
+	}
+
+	else {
+		float minX = INFINITY, minY = INFINITY, maxX = -INFINITY, maxY = -INFINITY, maxSpeed = 0.0F;
+
+		// Scales Fitted to This Frame's Bounding Box and Fastest Velocity Component
+		for (size_t idx = 0; idx < numAgents; idx++) {
+			minX = min(minX, snapshot.positionX[idx]);
+			minY = min(minY, snapshot.positionY[idx]);
+			maxX = max(maxX, snapshot.positionX[idx]);
+			maxY = max(maxY, snapshot.positionY[idx]);
+			maxSpeed = max(maxSpeed, max(fabs(snapshot.velocityX[idx]), fabs(snapshot.velocityY[idx])));
+		}
+
+		if (numAgents > 0) {
+			header.originX = minX;
+			header.originY = minY;
+			header.positionScale = max(max(maxX - minX, maxY - minY) / 65535.0F, 1.0e-6F);
+			header.velocityScale = max(maxSpeed / 32767.0F, 1.0e-6F);
+		}
+
+		quantisedX.resize(numAgents);
+		quantisedY.resize(numAgents);
+		quantisedVelocityX.resize(numAgents);
+		quantisedVelocityY.resize(numAgents);
+		quantisedOrientation.resize(numAgents);
+
+		for (size_t idx = 0; idx < numAgents; idx++) {
+			quantisedX[idx] = quantise((snapshot.positionX[idx] - minX) / header.positionScale, 0.0F, 65535.0F);
+			quantisedY[idx] = quantise((snapshot.positionY[idx] - minY) / header.positionScale, 0.0F, 65535.0F);
+			quantisedVelocityX[idx] = quantise(snapshot.velocityX[idx] / header.velocityScale, -32767.0F, 32767.0F);
+			quantisedVelocityY[idx] = quantise(snapshot.velocityY[idx] / header.velocityScale, -32767.0F, 32767.0F);
+			quantisedOrientation[idx] = quantise(atan2(snapshot.velocityY[idx], snapshot.velocityX[idx]) * (32767.0F / PI), -32767.0F, 32767.0F);
+		}
+
+		appendArray(payload, quantisedX.data(), numAgents);
+		appendArray(payload, quantisedY.data(), numAgents);
+		appendArray(payload, quantisedVelocityX.data(), numAgents);
+		appendArray(payload, quantisedVelocityY.data(), numAgents);
+		appendArray(payload, quantisedOrientation.data(), numAgents);
+
+		payload.resize((payload.size() + 3) & ~static_cast<size_t>(3), 0);
+	}
+
+	header.payloadSize = payload.size();
+}
+
+bool TrajectoryWriter::writeBytes(const void *data, size_t size) {
+	if (fwrite(data, 1, size, file) != size) {
+		failed = true;
+		return false;
+	}
+
+	offset += size;
+
+	return true;
+}
@@ -0,0 +1,74 @@
+#ifndef TRAJECTORY_WRITER_H
+#define TRAJECTORY_WRITER_H
+
+#include <condition_variable>
+#include <cstdio>
+#include <deque>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include "CrowdState.h"
+#include "TrajectoryFormat.h"
+#include "Wall.h"
+
+// Streams Crowd Frames to a Binary Trajectory File (See TrajectoryFormat.h)
+// 'write()' only copies the crowd into a free snapshot buffer, encoding and file output run on a background thread
+class TrajectoryWriter {
+private:
+	// Copy of the Crowd Taken by 'write()'
+	struct Snapshot {
+		int step;
+		float time;
+		std::vector<int> id;
+		std::vector<float> radius;
+		std::vector<Color3f> colour;
+		std::vector<float> positionX, positionY;
+		std::vector<float> velocityX, velocityY;
+	};
+
+	static const int NUM_SNAPSHOTS = 3;		// Frames that can be in flight before 'write()' waits
+
+	FILE *file;
+	TrajectoryEncoding encoding;
+	std::thread thread;
+	std::mutex mutex;
+	std::condition_variable queuedCondition, freedCondition;
+	Snapshot snapshots[NUM_SNAPSHOTS];
+	std::deque<int> queued;			// Snapshots waiting to be written, oldest first
+	std::deque<int> freed;			// Snapshots available to 'write()'
+	bool closing;
+	bool failed;					// Set by the writer thread on an I/O error
+
+	// Writer Thread State  Encoding buffers keep their capacity from frame to frame
+	std::vector<char> payload;
+	std::vector<uint32_t> colours;
+	std::vector<float> orientation;					// Float32 encoding
+	std::vector<uint16_t> quantisedX, quantisedY;	// Quantised16 encoding
+	std::vector<int16_t> quantisedVelocityX, quantisedVelocityY, quantisedOrientation;
+	std::vector<TrajectoryIndexEntry> index;
+	uint64_t offset;				// Bytes written so far
+
+	double stallTime;				// Seconds 'write()' spent waiting for a free snapshot
+	size_t numFrames;
+
+	void writerLoop();
+	void encodeFrame(const Snapshot &snapshot, TrajectoryFrameHeader &header);
+	bool writeBytes(const void *data, size_t size);
+
+public:
+	TrajectoryWriter();
+	~TrajectoryWriter();
+
+	TrajectoryWriter(const TrajectoryWriter &) = delete;
+	TrajectoryWriter &operator=(const TrajectoryWriter &) = delete;
+
+	bool open(const char *path, TrajectoryEncoding encoding, const std::vector<Wall *> &walls);
+	void write(const CrowdState &crowd, int step, float time);
+	bool close();					// Writes queued frames and the frame index  Returns false if any write failed
+
+	bool isOpen() const { return file != 0; }
+	size_t getNumFrames() const { return numFrames; }
+	double getStallTime() const { return stallTime; }
+};
+
+#endif
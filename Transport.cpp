@@ -0,0 +1,54 @@
+#include "Transport.h"
+using namespace std;
+
+bool Transport::allGather(const vector<char> &outgoing, vector<vector<char> > &incoming) {
+	bool succeeded = true;
+
+	incoming.resize(getNumRanks());
+
+	// Ascending Partners on Every Rank, So the Smallest Pending Pair Can Always Proceed
+	for (int rank = 0; rank < getNumRanks(); rank++) {
+		if (rank == getRank())
+			incoming[rank] = outgoing;
+		else
+			succeeded = exchange(rank, outgoing, incoming[rank]) && succeeded;
+	}
+
+	return succeeded;
+}
+
+LocalTransport::LocalTransport(const shared_ptr<Mailboxes> &mailboxes, int rank, int numRanks) {
+	this->mailboxes = mailboxes;
+	this->rank = rank;
+	this->numRanks = numRanks;
+}
+
+vector<LocalTransport *> LocalTransport::create(int numRanks) {
+	shared_ptr<Mailboxes> mailboxes(new Mailboxes);
+	vector<LocalTransport *> transports;
+
+	mailboxes->queues.resize(static_cast<size_t>(numRanks) * numRanks);
+
+	for (int rank = 0; rank < numRanks; rank++)
+		transports.push_back(new LocalTransport(mailboxes, rank, numRanks));
+
+	return transports;
+}
+
+bool LocalTransport::exchange(int rank, const vector<char> &outgoing, vector<char> &incoming) {
+	if (rank < 0 || rank >= numRanks || rank == this->rank)
+		return false;
+
+	unique_lock<mutex> lock(mailboxes->mutex);
+	deque<vector<char> > &received = mailboxes->queues[rank * numRanks + this->rank];
+
+	// Queues Never Fill, So Posting Before Waiting Cannot Deadlock
+	mailboxes->queues[this->rank * numRanks + rank].push_back(outgoing);
+	mailboxes->delivered.notify_all();
+	mailboxes->delivered.wait(lock, [&] { return !received.empty(); });
+
+	incoming.swap(received.front());
+	received.pop_front();
+
+	return true;
+}
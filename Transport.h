@@ -0,0 +1,50 @@
+#ifndef TRANSPORT_H
+#define TRANSPORT_H
+
+#include <condition_variable>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+// Messages Between the Ranks of a 'DomainDecomposition'  Ranks are numbered 0 to 'getNumRanks() - 1'
+class Transport {
+public:
+	virtual ~Transport() {}
+
+	virtual int getRank() const = 0;
+	virtual int getNumRanks() const = 0;
+
+	// Sends 'outgoing' to 'rank' and receives what it sent in return  Both ranks must call it, false if the connection failed
+	// Pairs may not wait on each other in a cycle: a rank exchanges with its partners in ascending order
+	virtual bool exchange(int rank, const std::vector<char> &outgoing, std::vector<char> &incoming) = 0;
+
+	bool allGather(const std::vector<char> &outgoing, std::vector<std::vector<char> > &incoming);	// 'incoming[rank]' from each rank, own included
+	virtual const char *getName() const = 0;
+};
+
+// Ranks as Threads of One Process, Messages Passed Through Shared Memory
+class LocalTransport : public Transport {
+private:
+	// Queues of Every Ordered Pair of Ranks
+	struct Mailboxes {
+		std::mutex mutex;
+		std::condition_variable delivered;
+		std::vector<std::deque<std::vector<char> > > queues;	// Sender * ranks + receiver
+	};
+
+	std::shared_ptr<Mailboxes> mailboxes;
+	int rank, numRanks;
+
+	LocalTransport(const std::shared_ptr<Mailboxes> &mailboxes, int rank, int numRanks);
+
+public:
+	static std::vector<LocalTransport *> create(int numRanks);	// One transport per rank, owned by the caller
+
+	int getRank() const { return rank; }
+	int getNumRanks() const { return numRanks; }
+	bool exchange(int rank, const std::vector<char> &outgoing, std::vector<char> &incoming);
+	const char *getName() const { return "local"; }
+};
+
+#endif
@@ -0,0 +1,42 @@
+#ifndef TRIPLE_BUFFER_H
+#define TRIPLE_BUFFER_H
+
+#include <atomic>
+
+// Lock-Free Single Producer, Single Consumer Hand-Over of the Latest Value
+// The producer fills the back slot and publishes it, the consumer swaps in the newest published slot when it wants one
+// Neither side ever waits, copies or sees a slot the other side is using
+template <typename T>
+class TripleBuffer {
+private:
+	static const int INDEX_MASK = 3;
+	static const int FRESH = 4;			// Set in 'middle' when it holds a slot the consumer has not taken yet
+
+	T slots[3];
+	std::atomic<int> middle;			// Slot between producer and consumer
+	int back;							// Owned by the producer
+	int front;							// Owned by the consumer
+
+public:
+	TripleBuffer() : middle(1), back(0), front(2) {}
+
+	TripleBuffer(const TripleBuffer &) = delete;
+	TripleBuffer &operator=(const TripleBuffer &) = delete;
+
+	// Producer
+	T &getBack() { return slots[back]; }
+	void publish() { back = middle.exchange(back | FRESH, std::memory_order_acq_rel) & INDEX_MASK; }
+
+	// Consumer  'update()' returns false if nothing was published since the last call
+	bool update() {
+		if (!(middle.load(std::memory_order_relaxed) & FRESH))
+			return false;
+
+		front = middle.exchange(front, std::memory_order_acq_rel) & INDEX_MASK;
+		return true;
+	}
+
+	const T &getFront() const { return slots[front]; }
+};
+
+#endif
@@ -1,32 +1,59 @@
+#include <algorithm>
+#include "BlockPool.h"
 #include "Wall.h"
+using namespace std;
+
+// Never Destroyed, Walls Deleted During Static Destruction Still Find It
+static BlockPool &getWallPool() {
+	static BlockPool *pool = new BlockPool(sizeof(Wall));
+	return *pool;
+}
 
 Wall::Wall() {
 	wall.start.set(0.0, 0.0, 0.0);
 	wall.end.set(0.0, 0.0, 0.0);
+
+	computeGeometry();
 }
 
 Wall::Wall(float x1, float y1, float x2, float y2) {
 	wall.start.set(x1, y1, 0.0);
 	wall.end.set(x2, y2, 0.0);
+
+	computeGeometry();
+}
+
+void *Wall::operator new(size_t size) {
+	return (size == sizeof(Wall)) ? getWallPool().allocate() : ::operator new(size);
+}
+
+void Wall::operator delete(void *pointer, size_t size) {
+	if (size == sizeof(Wall))
+		getWallPool().deallocate(pointer);
+	else
+		::operator delete(pointer);
+}
+
+void Wall::computeGeometry() {
+	relativeEnd = wall.end - wall.start;
+	length = relativeEnd.length();
+	inverseLength = (length > 0.0F) ? 1.0F / length : 0.0F;		// Zero-length wall acts as a point
+	direction = relativeEnd * inverseLength;
+
+	boundsMin.set(min(wall.start.x, wall.end.x), min(wall.start.y, wall.end.y), 0.0);
+	boundsMax.set(max(wall.start.x, wall.end.x), max(wall.start.y, wall.end.y), 0.0);
 }
 
-Point3f Wall::getNearestPoint(Point3f position_i) {
-	Vector3f relativeEnd, relativePos, relativeEndScal, relativePosScal;
+Point3f Wall::getNearestPoint(Point3f position_i) const {
+	Vector3f relativePos;
 	float dotProduct;
 	Point3f nearestPoint;
 
 	// Create Vector Relative to Wall's 'start'
-	relativeEnd = wall.end - wall.start;	// Vector from wall's 'start' to 'end'
 	relativePos = position_i - wall.start;	// Vector from wall's 'start' to agent i 'position'
 
-	// Scale Both Vectors by the Length of the Wall
-	relativeEndScal = relativeEnd;
-	relativeEndScal.normalize();
-
-	relativePosScal = relativePos * (1.0F / relativeEnd.length());
-
-	// Compute Dot Product of Scaled Vectors
-	dotProduct = relativeEndScal.dot(relativePosScal);
+	// Compute Dot Product of Vectors Scaled by the Length of the Wall
+	dotProduct = direction.dot(relativePos) * inverseLength;
 
 	if (dotProduct < 0.0)		// Position of Agent i located before wall's 'start'
 		nearestPoint = wall.start;
@@ -36,4 +63,4 @@ Point3f Wall::getNearestPoint(Point3f position_i) {
 		nearestPoint = (relativeEnd * dotProduct) + wall.start;
 
 	return nearestPoint;
-}
\ No newline at end of file
+}
@@ -2,6 +2,7 @@
 #define WALL_H
 
 #include <vecmath.h>
+#include <cstddef>
 
 struct Line {
 	Point3f start;
@@ -12,14 +13,32 @@ class Wall {
 private:
 	Line wall;
 
+	// Geometry Precomputed Once, Walls are Immutable After Construction
+	Vector3f relativeEnd;		// Vector from wall's 'start' to 'end'
+	Vector3f direction;			// 'relativeEnd' normalized
+	float length;
+	float inverseLength;
+	Point3f boundsMin, boundsMax;
+
+	void computeGeometry();
+
 public:
 	Wall();
 	Wall(float x1, float y1, float x2, float y2);
 	//~Wall();
 
+	// Allocated from a Shared 'BlockPool'
+	static void *operator new(size_t size);
+	static void operator delete(void *pointer, size_t size);
+
 	Point3f getStartPoint() const { return wall.start; }
 	Point3f getEndPoint() const { return wall.end; }
-	Point3f getNearestPoint(Point3f position_i);	// Computes distance between 'position_i' and wall
+	Vector3f getDirection() const { return direction; }
+	float getLength() const { return length; }
+	float getInverseLength() const { return inverseLength; }
+	Point3f getBoundsMin() const { return boundsMin; }
+	Point3f getBoundsMax() const { return boundsMax; }
+	Point3f getNearestPoint(Point3f position_i) const;	// Computes distance between 'position_i' and wall
 };
 
-#endif
\ No newline at end of file
+#endif
@@ -0,0 +1,184 @@
+#include <algorithm>
+#include <cmath>
+#include "WallIndex.h"
+using namespace std;
+
+const size_t MAX_WALL_CELLS = 1 << 22;	// Cells are enlarged if the grid would exceed this
+
+// Squared Distance Between (x, y) and Segment, Same Arithmetic as 'Wall::getNearestPoint()'
+static float segmentDistanceSquared(const WallSegment &segment, float x, float y, float &vectorX, float &vectorY) {
+	float relativeX = x - segment.startX, relativeY = y - segment.startY;
+	float dotProduct = (segment.directionX * relativeX + segment.directionY * relativeY) * segment.inverseLength;
+	float nearestX, nearestY;
+
+	if (dotProduct < 0.0) {			// Position located before wall's 'start'
+		nearestX = segment.startX;
+		nearestY = segment.startY;
+	}
+
+	else if (dotProduct > 1.0) {	// Position located after wall's 'end'
+		nearestX = segment.endX;
+		nearestY = segment.endY;
+	}
+
+	else {							// Position located between wall's 'start' and 'end'
+		nearestX = segment.relativeEndX * dotProduct + segment.startX;
+		nearestY = segment.relativeEndY * dotProduct + segment.startY;
+	}
+
+	vectorX = x - nearestX;			// Vector from wall to position
+	vectorY = y - nearestY;
+
+	return vectorX * vectorX + vectorY * vectorY;
+}
+
+WallIndex::WallIndex() {
+	range = 0.0F;
+	cellSize = 1.0F;
+	originX = originY = 0.0F;
+	numCols = numRows = 0;
+
+	cellStart.assign(1, 0);
+}
+
+void WallIndex::build(const vector<Wall *> &walls, float range) {
+	float minX, minY, maxX, maxY, halfDiagonal, reach, vectorX, vectorY;
+	int colBegin, colEnd, rowBegin, rowEnd;
+	size_t numCells;
+
+	this->range = range;
+	segments.clear();
+
+	for (const Wall *wall : walls) {
+		WallSegment segment;
+
+		segment.startX = wall->getStartPoint().x;
+		segment.startY = wall->getStartPoint().y;
+		segment.endX = wall->getEndPoint().x;
+		segment.endY = wall->getEndPoint().y;
+		segment.relativeEndX = segment.endX - segment.startX;
+		segment.relativeEndY = segment.endY - segment.startY;
+		segment.directionX = wall->getDirection().x;
+		segment.directionY = wall->getDirection().y;
+		segment.inverseLength = wall->getInverseLength();
+
+		segments.push_back(segment);
+	}
+
+	cellWalls.clear();
+
+	if (walls.empty()) {
+		numCols = numRows = 0;
+		cellStart.assign(1, 0);
+		return;
+	}
+
+	// Compute Bounding Box of Walls Grown by 'range'
+	minX = minY = INFINITY;
+	maxX = maxY = -INFINITY;
+
+	for (const Wall *wall : walls) {
+		minX = min(minX, wall->getBoundsMin().x);
+		minY = min(minY, wall->getBoundsMin().y);
+		maxX = max(maxX, wall->getBoundsMax().x);
+		maxY = max(maxY, wall->getBoundsMax().y);
+	}
+
+	minX -= range;
+	minY -= range;
+	maxX += range;
+	maxY += range;
+
+	cellSize = max(range, 0.5F);
+
+	for (;;) {
+		numCols = static_cast<int>((maxX - minX) / cellSize) + 1;
+		numRows = static_cast<int>((maxY - minY) / cellSize) + 1;
+		numCells = static_cast<size_t>(numCols) * numRows;
+
+		if (numCells <= MAX_WALL_CELLS)
+			break;
+
+		cellSize *= 2.0F;
+	}
+
+	originX = minX;
+	originY = minY;
+
+	// A Wall Belongs to a Cell if It Lies Within 'range' of Any Point in the Cell
+	halfDiagonal = cellSize * 0.70710678F;
+	reach = (range + halfDiagonal) * (range + halfDiagonal);
+
+	// First Pass Counts Walls per Cell, Second Pass Stores Them
+	for (int pass = 0; pass < 2; pass++) {
+		if (pass == 0)
+			cellStart.assign(numCells + 1, 0);
+		else
+			cellWalls.resize(cellStart[numCells]);
+
+		for (size_t wallIdx = 0; wallIdx < walls.size(); wallIdx++) {
+			colBegin = static_cast<int>((walls[wallIdx]->getBoundsMin().x - range - originX) / cellSize);
+			colEnd = static_cast<int>((walls[wallIdx]->getBoundsMax().x + range - originX) / cellSize);
+			rowBegin = static_cast<int>((walls[wallIdx]->getBoundsMin().y - range - originY) / cellSize);
+			rowEnd = static_cast<int>((walls[wallIdx]->getBoundsMax().y + range - originY) / cellSize);
+
+			for (int row = max(rowBegin, 0); row <= min(rowEnd, numRows - 1); row++) {
+				for (int col = max(colBegin, 0); col <= min(colEnd, numCols - 1); col++) {
+					float centreX = originX + (col + 0.5F) * cellSize, centreY = originY + (row + 0.5F) * cellSize;
+					int cell = row * numCols + col;
+
+					if (segmentDistanceSquared(segments[wallIdx], centreX, centreY, vectorX, vectorY) > reach)
+						continue;
+
+					if (pass == 0)
+						cellStart[cell + 1]++;
+					else
+						cellWalls[cellStart[cell]++] = wallIdx;
+				}
+			}
+		}
+
+		// Convert Counts into Start Offsets, or Shift Offsets Advanced by the Second Pass Back
+		if (pass == 0) {
+			for (size_t idx = 1; idx <= numCells; idx++)
+				cellStart[idx] += cellStart[idx - 1];
+		}
+
+		else {
+			for (size_t idx = numCells; idx > 0; idx--)
+				cellStart[idx] = cellStart[idx - 1];
+
+			cellStart[0] = 0;
+		}
+	}
+}
+
+bool WallIndex::nearest(float x, float y, float &vectorX, float &vectorY, float &distanceSquared) const {
+	float candidateX, candidateY, candidateSquared, col, row;
+	int cell;
+	bool found = false;
+
+	col = floor((x - originX) / cellSize);
+	row = floor((y - originY) / cellSize);
+
+	// Outside the Grid Means Farther Than 'range' From Every Wall
+	if (!(col >= 0.0F && col < numCols && row >= 0.0F && row < numRows))
+		return false;
+
+	cell = static_cast<int>(row) * numCols + static_cast<int>(col);
+	distanceSquared = range * range;
+
+	for (int idx = cellStart[cell]; idx < cellStart[cell + 1]; idx++) {
+		candidateSquared = segmentDistanceSquared(segments[cellWalls[idx]], x, y, candidateX, candidateY);
+
+		// Store Nearest Wall Distance
+		if (candidateSquared < distanceSquared || (!found && candidateSquared == distanceSquared)) {
+			distanceSquared = candidateSquared;
+			vectorX = candidateX;
+			vectorY = candidateY;
+			found = true;
+		}
+	}
+
+	return found;
+}
@@ -0,0 +1,41 @@
+#ifndef WALL_INDEX_H
+#define WALL_INDEX_H
+
+#include <cstddef>
+#include <vector>
+#include "Wall.h"
+
+// Wall Geometry Packed for the Force Kernel
+struct WallSegment {
+	float startX, startY;
+	float endX, endY;
+	float relativeEndX, relativeEndY;	// Vector from 'start' to 'end'
+	float directionX, directionY;		// Unit vector from 'start' to 'end'
+	float inverseLength;
+};
+
+// Static Uniform Grid Over Wall Segments  Each cell lists the walls within 'range' of any point in the cell
+class WallIndex {
+private:
+	std::vector<WallSegment> segments;
+	float range;
+	float cellSize;
+	float originX, originY;			// Lower-left corner of the grid
+	int numCols, numRows;
+
+	std::vector<int> cellStart;		// Index of first wall of each cell in 'cellWalls' (last entry marks the end)
+	std::vector<int> cellWalls;		// Wall indices sorted by cell
+
+public:
+	WallIndex();
+
+	size_t size() const { return segments.size(); }
+	float getRange() const { return range; }
+
+	void build(const std::vector<Wall *> &walls, float range);	// Called when walls change, not every step
+
+	// Finds Nearest Wall Among Those Within 'range' of (x, y)  Returns false if there is none
+	bool nearest(float x, float y, float &vectorX, float &vectorY, float &distanceSquared) const;
+};
+
+#endif